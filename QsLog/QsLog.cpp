@@ -25,9 +25,11 @@
 
 #include "QsLog.h"
 #include "QsLogDest.h"
-#ifdef QS_LOG_SEPARATE_THREAD
-#include <QThreadPool>
-#include <QRunnable>
+#ifndef QS_LOG_SYNCHRONOUS
+#include <QThread>
+#include <QSemaphore>
+#include <QAtomicPointer>
+#include <QAtomicInt>
 #endif
 #include <QMutex>
 #include <QVector>
@@ -51,6 +53,13 @@ static const char FatalString[] = "FATAL";
 // not using Qt::ISODate because we need the milliseconds too
 static const QString fmtDateTime("yyyy-MM-ddThh:mm:ss.zzz");
 
+#ifndef QS_LOG_SYNCHRONOUS
+// the writer thread wakes up at least this often (ms) and flushes the destinations after each batch
+static const int FlushInterval = 500;
+// the writer thread is woken up earlier if this many messages are pending
+static const int MaxPendingMessages = 512;
+#endif
+
 static Logger* sInstance = 0;
 
 static const char* LevelToText(Level theLevel)
@@ -77,16 +86,41 @@ static const char* LevelToText(Level theLevel)
     }
 }
 
-#ifdef QS_LOG_SEPARATE_THREAD
-class LogWriterRunnable : public QRunnable
+static QString completeMessage(Level level, const QDateTime& time, const QString& message)
+{
+    return QString("%1 %2 %3")
+            .arg(LevelToText(level))
+            .arg(time.toString(fmtDateTime))
+            .arg(message);
+}
+
+class LoggerImpl;
+
+#ifndef QS_LOG_SYNCHRONOUS
+//! a message waiting for the writer thread, the pending messages are a lock free stack (newest first)
+struct LogEntry
+{
+    LogEntry* next;
+    Level level;
+    qint64 time;
+    QString message;
+};
+
+class LogWriterThread : public QThread
 {
 public:
-    LogWriterRunnable(QString message, Level level);
+    explicit LogWriterThread(LoggerImpl* logger) : logger(logger), stopping(0) {}
+
+    void wake() { wakeUp.release(); }
+    void stop();
+
+protected:
     virtual void run();
 
 private:
-    QString mMessage;
-    Level mLevel;
+    LoggerImpl* logger;
+    QSemaphore wakeUp;
+    QAtomicInt stopping;
 };
 #endif
 
@@ -95,44 +129,89 @@ class LoggerImpl
 public:
     LoggerImpl();
 
-#ifdef QS_LOG_SEPARATE_THREAD
-    QThreadPool threadPool;
+#ifndef QS_LOG_SYNCHRONOUS
+    void writePending();
+
+    QAtomicPointer<LogEntry> pending;
+    QAtomicInt pendingCount;
+    LogWriterThread writer;
 #endif
     QMutex logMutex;
-    Level level;
     DestinationList destList;
 };
 
-#ifdef QS_LOG_SEPARATE_THREAD
-LogWriterRunnable::LogWriterRunnable(QString message, Level level)
-    : QRunnable()
-    , mMessage(message)
-    , mLevel(level)
+#ifndef QS_LOG_SYNCHRONOUS
+void LogWriterThread::stop()
 {
+    stopping.fetchAndStoreRelaxed(1);
+    wakeUp.release();
+    wait();
 }
 
-void LogWriterRunnable::run()
+void LogWriterThread::run()
 {
-    Logger::instance().write(mMessage, mLevel);
+    while (!stopping.load()) {
+        if (wakeUp.tryAcquire(1, FlushInterval))
+            wakeUp.tryAcquire(wakeUp.available()); // several wake ups are handled by one batch
+        logger->writePending();
+    }
 }
 #endif
 
 
 LoggerImpl::LoggerImpl()
-    : level(InfoLevel)
+#ifndef QS_LOG_SYNCHRONOUS
+    : pending(0)
+    , pendingCount(0)
+    , writer(this)
+#endif
 {
     // assume at least file + console
     destList.reserve(2);
-#ifdef QS_LOG_SEPARATE_THREAD
-    threadPool.setMaxThreadCount(1);
-    threadPool.setExpiryTimeout(-1);
-#endif
 }
 
+#ifndef QS_LOG_SYNCHRONOUS
+//! writes the pending messages in the order they were logged and flushes the destinations
+void LoggerImpl::writePending()
+{
+    QMutexLocker lock(&logMutex);
+
+    LogEntry* entry = pending.fetchAndStoreAcquire(0);
+    pendingCount.fetchAndStoreRelaxed(0);
+    if (!entry)
+        return;
+
+    LogEntry* ordered = 0;
+    while (entry) {
+        LogEntry* next = entry->next;
+        entry->next = ordered;
+        ordered = entry;
+        entry = next;
+    }
+
+    while (ordered) {
+        const QString message(completeMessage(ordered->level, QDateTime::fromMSecsSinceEpoch(ordered->time), ordered->message));
+        for (DestinationList::iterator it = destList.begin(), endIt = destList.end();it != endIt;++it)
+            (*it)->write(message, ordered->level);
+
+        LogEntry* next = ordered->next;
+        delete ordered;
+        ordered = next;
+    }
+
+    for (DestinationList::iterator it = destList.begin(), endIt = destList.end();it != endIt;++it)
+        (*it)->flush();
+}
+#endif
+
 
 Logger::Logger()
     : d(new LoggerImpl)
+    , mLevel(InfoLevel)
 {
+#ifndef QS_LOG_SYNCHRONOUS
+    d->writer.start(QThread::LowPriority);
+#endif
 }
 
 Logger& Logger::instance()
@@ -176,8 +255,10 @@ Level Logger::levelFromLogMessage(const QString& logMessage, bool* conversionSuc
 
 Logger::~Logger()
 {
-#ifdef QS_LOG_SEPARATE_THREAD
-    d->threadPool.waitForDone();
+#ifndef QS_LOG_SYNCHRONOUS
+    // the writer thread writes what is still pending before finishing
+    d->writer.stop();
+    d->writePending();
 #endif
     delete d;
     d = 0;
@@ -186,30 +267,19 @@ Logger::~Logger()
 void Logger::addDestination(DestinationPtr destination)
 {
     assert(destination.data());
+    QMutexLocker lock(&d->logMutex);
     d->destList.push_back(destination);
 }
 
 void Logger::setLoggingLevel(Level newLevel)
 {
-    d->level = newLevel;
-}
-
-Level Logger::loggingLevel() const
-{
-    return d->level;
+    mLevel = newLevel;
 }
 
-//! creates the complete log message and passes it to the logger
+//! passes the message to the logger, the decoration is done when it is written
 void Logger::Helper::writeToLog()
 {
-    const char* const levelName = LevelToText(level);
-    const QString completeMessage(QString("%1 %2 %3")
-                                  .arg(levelName)
-                                  .arg(QDateTime::currentDateTime().toString(fmtDateTime))
-                                  .arg(buffer)
-                                  );
-
-    Logger::instance().enqueueWrite(completeMessage, level);
+    Logger::instance().enqueueWrite(buffer, level);
 }
 
 Logger::Helper::~Helper()
@@ -224,14 +294,29 @@ Logger::Helper::~Helper()
     }
 }
 
-//! directs the message to the task queue or writes it directly
+//! queues the message for the writer thread or writes it directly
 void Logger::enqueueWrite(const QString& message, Level level)
 {
-#ifdef QS_LOG_SEPARATE_THREAD
-    LogWriterRunnable *r = new LogWriterRunnable(message, level);
-    d->threadPool.start(r);
+#ifndef QS_LOG_SYNCHRONOUS
+    LogEntry* entry = new LogEntry;
+    entry->level = level;
+    entry->time = QDateTime::currentMSecsSinceEpoch();
+    entry->message = message;
+
+    LogEntry* head;
+    do {
+        head = d->pending.loadAcquire();
+        entry->next = head;
+    } while (!d->pending.testAndSetRelease(head, entry));
+
+    if (level >= FatalLevel) {
+        // the application may be about to stop, don't wait for the writer thread
+        d->writePending();
+    } else if (level >= ErrorLevel || d->pendingCount.fetchAndAddRelaxed(1) + 1 == MaxPendingMessages) {
+        d->writer.wake();
+    }
 #else
-    write(message, level);
+    write(completeMessage(level, QDateTime::currentDateTime(), message), level);
 #endif
 }
 
@@ -243,6 +328,7 @@ void Logger::write(const QString& message, Level level)
     for (DestinationList::iterator it = d->destList.begin(),
         endIt = d->destList.end();it != endIt;++it) {
         (*it)->write(message, level);
+        (*it)->flush();
     }
 }
 
@@ -52,7 +52,7 @@ public:
     //! Logging at a level < 'newLevel' will be ignored
     void setLoggingLevel(Level newLevel);
     //! The default level is INFO
-    Level loggingLevel() const;
+    Level loggingLevel() const { return mLevel; }
 
     //! The helper forwards the streaming to QDebug and builds the final
     //! log message.
@@ -82,8 +82,7 @@ private:
     void write(const QString& message, Level level);
 
     LoggerImpl* d;
-
-    friend class LogWriterRunnable;
+    Level mLevel;
 };
 
 } // end namespace
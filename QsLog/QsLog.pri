@@ -1,7 +1,7 @@
 INCLUDEPATH += $$PWD
 #DEFINES += QS_LOG_LINE_NUMBERS    # automatically writes the file and line for each log message
 #DEFINES += QS_LOG_DISABLE         # logging code is replaced with a no-op
-#DEFINES += QS_LOG_SEPARATE_THREAD # messages are queued and written from a separate thread
+#DEFINES += QS_LOG_SYNCHRONOUS     # messages are written by the thread that logs them instead of a writer thread
 SOURCES += $$PWD/QsLogDest.cpp \
     $$PWD/QsLog.cpp \
     $$PWD/QsLogDestConsole.cpp \
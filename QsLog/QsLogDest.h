@@ -51,6 +51,7 @@ public:
 public:
     virtual ~Destination();
     virtual void write(const QString& message, Level level) = 0;
+    virtual void flush(); // writes what the destination keeps buffered, called after each batch of messages
     virtual bool isValid() = 0; // returns whether the destination was created correctly
 };
 typedef QSharedPointer<Destination> DestinationPtr;
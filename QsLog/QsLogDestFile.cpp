@@ -144,7 +144,11 @@ void QsLogging::FileDestination::write(const QString& message, Level)
         mOutputStream.setDevice(&mFile);
     }
 
-    mOutputStream << message << endl;
+    mOutputStream << message << '\n';
+}
+
+void QsLogging::FileDestination::flush()
+{
     mOutputStream.flush();
 }
 
@@ -88,6 +88,7 @@ class FileDestination : public Destination
 public:
     FileDestination(const QString& filePath, RotationStrategyPtr rotationStrategy);
     virtual void write(const QString& message, Level level);
+    virtual void flush();
     virtual bool isValid();
 
 private:
@@ -138,5 +138,9 @@ int main(int argc, char * argv[])
 
   //Configuration::getConfiguration().save();
   YACReader::exitCheck(ret);
+
+  //the messages still queued in the writer thread are written before exiting
+  QsLogging::Logger::destroyInstance();
+
   return ret;
 }
@@ -1,47 +1,327 @@
-
-#include <QStringList>
+#include <QSqlQuery>
+#include <QCollator>
+#include <algorithm>
+#include <limits>
+#include <vector>
 
 #include "comic_item.h"
+#include "comic_model.h"
+
+static const qint32 NoNumber = std::numeric_limits<qint32>::min();
+
+ComicItemStore::ComicItemStore()
+	:rowsByIdValid(false)
+{
+
+}
+
+void ComicItemStore::clear()
+{
+	ids.clear();
+	parentIds.clear();
+	numbers.clear();
+	numPages.clear();
+	currentPages.clear();
+	ratings.clear();
+	flags.clear();
+	titles.clear();
+	fileNames.clear();
+	pathDirs.clear();
+	hashes.clear();
+
+	stringPool.clear();
+	rowsById.clear();
+	rowsByIdValid = false;
+}
+
+void ComicItemStore::squeeze()
+{
+	ids.squeeze();
+	parentIds.squeeze();
+	numbers.squeeze();
+	numPages.squeeze();
+	currentPages.squeeze();
+	ratings.squeeze();
+	flags.squeeze();
+	titles.squeeze();
+	fileNames.squeeze();
+	pathDirs.squeeze();
+	hashes.squeeze();
+}
+
+void ComicItemStore::append(const QSqlQuery &query)
+{
+	QVariant number = query.value(ComicModel::Number);
+	QVariant title = query.value(ComicModel::Title);
+
+	ids.append(query.value(ComicModel::Id).toULongLong());
+	parentIds.append(query.value(ComicModel::Parent_Id).toULongLong());
+	numbers.append(number.isNull()?NoNumber:number.toInt());
+	numPages.append(query.value(ComicModel::NumPages).toInt());
+	currentPages.append(query.value(ComicModel::CurrentPage).toInt());
+	ratings.append(query.value(ComicModel::Rating).toInt());
+	flags.append(0);
+	titles.append(title.isNull()?QString():intern(title.toString()));
+	fileNames.append(query.value(ComicModel::FileName).toString());
+	pathDirs.append(QString());
+	hashes.append(query.value(ComicModel::Hash).toString());
+
+	int row = ids.count() - 1;
+	setPath(row, query.value(ComicModel::Path).toString());
+	setFlag(row, ReadFlag, query.value(ComicModel::ReadColumn).toBool());
+	setFlag(row, IsBisFlag, query.value(ComicModel::IsBis).toBool());
+	setFlag(row, HasBeenOpenedFlag, query.value(ComicModel::HasBeenOpened).toBool());
+
+	rowsByIdValid = false;
+}
+
+void ComicItemStore::removeAt(int row)
+{
+	ids.remove(row);
+	parentIds.remove(row);
+	numbers.remove(row);
+	numPages.remove(row);
+	currentPages.remove(row);
+	ratings.remove(row);
+	flags.remove(row);
+	titles.remove(row);
+	fileNames.remove(row);
+	pathDirs.remove(row);
+	hashes.remove(row);
+
+	rowsByIdValid = false;
+}
 
-//! [0]
-ComicItem::ComicItem(const QList<QVariant> &data)
-	
+//same semantics as QList::move
+void ComicItemStore::move(int from, int to)
 {
-	itemData = data;
+	if(from == to)
+		return;
+
+	QVector<int> order(count());
+	for(int i=0;i<order.count();i++)
+		order[i] = i;
+	order.remove(from);
+	order.insert(to, from);
+
+	permute(ids, order);
+	permute(parentIds, order);
+	permute(numbers, order);
+	permute(numPages, order);
+	permute(currentPages, order);
+	permute(ratings, order);
+	permute(flags, order);
+	permute(titles, order);
+	permute(fileNames, order);
+	permute(pathDirs, order);
+	permute(hashes, order);
+
+	rowsByIdValid = false;
 }
-//! [0]
 
-//! [1]
-ComicItem::~ComicItem()
+void ComicItemStore::sortByNumber()
 {
+	int numRows = count();
+
+	//the collator keys are computed once per comic instead of once per comparison
+	QCollator collator;
+	collator.setCaseSensitivity(Qt::CaseInsensitive);
+	collator.setNumericMode(true);
+
+	std::vector<QCollatorSortKey> keys;
+	QVector<int> keyIndex(numRows, -1);
+	for(int i=0;i<numRows;i++)
+	{
+		if(numbers.at(i) == NoNumber)
+		{
+			keyIndex[i] = static_cast<int>(keys.size());
+			keys.push_back(collator.sortKey(fileNames.at(i)));
+		}
+	}
+
+	QVector<int> order(numRows);
+	for(int i=0;i<numRows;i++)
+		order[i] = i;
 
+	std::sort(order.begin(), order.end(), [&](int r1, int r2) {
+		qint32 n1 = numbers.at(r1);
+		qint32 n2 = numbers.at(r2);
+		if(n1 == NoNumber && n2 == NoNumber)
+			return keys[keyIndex.at(r1)].compare(keys[keyIndex.at(r2)]) < 0;
+		if(n1 != NoNumber && n2 != NoNumber)
+			return n1 < n2;
+		return n2 == NoNumber;
+	});
+
+	permute(ids, order);
+	permute(parentIds, order);
+	permute(numbers, order);
+	permute(numPages, order);
+	permute(currentPages, order);
+	permute(ratings, order);
+	permute(flags, order);
+	permute(titles, order);
+	permute(fileNames, order);
+	permute(pathDirs, order);
+	permute(hashes, order);
+
+	rowsByIdValid = false;
 }
-//! [1]
 
+QVariant ComicItemStore::data(int row, int column) const
+{
+	if(row < 0 || row >= count())
+		return QVariant();
+
+	switch(column)
+	{
+	case ComicModel::Number:
+		return numbers.at(row) == NoNumber?QVariant():QVariant(numbers.at(row));
+	case ComicModel::Title:
+		return titles.at(row).isNull()?QVariant():QVariant(titles.at(row));
+	case ComicModel::FileName:
+		return fileNames.at(row);
+	case ComicModel::NumPages:
+		return numPages.at(row);
+	case ComicModel::Id:
+		return ids.at(row);
+	case ComicModel::Parent_Id:
+		return parentIds.at(row);
+	case ComicModel::Path:
+		return path(row);
+	case ComicModel::Hash:
+		return hashes.at(row);
+	case ComicModel::ReadColumn:
+		return (flags.at(row) & ReadFlag)?1:0;
+	case ComicModel::IsBis:
+		return (flags.at(row) & IsBisFlag)?1:0;
+	case ComicModel::CurrentPage:
+		return currentPages.at(row);
+	case ComicModel::Rating:
+		return ratings.at(row);
+	case ComicModel::HasBeenOpened:
+		return (flags.at(row) & HasBeenOpenedFlag)?1:0;
+	}
+
+	return QVariant();
+}
 
-//! [5]
-int ComicItem::columnCount() const
+void ComicItemStore::setData(int row, int column, const QVariant &value)
 {
-	return itemData.count();
+	if(row < 0 || row >= count())
+		return;
+
+	switch(column)
+	{
+	case ComicModel::Number:
+		numbers[row] = value.isNull()?NoNumber:value.toInt();
+		break;
+	case ComicModel::Title:
+		titles[row] = value.isNull()?QString():intern(value.toString());
+		break;
+	case ComicModel::FileName:
+	{
+		QString currentPath = path(row);
+		fileNames[row] = value.toString();
+		setPath(row, currentPath);
+		break;
+	}
+	case ComicModel::NumPages:
+		numPages[row] = value.toInt();
+		break;
+	case ComicModel::Id:
+		ids[row] = value.toULongLong();
+		rowsByIdValid = false;
+		break;
+	case ComicModel::Parent_Id:
+		parentIds[row] = value.toULongLong();
+		break;
+	case ComicModel::Path:
+		setPath(row, value.toString());
+		break;
+	case ComicModel::Hash:
+		hashes[row] = value.toString();
+		break;
+	case ComicModel::ReadColumn:
+		setFlag(row, ReadFlag, value.toBool());
+		break;
+	case ComicModel::IsBis:
+		setFlag(row, IsBisFlag, value.toBool());
+		break;
+	case ComicModel::CurrentPage:
+		currentPages[row] = value.toInt();
+		break;
+	case ComicModel::Rating:
+		ratings[row] = value.toInt();
+		break;
+	case ComicModel::HasBeenOpened:
+		setFlag(row, HasBeenOpenedFlag, value.toBool());
+		break;
+	}
 }
-//! [5]
 
-//! [6]
-QVariant ComicItem::data(int column) const
+int ComicItemStore::indexOf(qulonglong id) const
 {
-	return itemData.value(column);
+	if(!rowsByIdValid)
+	{
+		rowsById.clear();
+		rowsById.reserve(ids.count());
+		//the first row wins if an id is repeated (reading lists with sublists)
+		for(int i=ids.count()-1;i>=0;i--)
+			rowsById.insert(ids.at(i), i);
+		rowsByIdValid = true;
+	}
+
+	return rowsById.value(id, -1);
 }
-//! [6]
 
-void ComicItem::setData(int column,const QVariant & value)
+QString ComicItemStore::intern(const QString &value)
 {
-	itemData[column] = value;
+	QSet<QString>::const_iterator itr = stringPool.constFind(value);
+	if(itr != stringPool.constEnd())
+		return *itr;
+
+	stringPool.insert(value);
+	return value;
 }
 
-//! [8]
-int ComicItem::row() const
+//only the folder part of the path is stored when the path ends with the file name
+void ComicItemStore::setPath(int row, const QString &path)
 {
+	const QString & fileName = fileNames.at(row);
+	if(!fileName.isEmpty() && path.endsWith(fileName) && path.length() > fileName.length())
+	{
+		pathDirs[row] = intern(path.left(path.length() - fileName.length()));
+		setFlag(row, PathInDirFlag, true);
+	}
+	else
+	{
+		pathDirs[row] = path;
+		setFlag(row, PathInDirFlag, false);
+	}
+}
 
-	return 0;
+QString ComicItemStore::path(int row) const
+{
+	if(flags.at(row) & PathInDirFlag)
+		return pathDirs.at(row) + fileNames.at(row);
+	return pathDirs.at(row);
+}
+
+void ComicItemStore::setFlag(int row, Flags flag, bool on)
+{
+	if(on)
+		flags[row] |= flag;
+	else
+		flags[row] &= ~flag;
+}
+
+template<typename T>
+void ComicItemStore::permute(QVector<T> &column, const QVector<int> &order)
+{
+	QVector<T> permuted;
+	permuted.reserve(order.count());
+	foreach(int row, order)
+		permuted.append(column.at(row));
+	column = permuted;
 }
-//! [8]
@@ -1,26 +1,73 @@
 #ifndef TABLEITEM_H
 #define TABLEITEM_H
 
-#include <QList>
+#include <QVector>
+#include <QString>
 #include <QVariant>
+#include <QHash>
+#include <QSet>
+
+class QSqlQuery;
 
 //! [0]
-class ComicItem : public QObject
+//Columnar storage for the rows of a ComicModel, one typed vector per column.
+//Rows are addressed by their position, columns by ComicModel::Columns.
+class ComicItemStore
 {
-	Q_OBJECT
 public:
-    ComicItem(const QList<QVariant> &data);
-    ~ComicItem();
-	int columnCount() const;
-	QVariant data(int column) const;
-	void setData(int column,const QVariant & value);
-	int row() const;
-	//unsigned long long int id; //TODO sustituir por una clase adecuada
-	//Comic comic;
+	static const int ColumnCount = 13;
+
+	ComicItemStore();
+
+	int count() const {return ids.count();}
+	bool isEmpty() const {return ids.isEmpty();}
+	void clear();
+	void squeeze();
+
+	//appends the current row of a query selecting the columns in ComicModel::Columns order
+	void append(const QSqlQuery & query);
+	void removeAt(int row);
+	void move(int from, int to);
+	//comics with number first (ascending), then the rest by file name (natural sorting)
+	void sortByNumber();
+
+	QVariant data(int row, int column) const;
+	void setData(int row, int column, const QVariant & value);
+
+	qulonglong id(int row) const {return ids.at(row);}
+	int indexOf(qulonglong id) const;
+
 private:
-	QList<QVariant> itemData;
-	
-	
+	enum Flags {
+		ReadFlag = 0x1,
+		IsBisFlag = 0x2,
+		HasBeenOpenedFlag = 0x4,
+		PathInDirFlag = 0x8 //path == pathDirs + fileName
+	};
+
+	QString intern(const QString & value);
+	void setPath(int row, const QString & path);
+	QString path(int row) const;
+	void setFlag(int row, Flags flag, bool on);
+	template<typename T> static void permute(QVector<T> & column, const QVector<int> & order);
+
+	QVector<qulonglong> ids;
+	QVector<qulonglong> parentIds;
+	QVector<qint32> numbers; //NoNumber if NULL
+	QVector<qint32> numPages;
+	QVector<qint32> currentPages;
+	QVector<quint8> ratings;
+	QVector<quint8> flags;
+	QVector<QString> titles;
+	QVector<QString> fileNames;
+	QVector<QString> pathDirs;
+	QVector<QString> hashes;
+
+	//titles and folders repeat a lot, every row shares the same QString data
+	QSet<QString> stringPool;
+
+	mutable QHash<qulonglong, int> rowsById;
+	mutable bool rowsByIdValid;
 };
 //! [0]
 
@@ -29,7 +29,7 @@ ComicModel::ComicModel( QSqlQuery &sqlquery, QObject *parent)
 
 ComicModel::~ComicModel()
 {
-	qDeleteAll(_data);
+
 }
 
 int ComicModel::columnCount(const QModelIndex &parent) const
@@ -37,7 +37,7 @@ int ComicModel::columnCount(const QModelIndex &parent) const
 	Q_UNUSED(parent)
 	if(_data.isEmpty())
 		return 0;
-    return _data.first()->columnCount();
+    return ComicItemStore::ColumnCount;
 }
 
 bool ComicModel::canDropMimeData(const QMimeData *data, Qt::DropAction action, int row, int column, const QModelIndex &parent) const
@@ -64,62 +64,39 @@ bool ComicModel::dropMimeData(const QMimeData *data, Qt::DropAction action, int
 
     QList<qulonglong> comicIds = YACReader::mimeDataToComicsIds(data);
     QList<int> currentIndexes;
-    int i;
     foreach(qulonglong id, comicIds)
     {
-        i = 0;
-        foreach (ComicItem *item, _data) {
-           if(item->data(Id)==id)
-           {
-               currentIndexes << i;
-               break;
-           }
-           i++;
-        }
+        int i = _data.indexOf(id);
+        if(i != -1)
+            currentIndexes << i;
     }
 
     std::sort(currentIndexes.begin(), currentIndexes.end());
-    QList<ComicItem *> resortedData;
 
     if(currentIndexes.contains(row))//no resorting
         return false;
 
-    ComicItem * destinationItem;
-    if(row == -1 || row >= _data.length())
-        destinationItem = 0;
+    int destinationRow;
+    if(row == -1 || row >= _data.count())
+        destinationRow = -1;
     else
-        destinationItem = _data.at(row);
+        destinationRow = row;
 
     QList<int> newSorting;
 
-    i = 0;
-    foreach (ComicItem *item, _data) {
+    for(int i=0;i<_data.count();i++)
+    {
         if(!currentIndexes.contains(i))
         {
+            if(i == destinationRow)
+                newSorting << currentIndexes;
 
-            if(item == destinationItem) {
-                foreach(int index, currentIndexes)
-                {
-                    resortedData << _data.at(index);
-                    newSorting << index;
-                }
-            }
-
-            resortedData << item;
             newSorting << i;
         }
-
-        i++;
     }
 
-    if(destinationItem == 0)
-    {
-        foreach(int index, currentIndexes)
-        {
-            resortedData << _data.at(index);
-            newSorting << index;
-        }
-    }
+    if(destinationRow == -1)
+        newSorting << currentIndexes;
 
     QLOG_TRACE() << newSorting;
 
@@ -130,38 +107,32 @@ bool ComicModel::dropMimeData(const QMimeData *data, Qt::DropAction action, int
 
     foreach(qulonglong id, comicIds)
     {
-        int i = 0;
-        foreach (ComicItem *item, _data) {
-            if(item->data(Id) == id)
-            {
-                beginMoveRows(parent,i,i,parent,tempRow);
-
-                bool skipElement = i == tempRow || i + 1 == tempRow;
-
-                if(!skipElement)
-                {
-                    if(i > tempRow)
-                        _data.move(i, tempRow);
-                    else
-                        _data.move(i, tempRow - 1);
-                }
+        int i = _data.indexOf(id);
+        if(i != -1)
+        {
+            beginMoveRows(parent,i,i,parent,tempRow);
 
-                endMoveRows();
+            bool skipElement = i == tempRow || i + 1 == tempRow;
 
+            if(!skipElement)
+            {
                 if(i > tempRow)
-                    tempRow++;
-
-                break;
+                    _data.move(i, tempRow);
+                else
+                    _data.move(i, tempRow - 1);
             }
-            i++;
+
+            endMoveRows();
+
+            if(i > tempRow)
+                tempRow++;
         }
     }
 
     //TODO fix selection
     QList<qulonglong> allComicIds;
-    foreach (ComicItem *item, _data) {
-        allComicIds << item->data(Id).toULongLong();
-    }
+    for(int i=0;i<_data.count();i++)
+        allComicIds << _data.id(i);
 
     QSqlDatabase db = DataBaseManagement::loadDatabase(_databasePath);
     switch (mode) {
@@ -181,7 +152,7 @@ bool ComicModel::dropMimeData(const QMimeData *data, Qt::DropAction action, int
     //endMoveRows();
 
     emit resortedIndexes(newSorting);
-    int destSelectedIndex = row<0?_data.length():row;
+    int destSelectedIndex = row<0?_data.count():row;
 
     if(destSelectedIndex>currentIndexes.at(0))
         emit newSelectedIndex(index(qMax(0,destSelectedIndex-1),0,parent));
@@ -284,43 +255,46 @@ QVariant ComicModel::data(const QModelIndex &index, int role) const
     //TODO check here if any view is asking for TableModel::Roles
     //these roles will be used from QML/GridView
 
-    ComicItem *item = static_cast<ComicItem*>(index.internalPointer());
+    int row = index.row();
 
     if (role == NumberRole)
-        return item->data(Number);
+        return _data.data(row,Number);
     else if (role == TitleRole)
-        return item->data(Title).isNull()?item->data(FileName):item->data(Title);
+        return _data.data(row,Title).isNull()?_data.data(row,FileName):_data.data(row,Title);
     else if (role == FileNameRole)
-        return item->data(FileName);
+        return _data.data(row,FileName);
     else if (role == RatingRole)
-        return item->data(Rating);
+        return _data.data(row,Rating);
     else if (role == CoverPathRole)
-        return getCoverUrlPathForComicHash(item->data(Hash).toString());
+        return getCoverUrlPathForComicHash(_data.data(row,Hash).toString());
     else if (role == NumPagesRole)
-        return item->data(NumPages);
+        return _data.data(row,NumPages);
     else if (role == CurrentPageRole)
-        return item->data(CurrentPage);
+        return _data.data(row,CurrentPage);
     else if (role == ReadColumnRole)
-        return item->data(ReadColumn).toBool();
+        return _data.data(row,ReadColumn).toBool();
     else if (role == HasBeenOpenedRole)
-        return item->data(ComicModel::HasBeenOpened);
+        return _data.data(row,ComicModel::HasBeenOpened);
     else if (role == IdRole)
-        return item->data(Id);
+        return _data.data(row,Id);
 
     if (role != Qt::DisplayRole)
         return QVariant();
 
     if(index.column() == ComicModel::Hash)
-		return QString::number(item->data(index.column()).toString().right(item->data(index.column()).toString().length()-40).toInt()/1024.0/1024.0,'f',2)+"Mb";
+    {
+        QString hash = _data.data(row,ComicModel::Hash).toString();
+		return QString::number(hash.right(hash.length()-40).toInt()/1024.0/1024.0,'f',2)+"Mb";
+    }
     if(index.column() == ComicModel::ReadColumn)
-        return (item->data(ComicModel::CurrentPage).toInt()==item->data(ComicModel::NumPages).toInt() || item->data(ComicModel::ReadColumn).toBool())?QVariant(tr("yes")):QVariant(tr("no"));
+        return (_data.data(row,ComicModel::CurrentPage).toInt()==_data.data(row,ComicModel::NumPages).toInt() || _data.data(row,ComicModel::ReadColumn).toBool())?QVariant(tr("yes")):QVariant(tr("no"));
     if(index.column() == ComicModel::CurrentPage)
-        return item->data(ComicModel::HasBeenOpened).toBool()?item->data(index.column()):QVariant("-");
+        return _data.data(row,ComicModel::HasBeenOpened).toBool()?_data.data(row,index.column()):QVariant("-");
 	
     if (index.column() == ComicModel::Rating)
 		return QVariant();
 
-	return item->data(index.column());
+	return _data.data(row,index.column());
 }
 
 Qt::ItemFlags ComicModel::flags(const QModelIndex &index) const
@@ -378,7 +352,7 @@ QVariant ComicModel::headerData(int section, Qt::Orientation orientation,
 
 	if(orientation == Qt::Vertical && role == Qt::DecorationRole)
 	{
-        QString fileName = _data.value(section)->data(ComicModel::FileName).toString();
+        QString fileName = _data.data(section,ComicModel::FileName).toString();
 		QFileInfo fi(fileName);
 		QString ext = fi.suffix();
 
@@ -414,7 +388,7 @@ QModelIndex ComicModel::index(int row, int column, const QModelIndex &parent)
 	if (!hasIndex(row, column, parent))
 		return QModelIndex();
 
-	return createIndex(row, column, _data.at(row));
+	return createIndex(row, column);
 }
 
 QModelIndex ComicModel::parent(const QModelIndex &index) const
@@ -438,10 +412,9 @@ QStringList ComicModel::getPaths(const QString & _source)
 {
 	QStringList paths;
 	QString source = _source + "/.yacreaderlibrary/covers/";
-    QList<ComicItem *>::ConstIterator itr;
-	for(itr = _data.constBegin();itr != _data.constEnd();itr++)
+	for(int i=0;i<_data.count();i++)
 	{
-        QString hash = (*itr)->data(ComicModel::Hash).toString();
+        QString hash = _data.data(i,ComicModel::Hash).toString();
 		paths << source+ hash +".jpg";
 	}
 
@@ -455,13 +428,13 @@ void ComicModel::setupFolderModelData(unsigned long long int folderId,const QStr
     sourceId=folderId;
 
     beginResetModel();
-    qDeleteAll(_data);
     _data.clear();
 
     _databasePath = databasePath;
     QSqlDatabase db = DataBaseManagement::loadDatabase(databasePath);
     {
         QSqlQuery selectQuery(db);
+        selectQuery.setForwardOnly(true);
         selectQuery.prepare("SELECT ci.number,ci.title,c.fileName,ci.numPages,c.id,c.parentId,c.path,ci.hash,ci.read,ci.isBis,ci.currentPage,ci.rating,ci.hasBeenOpened "
                             "FROM comic c INNER JOIN comic_info ci ON (c.comicInfoId = ci.id) "
                             "WHERE c.parentId = :parentId");
@@ -484,13 +457,13 @@ void ComicModel::setupLabelModelData(unsigned long long parentLabel, const QStri
     sourceId = parentLabel;
 
     beginResetModel();
-    qDeleteAll(_data);
     _data.clear();
 
     _databasePath = databasePath;
     QSqlDatabase db = DataBaseManagement::loadDatabase(databasePath);
     {
         QSqlQuery selectQuery(db);
+        selectQuery.setForwardOnly(true);
         selectQuery.prepare("SELECT ci.number,ci.title,c.fileName,ci.numPages,c.id,c.parentId,c.path,ci.hash,ci.read,ci.isBis,ci.currentPage,ci.rating,ci.hasBeenOpened "
                             "FROM comic c INNER JOIN comic_info ci ON (c.comicInfoId = ci.id) "
                             "INNER JOIN comic_label cl ON (c.id == cl.comic_id) "
@@ -514,7 +487,6 @@ void ComicModel::setupReadingListModelData(unsigned long long parentReadingList,
     sourceId = parentReadingList;
 
     beginResetModel();
-    qDeleteAll(_data);
     _data.clear();
 
     _databasePath = databasePath;
@@ -539,6 +511,7 @@ void ComicModel::setupReadingListModelData(unsigned long long parentReadingList,
         foreach(qulonglong id, ids)
         {
             QSqlQuery selectQuery(db);
+            selectQuery.setForwardOnly(true);
             selectQuery.prepare("SELECT ci.number,ci.title,c.fileName,ci.numPages,c.id,c.parentId,c.path,ci.hash,ci.read,ci.isBis,ci.currentPage,ci.rating,ci.hasBeenOpened "
                                 "FROM comic c INNER JOIN comic_info ci ON (c.comicInfoId = ci.id) "
                                 "INNER JOIN comic_reading_list crl ON (c.id == crl.comic_id) "
@@ -548,12 +521,7 @@ void ComicModel::setupReadingListModelData(unsigned long long parentReadingList,
             selectQuery.exec();
 
             //TODO, extra information is needed (resorting)
-            QList<ComicItem *> tempData = _data;
-            _data.clear();
-
             setupModelDataForList(selectQuery);
-
-            _data = tempData << _data;
         }
 
     }
@@ -568,13 +536,13 @@ void ComicModel::setupFavoritesModelData(const QString &databasePath)
     mode = Favorites;
 
     beginResetModel();
-    qDeleteAll(_data);
     _data.clear();
 
     _databasePath = databasePath;
     QSqlDatabase db = DataBaseManagement::loadDatabase(databasePath);
     {
         QSqlQuery selectQuery(db);
+        selectQuery.setForwardOnly(true);
         selectQuery.prepare("SELECT ci.number,ci.title,c.fileName,ci.numPages,c.id,c.parentId,c.path,ci.hash,ci.read,ci.isBis,ci.currentPage,ci.rating,ci.hasBeenOpened "
                             "FROM comic c INNER JOIN comic_info ci ON (c.comicInfoId = ci.id) "
                             "INNER JOIN comic_default_reading_list cdrl ON (c.id == cdrl.comic_id) "
@@ -598,13 +566,13 @@ void ComicModel::setupReadingModelData(const QString &databasePath)
     mode = Reading;
 
     beginResetModel();
-    qDeleteAll(_data);
     _data.clear();
 
     _databasePath = databasePath;
     QSqlDatabase db = DataBaseManagement::loadDatabase(databasePath);
     {
         QSqlQuery selectQuery(db);
+        selectQuery.setForwardOnly(true);
         selectQuery.prepare("SELECT ci.number,ci.title,c.fileName,ci.numPages,c.id,c.parentId,c.path,ci.hash,ci.read,ci.isBis,ci.currentPage,ci.rating,ci.hasBeenOpened "
                             "FROM comic c INNER JOIN comic_info ci ON (c.comicInfoId = ci.id) "
                             "WHERE ci.hasBeenOpened = 1 AND ci.read = 0 "
@@ -628,7 +596,6 @@ void ComicModel::setupModelData(const SearchModifiers modifier, const QString &f
     beginResetModel();
     //QElapsedTimer timer;
     //timer.start();
-    qDeleteAll(_data);
     _data.clear();
 
     //QTextStream txtS(&f);
@@ -639,6 +606,7 @@ void ComicModel::setupModelData(const SearchModifiers modifier, const QString &f
     //crear la consulta
     //timer.restart();
     QSqlQuery selectQuery(db);
+    selectQuery.setForwardOnly(true);
 
     switch (modifier) {
     case YACReader::NoModifiers:
@@ -685,68 +653,38 @@ void ComicModel::setupModelData(const SearchModifiers modifier, const QString &f
     QSqlDatabase::removeDatabase(db.connectionName());
     endResetModel();
 
-    emit searchNumResults(_data.length());
+    emit searchNumResults(_data.count());
 }
 
 QString ComicModel::getComicPath(QModelIndex mi)
 {
 	if(mi.isValid())
-        return _data.at(mi.row())->data(ComicModel::Path).toString();
+        return _data.data(mi.row(),ComicModel::Path).toString();
 	return "";
 }
 
 void ComicModel::setupModelData(QSqlQuery &sqlquery)
 {
-    int numColumns = sqlquery.record().count();
-
     while (sqlquery.next())
-	{
-		QList<QVariant> data;
+        _data.append(sqlquery);
 
-        for(int i=0;i<numColumns;i++)
-            data << sqlquery.value(i);
-
-        _data.append(new ComicItem(data));
-    }
-
-    std::sort(_data.begin(), _data.end(), [](const ComicItem *c1, const ComicItem *c2) {
-        if(c1->data(ComicModel::Number).isNull() && c2->data(ComicModel::Number).isNull())
-        {
-            return naturalSortLessThanCI(c1->data(ComicModel::FileName).toString(), c2->data(ComicModel::FileName).toString());
-        }
-        else
-        {
-            if (c1->data(ComicModel::Number).isNull() == false && c2->data(ComicModel::Number).isNull() == false)
-            {
-                return c1->data(ComicModel::Number).toInt() < c2->data(ComicModel::Number).toInt();
-            }
-            else
-            {
-                return c2->data(ComicModel::Number).isNull();
-            }
-        }
-    });
+    _data.sortByNumber();
+    _data.squeeze();
 }
 
 //comics are sorted by "ordering", the sorting is done in the sql query
 void ComicModel::setupModelDataForList(QSqlQuery &sqlquery)
 {
-    int numColumns = sqlquery.record().count();
-
     while (sqlquery.next())
-    {
-        QList<QVariant> data;
-        for(int i=0;i<numColumns;i++)
-            data << sqlquery.value(i);
+        _data.append(sqlquery);
 
-        _data.append(new ComicItem(data));
-    }
+    _data.squeeze();
 }
 
 ComicDB ComicModel::getComic(const QModelIndex & mi)
 {
 	QSqlDatabase db = DataBaseManagement::loadDatabase(_databasePath);
-    ComicDB c = DBHelper::loadComic(_data.at(mi.row())->data(ComicModel::Id).toULongLong(),db);
+    ComicDB c = DBHelper::loadComic(_data.id(mi.row()),db);
 	db.close();
 	QSqlDatabase::removeDatabase(db.connectionName());
 
@@ -756,7 +694,7 @@ ComicDB ComicModel::getComic(const QModelIndex & mi)
 ComicDB ComicModel::_getComic(const QModelIndex & mi)
 {
 	QSqlDatabase db = DataBaseManagement::loadDatabase(_databasePath);
-    ComicDB c = DBHelper::loadComic(_data.at(mi.row())->data(ComicModel::Id).toULongLong(),db);
+    ComicDB c = DBHelper::loadComic(_data.id(mi.row()),db);
 	db.close();
 	QSqlDatabase::removeDatabase(db.connectionName());
 
@@ -770,11 +708,11 @@ QVector<YACReaderComicReadStatus> ComicModel::getReadList()
 	QVector<YACReaderComicReadStatus> readList(numComics);
 	for(int i=0;i<numComics;i++)
 	{
-        if(_data.value(i)->data(ComicModel::ReadColumn).toBool())
+        if(_data.data(i,ComicModel::ReadColumn).toBool())
 			readList[i] = YACReader::Read;
-        else if (_data.value(i)->data(ComicModel::CurrentPage).toInt() == _data.value(i)->data(ComicModel::NumPages).toInt())
+        else if (_data.data(i,ComicModel::CurrentPage).toInt() == _data.data(i,ComicModel::NumPages).toInt())
 			 readList[i] = YACReader::Read;
-        else if (_data.value(i)->data(ComicModel::HasBeenOpened).toBool())
+        else if (_data.data(i,ComicModel::HasBeenOpened).toBool())
 			readList[i] = YACReader::Opened;
 		else
 			readList[i] = YACReader::Unread;
@@ -796,7 +734,7 @@ QList<ComicDB> ComicModel::getAllComics()
 	int numComics = _data.count();
 	for(int i=0;i<numComics;i++)
 	{
-        comics.append(DBHelper::loadComic(_data.value(i)->data(ComicModel::Id).toULongLong(),db));
+        comics.append(DBHelper::loadComic(_data.id(i),db));
 	}
 
 	db.commit();
@@ -831,17 +769,17 @@ QVector<YACReaderComicReadStatus> ComicModel::setComicsRead(QList<QModelIndex> l
 	{
 		if(read == YACReader::Read)
 		{
-        _data.value(mi.row())->setData(ComicModel::ReadColumn, QVariant(true));
-        ComicDB c = DBHelper::loadComic(_data.value(mi.row())->data(ComicModel::Id).toULongLong(),db);
+        _data.setData(mi.row(),ComicModel::ReadColumn, QVariant(true));
+        ComicDB c = DBHelper::loadComic(_data.id(mi.row()),db);
 		c.info.read = true;
 		DBHelper::update(&(c.info),db);
 		}
 		if(read == YACReader::Unread)
 		{
-        _data.value(mi.row())->setData(ComicModel::ReadColumn, QVariant(false));
-        _data.value(mi.row())->setData(ComicModel::CurrentPage, QVariant(1));
-        _data.value(mi.row())->setData(ComicModel::HasBeenOpened, QVariant(false));
-        ComicDB c = DBHelper::loadComic(_data.value(mi.row())->data(ComicModel::Id).toULongLong(),db);
+        _data.setData(mi.row(),ComicModel::ReadColumn, QVariant(false));
+        _data.setData(mi.row(),ComicModel::CurrentPage, QVariant(1));
+        _data.setData(mi.row(),ComicModel::HasBeenOpened, QVariant(false));
+        ComicDB c = DBHelper::loadComic(_data.id(mi.row()),db);
 		c.info.read = false;
 		c.info.currentPage = 1;
 		c.info.hasBeenOpened = false;
@@ -860,11 +798,11 @@ qint64 ComicModel::asignNumbers(QList<QModelIndex> list,int startingNumber)
 {
 	QSqlDatabase db = DataBaseManagement::loadDatabase(_databasePath);
 	db.transaction();
-    qint64 idFirst = _data.value(list[0].row())->data(ComicModel::Id).toULongLong();
+    qint64 idFirst = _data.id(list[0].row());
 	int i = 0;
 	foreach (QModelIndex mi, list)
 	{
-        ComicDB c = DBHelper::loadComic(_data.value(mi.row())->data(ComicModel::Id).toULongLong(),db);
+        ComicDB c = DBHelper::loadComic(_data.id(mi.row()),db);
         c.info.number = startingNumber+i;
 		c.info.edited = true;
 		DBHelper::update(&(c.info),db);
@@ -881,19 +819,9 @@ qint64 ComicModel::asignNumbers(QList<QModelIndex> list,int startingNumber)
 }
 QModelIndex ComicModel::getIndexFromId(quint64 id)
 {
-    QList<ComicItem *>::ConstIterator itr;
-	int i=0;
-	for(itr = _data.constBegin();itr != _data.constEnd();itr++)
-	{
-        if((*itr)->data(ComicModel::Id).toULongLong() == id)
-			break;
-		i++;
-	}
-
-    return index(i,0);
+    return index(_data.indexOf(id),0);
 }
 
-//TODO completely inefficiently
 QList<QModelIndex> ComicModel::getIndexesFromIds(const QList<qulonglong> &comicIds)
 {
     QList<QModelIndex> comicsIndexes;
@@ -919,12 +847,11 @@ void ComicModel::finishTransaction()
 
 void ComicModel::removeInTransaction(int row)
 {
-    ComicDB c = DBHelper::loadComic(_data.at(row)->data(ComicModel::Id).toULongLong(),dbTransaction);
+    ComicDB c = DBHelper::loadComic(_data.id(row),dbTransaction);
 
 	DBHelper::removeFromDB(&c,dbTransaction);
 	beginRemoveRows(QModelIndex(),row,row);
 	removeRow(row);
-	delete _data.at(row);
 	_data.removeAt(row);
 
     endRemoveRows();
@@ -958,23 +885,14 @@ void ComicModel::remove(int row)
 
 void ComicModel::reload(const ComicDB & comic)
 {
-	int row = 0;
-	bool found = false;
-    foreach(ComicItem * item,_data)
-	{
-        if(item->data(ComicModel::Id).toULongLong() == comic.id)
-		{
-			found = true;
-            item->setData(ComicModel::ReadColumn,comic.info.read);
-            item->setData(ComicModel::CurrentPage,comic.info.currentPage);
-            item->setData(ComicModel::HasBeenOpened,true);
-			break;
-				
-		}
-		row++;
-	}
-    if(found)
+	int row = _data.indexOf(comic.id);
+    if(row != -1)
+    {
+        _data.setData(row,ComicModel::ReadColumn,comic.info.read);
+        _data.setData(row,ComicModel::CurrentPage,comic.info.currentPage);
+        _data.setData(row,ComicModel::HasBeenOpened,true);
         emit dataChanged(index(row,ReadColumn),index(row,HasBeenOpened), QVector<int>() << ReadColumnRole << CurrentPageRole << HasBeenOpenedRole);
+    }
 }
 
 void ComicModel::resetComicRating(const QModelIndex &mi)
@@ -984,7 +902,7 @@ void ComicModel::resetComicRating(const QModelIndex &mi)
     QSqlDatabase db = DataBaseManagement::loadDatabase(_databasePath);
 
     comic.info.rating = 0;
-    _data[mi.row()]->setData(ComicModel::Rating,0);
+    _data.setData(mi.row(),ComicModel::Rating,0);
     DBHelper::update(&(comic.info),db);
 
     emit dataChanged(mi,mi);
@@ -1114,7 +1032,7 @@ bool ComicModel::isFavorite(const QModelIndex &index)
 
     QSqlDatabase db = DataBaseManagement::loadDatabase(_databasePath);
 
-    isFavorite = DBHelper::isFavoriteComic(_data[index.row()]->data(Id).toLongLong(),db);
+    isFavorite = DBHelper::isFavoriteComic(_data.id(index.row()),db);
 
     db.close();
     QSqlDatabase::removeDatabase(db.connectionName());
@@ -1130,7 +1048,7 @@ void ComicModel::updateRating(int rating, QModelIndex mi)
 	//TODO optimize update
 	
 	comic.info.rating = rating;
-    _data[mi.row()]->setData(ComicModel::Rating,rating);
+    _data.setData(mi.row(),ComicModel::Rating,rating);
 	DBHelper::update(&(comic.info),db);
 
 	emit dataChanged(mi,mi);
@@ -9,11 +9,10 @@
 #include <QUrl>
 
 #include "yacreader_global_gui.h"
+#include "comic_item.h"
 
 class ComicDB;
 
-class ComicItem;
-
 using namespace YACReader;
 
 //! [0]
@@ -150,7 +149,7 @@ private:
 	void setupModelData( QSqlQuery &sqlquery);
     void setupModelDataForList(QSqlQuery &sqlquery);
 	ComicDB _getComic(const QModelIndex & mi);
-	QList<ComicItem *> _data;
+	ComicItemStore _data;
 
 	QString _databasePath;
 
@@ -45,6 +45,20 @@ static QString fields = 		"title ,"
 		"hash"
 		;
 
+//comic_info fields that can be imported from a comics info database (the hash is used to find the comic)
+static QStringList importableFields = QStringList()
+		<< "title"
+		<< "coverPage" << "numPages"
+		<< "number" << "isBis" << "count"
+		<< "volume" << "storyArc" << "arcNumber" << "arcCount"
+		<< "genere"
+		<< "writer" << "penciller" << "inker" << "colorist" << "letterer" << "coverArtist"
+		<< "date" << "publisher" << "format" << "color" << "ageRating"
+		<< "synopsis" << "characters" << "notes"
+		<< "comicVineID"
+		<< "lastTimeOpened"
+		<< "coverSizeRatio" << "originalCoverSize";
+
 DataBaseManagement::DataBaseManagement()
 	:QObject(),dataBasesList()
 {
@@ -67,7 +81,7 @@ QSqlDatabase DataBaseManagement::createDatabase(QString name, QString path)
 }
 
 QSqlDatabase DataBaseManagement::createDatabase(QString dest)
-{
+{
     QString threadId = QString::number((long long)QThread::currentThreadId(), 16);
 	QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE",dest+threadId);
 	db.setDatabaseName(dest);
@@ -80,6 +94,7 @@ QSqlDatabase DataBaseManagement::createDatabase(QString dest)
 	{
 	QSqlQuery pragma("PRAGMA foreign_keys = ON",db);
 	//pragma.finish();
+	setUpConnection(db);
 	DataBaseManagement::createTables(db);
 	
 	QSqlQuery query("INSERT INTO folder (parentId, name, path) "
@@ -91,18 +106,40 @@ QSqlDatabase DataBaseManagement::createDatabase(QString dest)
 	return db;
 }
 
+static QMutex openStatsMutex;
+static DataBaseManagement::OpenStats totalOpenStats = {0, 0, 0};
+
+DataBaseManagement::OpenStats DataBaseManagement::openStats()
+{
+    QMutexLocker locker(&openStatsMutex);
+    return totalOpenStats;
+}
+
 QSqlDatabase DataBaseManagement::loadDatabase(QString path)
 {
-	//TODO check path
+    QElapsedTimer timer;
+    timer.start();
+
+	//TODO check path
     QString threadId = QString::number((long long)QThread::currentThreadId(), 16);
-	QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE",path+threadId);
+	QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE",path+threadId);
     db.setDatabaseName(path + "/library.ydb");
 	if (!db.open()) {
 		//se devuelve una base de datos vacía e inválida
-		
+		QMutexLocker locker(&openStatsMutex);
+		totalOpenStats.failures++;
 		return QSqlDatabase();
 	}
+	{
 	QSqlQuery pragma("PRAGMA foreign_keys = ON",db);
+	}
+	setUpConnection(db);
+
+	{
+	QMutexLocker locker(&openStatsMutex);
+	totalOpenStats.opens++;
+	totalOpenStats.microseconds += timer.nsecsElapsed() / 1000;
+	}
 	//pragma.finish();
 	//devuelve la base de datos
 	return db;
@@ -110,7 +147,7 @@ QSqlDatabase DataBaseManagement::loadDatabase(QString path)
 
 QSqlDatabase DataBaseManagement::loadDatabaseFromFile(QString filePath)
 {
-	//TODO check path
+	//TODO check path
     QString threadId = QString::number((long long)QThread::currentThreadId(), 16);
 	QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE",filePath+threadId);
 	db.setDatabaseName(filePath);
@@ -208,12 +245,14 @@ bool DataBaseManagement::createTables(QSqlDatabase & database)
                             "numChildren INTEGER,"
                             "firstChildHash TEXT,"
                             "customImage TEXT,"
+                            //natural sort keys (see addSortKeys)
+                            "sortKey TEXT,"
                             "FOREIGN KEY(parentId) REFERENCES folder(id) ON DELETE CASCADE)");
         success = success && queryFolder.exec();
 
         //COMIC (representa un cómic en disco, contiene el nombre de fichero)
         QSqlQuery queryComic(database);
-        queryComic.prepare("CREATE TABLE comic (id INTEGER PRIMARY KEY, parentId INTEGER NOT NULL, comicInfoId INTEGER NOT NULL,  fileName TEXT NOT NULL, path TEXT, FOREIGN KEY(parentId) REFERENCES folder(id) ON DELETE CASCADE, FOREIGN KEY(comicInfoId) REFERENCES comic_info(id))");
+        queryComic.prepare("CREATE TABLE comic (id INTEGER PRIMARY KEY, parentId INTEGER NOT NULL, comicInfoId INTEGER NOT NULL,  fileName TEXT NOT NULL, path TEXT, sortKey TEXT, FOREIGN KEY(parentId) REFERENCES folder(id) ON DELETE CASCADE, FOREIGN KEY(comicInfoId) REFERENCES comic_info(id))");
         success = success && queryComic.exec();
         //queryComic.finish();
         //DB INFO
@@ -228,6 +267,9 @@ bool DataBaseManagement::createTables(QSqlDatabase & database)
 
         //8.0> tables
         success = success && DataBaseManagement::createV8Tables(database);
+
+        //natural sort keys indexes
+        success = success && DataBaseManagement::createSortKeyIndexes(database);
     }
 
     return success;
@@ -323,26 +365,78 @@ bool DataBaseManagement::createV8Tables(QSqlDatabase &database)
     return success;
 }
 
+bool DataBaseManagement::createSortKeyIndexes(QSqlDatabase &database)
+{
+    bool success = true;
+    {
+        //folder listings are sorted and paginated by SQL
+        QSqlQuery queryIndexFolder(database);
+        success = success && queryIndexFolder.exec("CREATE INDEX folder_sort_key_index ON folder (parentId, sortKey)");
+
+        QSqlQuery queryIndexComic(database);
+        success = success && queryIndexComic.exec("CREATE INDEX comic_sort_key_index ON comic (parentId, sortKey)");
+    }
+    return success;
+}
+
+bool DataBaseManagement::addSortKeys(QSqlDatabase &database)
+{
+    {
+        QSqlQuery tableInfo(database);
+        tableInfo.exec("PRAGMA table_info(comic)");
+        while(tableInfo.next())
+            if(tableInfo.value(1).toString() == "sortKey")
+                return true;
+    }
+
+    bool success = true;
+
+    {//folder
+        QStringList columnDefs;
+        columnDefs << "sortKey TEXT";
+        success = addColumns("folder", columnDefs, database) && success;
+    }
+
+    {//comic
+        QStringList columnDefs;
+        columnDefs << "sortKey TEXT";
+        success = addColumns("comic", columnDefs, database) && success;
+    }
+
+    DBHelper::updateSortKeys(database);
+
+    success = createSortKeyIndexes(database) && success;
+
+    return success;
+}
+
+bool DataBaseManagement::addSortKeys(const QString &path)
+{
+    QSqlDatabase db = loadDatabase(path);
+    bool success = db.isValid() && db.isOpen() && addSortKeys(db);
+
+    db.close();
+    QSqlDatabase::removeDatabase(db.connectionName());
+    return success;
+}
+
 void DataBaseManagement::exportComicsInfo(QString source, QString dest)
 {
 	//QSqlDatabase sourceDB = loadDatabase(source);
 	QSqlDatabase destDB = loadDatabaseFromFile(dest);
 	//sourceDB.open();
     {
+	//the destination database is the main one, the info is copied from the library using a single INSERT ... SELECT
 	QSqlQuery attach(destDB);
-	attach.prepare("ATTACH DATABASE '"+QDir().toNativeSeparators(dest) +"' AS dest;");
-	//attach.bindValue(":dest",QDir().toNativeSeparators(dest));
+	attach.prepare("ATTACH DATABASE :source AS source");
+	attach.bindValue(":source",QDir().toNativeSeparators(source));
 	attach.exec();
 	//attach.finish();
 
-	QSqlQuery attach2(destDB);
-	attach2.prepare("ATTACH DATABASE '"+QDir().toNativeSeparators(source) +"' AS source;");
-	attach2.exec();
-	//attach2.finish();
+	destDB.transaction();
 
-	//sourceDB.close();
 	QSqlQuery queryDBInfo(destDB);
-	queryDBInfo.prepare("CREATE TABLE dest.db_info (version TEXT NOT NULL)");
+	queryDBInfo.prepare("CREATE TABLE db_info (version TEXT NOT NULL)");
 	queryDBInfo.exec();
 	//queryDBInfo.finish();
 
@@ -350,214 +444,134 @@ void DataBaseManagement::exportComicsInfo(QString source, QString dest)
 	queryComicsInfo.prepare("CREATE TABLE dest.comic_info (id INTEGER PRIMARY KEY, hash TEXT NOT NULL, edited BOOLEAN DEFAULT FALSE, title TEXT, read BOOLEAN)");
 	queryComicsInfo.exec();*/
 
-	QSqlQuery query("INSERT INTO dest.db_info (version) "
+	QSqlQuery query("INSERT INTO db_info (version) "
         "VALUES ('" VERSION "')",destDB);
 	//query.finish();
 
 	QSqlQuery exportData(destDB);
-	exportData.prepare("create table dest.comic_info as select " + fields +
+	exportData.prepare("create table comic_info as select " + fields +
 		" from source.comic_info where source.comic_info.edited = 1");
 	exportData.exec();
 	//exportData.finish();
+
+	destDB.commit();
+
+	QSqlQuery detach("DETACH DATABASE source",destDB);
 	}
 
 	//sourceDB.close();
 	destDB.close();
-	QSqlDatabase::removeDatabase(dest);
+	QSqlDatabase::removeDatabase(destDB.connectionName());
 
 }
 
-bool DataBaseManagement::importComicsInfo(QString source, QString dest)
+bool DataBaseManagement::importComicsInfo(QString source, QString dest, std::function<void (int, int)> progress)
 {
-	QString error;
-	QString driver;
 	QStringList hashes;
 
-	bool b = false;
+	bool success = false;
 
-	QSqlDatabase sourceDB = loadDatabaseFromFile(source);
 	QSqlDatabase destDB = loadDatabaseFromFile(dest);
 
 	{
 	QSqlQuery pragma("PRAGMA synchronous=OFF",destDB);
-	
 
-	QSqlQuery newInfo(sourceDB);
-	newInfo.prepare("SELECT * FROM comic_info");
-	newInfo.exec();
-	destDB.transaction();
-	int cp;
-	while (newInfo.next()) //cada tupla deberá ser insertada o actualizada
+	QSqlQuery attach(destDB);
+	attach.prepare("ATTACH DATABASE :source AS source");
+	attach.bindValue(":source",QDir().toNativeSeparators(source));
+	if(!attach.exec())
+	{
+		QLOG_ERROR() << "Unable to attach the comics info database" << source << attach.lastError().text();
+	}
+	else
 	{
-		QSqlQuery update(destDB);
-		update.prepare("UPDATE comic_info SET "
-			"title = :title,"
-
-			"coverPage = :coverPage,"
-			"numPages = :numPages,"
-
-			"number = :number,"
-			"isBis = :isBis,"
-			"count = :count,"
-
-			"volume = :volume,"
-			"storyArc = :storyArc,"
-			"arcNumber = :arcNumber,"
-			"arcCount = :arcCount,"
-
-			"genere = :genere,"
-
-			"writer = :writer,"
-			"penciller = :penciller,"
-			"inker = :inker,"
-			"colorist = :colorist,"
-			"letterer = :letterer,"
-			"coverArtist = :coverArtist,"
-
-			"date = :date,"
-			"publisher = :publisher,"
-			"format = :format,"
-			"color = :color,"
-			"ageRating = :ageRating,"
-
-			"synopsis = :synopsis,"
-			"characters = :characters,"
-			"notes = :notes,"
-
-            "edited = :edited,"
-
-            "comicVineID = :comicVineID,"
-
-            "lastTimeOpened = :lastTimeOpened,"
-
-            "coverSizeRatio = :coverSizeRatio,"
-            "originalCoverSize = :originalCoverSize"
-
-			" WHERE hash = :hash ");
-
-		QSqlQuery insert(destDB);
-		insert.prepare("INSERT INTO comic_info "
-			"(title,"
-			"coverPage,"
-			"numPages,"
-			"number,"
-			"isBis,"
-			"count,"
-			"volume,"
-			"storyArc,"
-			"arcNumber,"
-			"arcCount,"
-			"genere,"
-			"writer,"
-			"penciller,"
-			"inker,"
-			"colorist,"
-			"letterer,"
-			"coverArtist,"
-			"date,"
-			"publisher,"
-			"format,"
-			"color,"
-			"ageRating,"
-			"synopsis,"
-			"characters,"
-			"notes,"
-			"read,"
-			"edited,"
-            "comicVineID,"
-            "lastTimeOpened,"
-            "coverSizeRatio,"
-			"hash)"
-
-			"VALUES (:title,"
-			":coverPage,"
-			":numPages,"
-			":number,"
-			":isBis,"
-			":count,"
-
-			":volume,"
-			":storyArc,"
-			":arcNumber,"
-			":arcCount,"
-
-			":genere,"
-
-			":writer,"
-			":penciller,"
-			":inker,"
-			":colorist,"
-			":letterer,"
-			":coverArtist,"
-
-			":date,"
-			":publisher,"
-			":format,"
-			":color,"
-			":ageRating,"
-
-			":synopsis,"
-			":characters,"
-			":notes,"
-
-			":read,"
-			":edited,"
-            ":comicVineID,"
-
-            ":lastTimeOpened,"
-
-            ":coverSizeRatio,"
-            ":originalCoverSize,"
-
-			":hash )");
-
-		QSqlRecord record = newInfo.record();
-		cp = record.value("coverPage").toInt();
-		if(cp>1)
+		//only the fields available in the source database are imported (it could be an info database from a previous version)
+		QStringList sourceFields;
+		QSqlQuery tableInfo(destDB);
+		tableInfo.exec("PRAGMA source.table_info(comic_info)");
+		while(tableInfo.next())
+			sourceFields << tableInfo.value(1).toString();
+		tableInfo.finish();
+
+		QStringList importFields;
+		foreach(QString field, importableFields)
+			if(sourceFields.contains(field))
+				importFields << field;
+
+		if(sourceFields.contains("hash"))
 		{
-			QSqlQuery checkCoverPage(destDB);
-			checkCoverPage.prepare("SELECT coverPage FROM comic_info where hash = :hash");
-			checkCoverPage.bindValue(":hash",record.value("hash").toString());
-			checkCoverPage.exec();
-			bool extract = false;
-			if(checkCoverPage.next())
+			destDB.transaction();
+
+			//comics with a new cover page need their covers to be generated again
+			if(importFields.contains("coverPage"))
 			{
-				extract = checkCoverPage.record().value("coverPage").toInt() != cp;
+				QSqlQuery coverChanges(destDB);
+				coverChanges.exec("SELECT s.hash FROM source.comic_info s INNER JOIN main.comic_info ci ON (s.hash = ci.hash) "
+				                  "WHERE s.coverPage > 1 AND s.coverPage <> ci.coverPage");
+				while(coverChanges.next())
+					hashes.append(coverChanges.value(0).toString());
+				coverChanges.finish();
 			}
-			if(extract)
-				hashes.append(record.value("hash").toString());
-		}
 
-		bindValuesFromRecord(record,update);
+			if(progress)
+				progress(0, hashes.size() + 1);
 
-		update.bindValue(":edited",1);
+			QString columns = importFields.isEmpty() ? QString() : importFields.join(",") + ",";
 
-		
-		update.exec();
-
-		if(update.numRowsAffected() == 0)
-		{
+			//UPSERT needs SQLite 3.24, older versions (e.g. the ones bundled with Qt < 5.12) update and insert in two steps
+			QSqlQuery version("SELECT sqlite_version()",destDB);
+			QStringList sqliteVersion = version.next() ? version.value(0).toString().split('.') : QStringList();
+			version.finish();
+			bool upsertSupported = sqliteVersion.size() >= 2 &&
+			                       (sqliteVersion.at(0).toInt() > 3 || (sqliteVersion.at(0).toInt() == 3 && sqliteVersion.at(1).toInt() >= 24));
 
-			bindValuesFromRecord(record,insert);
-			insert.bindValue(":edited",1);
-			insert.bindValue(":read",0);
-
-			insert.exec();
-
-			QString error1 = insert.lastError().databaseText();
-			QString error2 = insert.lastError().driverText();
+			if(upsertSupported)
+			{
+				QStringList updates;
+				foreach(QString field, importFields)
+					updates << field + " = excluded." + field;
+				updates << "edited = 1";
+
+				QSqlQuery upsert(destDB);
+				success = upsert.exec("INSERT INTO main.comic_info (" + columns + "edited,read,hash) "
+				                      "SELECT " + columns + "1,0,hash FROM source.comic_info WHERE 1 " //WHERE is needed by the parser when using ON CONFLICT with SELECT
+				                      "ON CONFLICT(hash) DO UPDATE SET " + updates.join(","));
+				if(!success)
+					QLOG_ERROR() << "Error importing comics info" << upsert.lastError().text();
+			}
+			else
+			{
+				QStringList updates;
+				foreach(QString field, importFields)
+					updates << field + " = (SELECT s." + field + " FROM source.comic_info s WHERE s.hash = main.comic_info.hash)";
+				updates << "edited = 1";
+
+				QSqlQuery update(destDB);
+				success = update.exec("UPDATE main.comic_info SET " + updates.join(",") + " "
+				                      "WHERE hash IN (SELECT hash FROM source.comic_info)");
+				if(!success)
+					QLOG_ERROR() << "Error updating comics info" << update.lastError().text();
+
+				QSqlQuery insert(destDB);
+				success = success && insert.exec("INSERT INTO main.comic_info (" + columns + "edited,read,hash) "
+				                                  "SELECT " + columns + "1,0,s.hash FROM source.comic_info s "
+				                                  "WHERE NOT EXISTS (SELECT 1 FROM main.comic_info ci WHERE ci.hash = s.hash)");
+				if(!success)
+					QLOG_ERROR() << "Error inserting comics info" << insert.lastError().text();
+			}
 
-			//QMessageBox::critical(NULL,"db",error1);
-			//QMessageBox::critical(NULL,"driver",error2);
-		}
-		//update.finish();
-		//insert.finish();
+			if(success)
+				destDB.commit();
+			else
+				destDB.rollback();
 		}
+
+		QSqlQuery detach("DETACH DATABASE source",destDB);
+	}
 	}
 
-	destDB.commit();
-	QString hash;
-	foreach(hash, hashes)
+	int done = 1;
+	foreach(QString hash, hashes)
 	{
 		QSqlQuery getComic(destDB);
 		getComic.prepare("SELECT c.path,ci.coverPage FROM comic c INNER JOIN comic_info ci ON (c.comicInfoId = ci.id) where ci.hash = :hash");
@@ -572,59 +586,27 @@ bool DataBaseManagement::importComicsInfo(QString source, QString dest)
 			tc.create();
 
 		}
+
+		if(progress)
+			progress(++done, hashes.size() + 1);
 	}
 
 	destDB.close();
-	sourceDB.close();
-	QSqlDatabase::removeDatabase(source);
-	QSqlDatabase::removeDatabase(dest);
-	return b;
+	QSqlDatabase::removeDatabase(destDB.connectionName());
+	return success;
 
 }
-//TODO fix these bindings
-void DataBaseManagement::bindValuesFromRecord(const QSqlRecord & record, QSqlQuery & query)
-{
-	bindString("title",record,query);
-
-	bindInt("coverPage",record,query);
-	bindInt("numPages",record,query);
-
-	bindInt("number",record,query);
-	bindInt("isBis",record,query);
-	bindInt("count",record,query);
-
-	bindString("volume",record,query);
-	bindString("storyArc",record,query);
-	bindInt("arcNumber",record,query);
-	bindInt("arcCount",record,query);
 
-	bindString("genere",record,query);
-
-	bindString("writer",record,query);
-	bindString("penciller",record,query);
-	bindString("inker",record,query);
-	bindString("colorist",record,query);
-	bindString("letterer",record,query);
-	bindString("coverArtist",record,query);
-
-	bindString("date",record,query);
-	bindString("publisher",record,query);
-	bindString("format",record,query);
-	bindInt("color",record,query);
-	bindString("ageRating",record,query);
-
-	bindString("synopsis",record,query);
-	bindString("characters",record,query);
-	bindString("notes",record,query);
-
-    bindString("comicVineID",record,query);
-
-    bindString("lastTimeOpened",record,query);
-
-    bindDouble("coverSizeRatio",record,query);
-    bindString("originalCoverSize",record,query);
-
-    bindString("hash",record,query);
+void DataBaseManagement::setUpConnection(const QSqlDatabase &db)
+{
+    //journal_mode is stored in the database file, the rest of the values only apply to this connection
+    QSqlQuery pragma(db);
+    if(!pragma.exec("PRAGMA journal_mode = WAL"))
+        QLOG_WARN() << "Unable to enable WAL journaling" << pragma.lastError().text();
+    pragma.exec("PRAGMA synchronous = NORMAL");
+    pragma.exec("PRAGMA cache_size = -8000"); //in KiB
+    pragma.exec("PRAGMA mmap_size = 268435456");
+    pragma.exec("PRAGMA temp_store = MEMORY");
 }
 
 bool DataBaseManagement::addColumns(const QString &tableName, const QStringList &columnDefs, const QSqlDatabase &db)
@@ -661,29 +643,6 @@ bool DataBaseManagement::addConstraint(const QString &tableName, const QString &
     return returnValue;
 }
 
-void DataBaseManagement::bindString(const QString & name, const QSqlRecord & record, QSqlQuery & query)
-{
-	if(!record.value(name).isNull())
-	{
-		query.bindValue(":"+name,record.value(name).toString());
-	}
-}
-void DataBaseManagement::bindInt(const QString & name, const QSqlRecord & record, QSqlQuery & query)
-{
-	if(!record.value(name).isNull())
-	{
-		query.bindValue(":"+name,record.value(name).toInt());
-	}
-}
-
-void DataBaseManagement::bindDouble(const QString & name, const QSqlRecord & record, QSqlQuery & query)
-{
-    if(!record.value(name).isNull())
-    {
-        query.bindValue(":"+name,record.value(name).toDouble());
-    }
-}
-
 QString DataBaseManagement::checkValidDB(const QString & fullPath)
 {
 	QSqlDatabase db = loadDatabaseFromFile(fullPath);
@@ -699,7 +658,7 @@ QString DataBaseManagement::checkValidDB(const QString & fullPath)
 	}
 
 	db.close();
-    QSqlDatabase::removeDatabase(db.connectionName());
+    QSqlDatabase::removeDatabase(db.connectionName());
     
 	return versionString;
 }
@@ -864,6 +823,9 @@ bool DataBaseManagement::updateToCurrentVersion(const QString & path)
                 db.commit();
             }
         }
+
+        bool successAddingSortKeys = addSortKeys(db);
+        returnValue = returnValue && successAddingSortKeys;
 	}
 
 	db.close();
@@ -5,6 +5,8 @@
 #include <QtSql>
 #include <QSqlDatabase>
 
+#include <functional>
+
 #include "folder_model.h"
 
 class ComicsInfoExporter : public QThread
@@ -33,14 +35,13 @@ class DataBaseManagement : public QObject
 	Q_OBJECT
 private:
 	QList<QString> dataBasesList;
-	static void bindString(const QString & name, const QSqlRecord & record, QSqlQuery & query);
-	static void bindInt(const QString & name, const QSqlRecord & record, QSqlQuery & query);
-    static void bindDouble(const QString & name, const QSqlRecord & record, QSqlQuery & query);
-	static void bindValuesFromRecord(const QSqlRecord & record, QSqlQuery & query);
 
     static bool addColumns(const QString & tableName, const QStringList & columnDefs, const QSqlDatabase & db);
     static bool addConstraint(const QString  &tableName, const QString & constraint, const QSqlDatabase & db);
 
+    //WAL journaling + per connection tuning, readers (GUI models, server) don't block while the library is being updated
+    static void setUpConnection(const QSqlDatabase & db);
+
 public:
 	DataBaseManagement();
 	//TreeModel * newTreeModel(QString path);
@@ -49,12 +50,25 @@ public:
 	static QSqlDatabase createDatabase(QString dest);
 	//carga una base de datos desde la ruta path
 	static QSqlDatabase loadDatabase(QString path);
+
+    //connections opened by loadDatabase and the time spent opening them
+    struct OpenStats {
+        quint64 opens;
+        quint64 failures;
+        quint64 microseconds;
+    };
+    static OpenStats openStats();
 	static QSqlDatabase loadDatabaseFromFile(QString path);
 	static bool createTables(QSqlDatabase & database);
     static bool createV8Tables(QSqlDatabase & database);
+    static bool createSortKeyIndexes(QSqlDatabase & database);
+    //the sort keys don't change the DB version, they are added to the libraries that don't have them yet when they are opened or updated
+    static bool addSortKeys(QSqlDatabase & database);
+    static bool addSortKeys(const QString & path);
 
 	static void exportComicsInfo(QString source, QString dest);
-	static bool importComicsInfo(QString source, QString dest);
+	//progress(done, total)
+	static bool importComicsInfo(QString source, QString dest, std::function<void (int, int)> progress = nullptr);
 
 	static QString checkValidDB(const QString & fullPath); //retorna "" si la DB es inválida ó la versión si es válida.
 	static int compareVersions(const QString & v1, const QString v2); //retorna <0 si v1 < v2, 0 si v1 = v2 y >0 si v1 > v2
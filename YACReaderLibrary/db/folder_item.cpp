@@ -7,6 +7,9 @@ FolderItem::FolderItem(const QList<QVariant> &data, FolderItem *parent)
 {
 	parentItem = parent;
 	itemData = data;
+	numChildren = -1;
+	hasSubfolders = true;
+	childrenFetched = false;
 }
 
 FolderItem::~FolderItem()
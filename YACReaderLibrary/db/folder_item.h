@@ -64,6 +64,9 @@ public:
 	unsigned long long int id;
 	QList<QString> comicNames;
     FolderItem * originalItem;
+    int numChildren; //subfolders + comics, from the DB (-1 if unknown)
+    bool hasSubfolders; //from the DB, true if unknown
+    bool childrenFetched; //subfolders are loaded on demand
     void setData(int column, const QVariant &value);
     void removeChild(int childIndex);
     void clearChildren();
@@ -149,7 +149,7 @@ QVariant FolderModel::data(const QModelIndex &index, int role) const
     if (role == Qt::ToolTipRole)
     {
         QString toolTip = item->data(FolderModel::Name).toString();
-        int totalNumOfChildren = item->childCount() + item->comicNames.size();
+        int totalNumOfChildren = item->numChildren >= 0 ? item->numChildren : item->childCount() + item->comicNames.size();
         if(totalNumOfChildren > 0)
         {
            toolTip = toolTip + " - " + QString::number(totalNumOfChildren);
@@ -280,6 +280,40 @@ int FolderModel::rowCount(const QModelIndex &parent) const
 }
 //! [8]
 
+bool FolderModel::hasChildren(const QModelIndex &parent) const
+{
+    if (parent.column() > 0 || rootItem == 0)
+        return false;
+
+    FolderItem * item = itemFromIndex(parent);
+
+    if(!item->childrenFetched)
+        return item->hasSubfolders;
+
+    return item->childCount() > 0;
+}
+
+bool FolderModel::canFetchMore(const QModelIndex &parent) const
+{
+    if(rootItem == 0)
+        return false;
+
+    FolderItem * item = itemFromIndex(parent);
+    return !item->childrenFetched && item->hasSubfolders;
+}
+
+void FolderModel::fetchMore(const QModelIndex &parent)
+{
+    FolderItem * item = itemFromIndex(parent);
+    if(item->childrenFetched)
+        return;
+
+    QSqlDatabase db = DataBaseManagement::loadDatabase(_databasePath);
+    fetchChildren(item, db);
+    db.close();
+    QSqlDatabase::removeDatabase(db.connectionName());
+}
+
 void FolderModel::setupModelData(QString path)
 {
 	beginResetModel();
@@ -295,16 +329,27 @@ void FolderModel::setupModelData(QString path)
 	rootItem->id = ROOT;
 	rootItem->parentItem = 0;
 
-	//cargar la base de datos
+	items.clear();
+	items.insert(rootItem->id,rootItem);
+
+	//cargar la base de datos, only the first level is loaded, the rest is fetched on demand
 	_databasePath = path;
 	QSqlDatabase db = DataBaseManagement::loadDatabase(path);
-	//crear la consulta
 	{
-	QSqlQuery selectQuery("select * from folder where id <> 1 order by parentId,name",db);
-
-	setupModelData(selectQuery,rootItem);
+	QSqlQuery selectQuery(db);
+	selectQuery.setForwardOnly(true);
+	selectQuery.prepare("select f.*, exists(select 1 from folder s where s.parentId = f.id) as hasSubfolders "
+	                    "from folder f where f.id <> 1 and f.parentId = :parentId order by f.name");
+	selectQuery.bindValue(":parentId", ROOT);
+	selectQuery.exec();
+
+	foreach(FolderItem * item, updateFolderModelData(selectQuery))
+	{
+		rootItem->appendChild(item);
+		items.insert(item->id,item);
+	}
+	rootItem->childrenFetched = true;
 	}
-	//selectQuery.finish();
 	db.close();
 	QSqlDatabase::removeDatabase(db.connectionName());
 	endResetModel();
@@ -319,6 +364,7 @@ void FolderModel::setupModelData(QSqlQuery &sqlquery, FolderItem *parent)
 	items.clear();
 	//se a�ade el nodo 0
     items.insert(parent->id,parent);
+    parent->childrenFetched = true;
 
     QSqlRecord record = sqlquery.record();
 
@@ -339,6 +385,7 @@ void FolderModel::setupModelData(QSqlQuery &sqlquery, FolderItem *parent)
         FolderItem * item = new FolderItem(data);
 
         item->id = sqlquery.value(id).toULongLong();
+        item->childrenFetched = true; //the whole tree is in the query
 		//la inserci�n de hijos se hace de forma ordenada
         FolderItem * parent = items.value(sqlquery.value(parentId).toULongLong());
         //if(parent !=0) //TODO if parent==0 the parent of item was removed from the DB and delete on cascade didn't work, ERROR.
@@ -348,9 +395,10 @@ void FolderModel::setupModelData(QSqlQuery &sqlquery, FolderItem *parent)
     }
 }
 
-void FolderModel::updateFolderModelData(QSqlQuery &sqlquery, FolderItem *parent)
+//creates the items for the folders in the query, they are not added to the tree
+QList<FolderItem *> FolderModel::updateFolderModelData(QSqlQuery &sqlquery)
 {
-    Q_UNUSED(parent);
+    QList<FolderItem *> result;
 
     QSqlRecord record = sqlquery.record();
 
@@ -359,7 +407,8 @@ void FolderModel::updateFolderModelData(QSqlQuery &sqlquery, FolderItem *parent)
     int finished = record.indexOf("finished");
     int completed = record.indexOf("completed");
     int id = record.indexOf("id");
-    int parentId = record.indexOf("parentId");
+    int numChildren = record.indexOf("numChildren");
+    int hasSubfolders = record.indexOf("hasSubfolders");
 
     while (sqlquery.next()) {
         QList<QVariant> data;
@@ -371,13 +420,126 @@ void FolderModel::updateFolderModelData(QSqlQuery &sqlquery, FolderItem *parent)
         FolderItem * item = new FolderItem(data);
 
         item->id = sqlquery.value(id).toULongLong();
-        //la inserci�n de hijos se hace de forma ordenada
-        FolderItem * parent = items.value(sqlquery.value(parentId).toULongLong());
-        if(parent !=0) //TODO if parent==0 the parent of item was removed from the DB and delete on cascade didn't work, ERROR.
-            parent->appendChild(item);
-        //se a�ade el item al map, de forma que se pueda encontrar como padre en siguientes iteraciones
-        items.insert(item->id,item);
+        if(numChildren != -1 && !sqlquery.value(numChildren).isNull())
+            item->numChildren = sqlquery.value(numChildren).toInt();
+        if(hasSubfolders != -1)
+            item->hasSubfolders = sqlquery.value(hasSubfolders).toBool();
+
+        result << item;
+    }
+
+    return result;
+}
+
+void FolderModel::fetchChildren(FolderItem *item, QSqlDatabase &db)
+{
+    if(item->childrenFetched)
+        return;
+
+    QSqlQuery selectQuery(db);
+    selectQuery.setForwardOnly(true);
+    selectQuery.prepare("select f.*, exists(select 1 from folder s where s.parentId = f.id) as hasSubfolders "
+                        "from folder f where f.id <> 1 and f.parentId = :parentId order by f.name");
+    selectQuery.bindValue(":parentId", item->id);
+    selectQuery.exec();
+
+    QList<FolderItem *> children = updateFolderModelData(selectQuery);
+    item->childrenFetched = true;
+
+    if(children.isEmpty())
+        return;
+
+    //the item had no children, so the new rows are 0..n-1 whatever order appendChild uses
+    beginInsertRows(indexFromItem(item), 0, children.count()-1);
+    foreach(FolderItem * child, children)
+    {
+        item->appendChild(child);
+        items.insert(child->id,child);
     }
+    endInsertRows();
+}
+
+void FolderModel::removeChildren(FolderItem *item)
+{
+    if(item->childCount() > 0)
+    {
+        beginRemoveRows(indexFromItem(item), 0, item->childCount()-1);
+        foreach(FolderItem * child, item->children())
+            unregisterItems(child);
+        item->clearChildren();
+        endRemoveRows();
+    }
+
+    item->childrenFetched = false;
+}
+
+void FolderModel::unregisterItems(FolderItem *item)
+{
+    items.remove(item->id);
+    foreach(FolderItem * child, item->children())
+        unregisterItems(child);
+}
+
+FolderItem *FolderModel::itemFromIndex(const QModelIndex &index) const
+{
+    if(index.isValid())
+        return static_cast<FolderItem*>(index.internalPointer());
+    return rootItem;
+}
+
+QModelIndex FolderModel::indexFromItem(FolderItem *item) const
+{
+    if(item == 0 || item == rootItem)
+        return QModelIndex();
+    return createIndex(item->row(), 0, item);
+}
+
+QModelIndex FolderModel::getIndexFromId(qulonglong folderId)
+{
+    if(items.contains(folderId))
+        return indexFromItem(items.value(folderId));
+
+    QSqlDatabase db = DataBaseManagement::loadDatabase(_databasePath);
+    QModelIndex index = getIndexFromId(folderId, db);
+    db.close();
+    QSqlDatabase::removeDatabase(db.connectionName());
+
+    return index;
+}
+
+QModelIndex FolderModel::getIndexFromId(qulonglong folderId, QSqlDatabase &db)
+{
+    if(rootItem == 0)
+        return QModelIndex();
+
+    FolderItem * item = items.value(folderId);
+    if(item != 0)
+        return indexFromItem(item);
+
+    //walk up until an already loaded ancestor is found...
+    QList<qulonglong> ancestors;
+    qulonglong id = folderId;
+    while(!items.contains(id))
+    {
+        Folder folder = DBHelper::loadFolder(id, db);
+        if(!folder.knownId || ancestors.contains(folder.parentId))
+            return QModelIndex();
+
+        ancestors.prepend(id);
+        id = folder.parentId;
+    }
+
+    //...and fetch the levels below it
+    item = items.value(id);
+    foreach(qulonglong ancestorId, ancestors)
+    {
+        fetchChildren(item, db);
+        item = items.value(ancestorId);
+        if(item == 0)
+            return QModelIndex();
+    }
+
+    return indexFromItem(item);
 }
 
 QString FolderModel::getDatabase()
@@ -476,74 +638,24 @@ QStringList FolderModel::getSubfoldersNames(const QModelIndex &mi)
     return result;
 }
 
+//reloads the children of parent, deeper levels are fetched again when they are expanded
 void FolderModel::fetchMoreFromDB(const QModelIndex &parent)
 {
-    FolderItem * item;
-    if(parent.isValid())
-        item = static_cast<FolderItem*>(parent.internalPointer());
-    else
-        item = rootItem;
+    FolderItem * item = itemFromIndex(parent);
 
-    //Remove all children
-    if(item->childCount() > 0)
-    {
-        beginRemoveRows(parent, 0, item->childCount()-1);
-        item->clearChildren();
-        endRemoveRows();
-    }
+    removeChildren(item);
 
     QSqlDatabase db = DataBaseManagement::loadDatabase(_databasePath);
 
-    QList<FolderItem *> items;
-    QList<FolderItem *> nextLevelItems;
-
-    QSqlQuery selectQuery(db);
-    selectQuery.prepare("select * from folder where id <> 1 and parentId = :parentId order by parentId,name");
-
-    items << item;
-    bool firstLevelUpdated = false;
-    while(items.size() > 0)
+    if(item != rootItem)
     {
-        nextLevelItems.clear();
-        foreach(FolderItem * item, items)
-        {
-            QLOG_DEBUG() << "ID " << item->id;
-            selectQuery.bindValue(":parentId", item->id);
-
-            selectQuery.exec();
-
-            if(!firstLevelUpdated)
-            {
-                //NO size support
-                int numResults = 0;
-                while(selectQuery.next())
-                    numResults++;
-
-                if(!selectQuery.seek(-1))
-                    selectQuery.exec();
-                //END no size support
-
-                beginInsertRows(parent, 0, numResults-1);
-            }
-
-            updateFolderModelData(selectQuery,item);
-
-            if(!firstLevelUpdated)
-            {
-                endInsertRows();
-                firstLevelUpdated = true;
-            }
-
-            nextLevelItems << item->children();
-
-        }
-
-        items.clear();
-        items = nextLevelItems;
+        Folder folder = DBHelper::loadFolder(item->id, db);
+        item->numChildren = folder.getNumChildren();
     }
 
-    QLOG_DEBUG() << "item->childCount()-1" << item->childCount()-1;
+    fetchChildren(item, db);
 
+    QLOG_DEBUG() << "item->childCount()-1" << item->childCount()-1;
 
     db.close();
     QSqlDatabase::removeDatabase(db.connectionName());
@@ -558,6 +670,9 @@ QModelIndex FolderModel::addFolderAtParent(const QString &folderName, const QMod
     else
         parentItem = rootItem;
 
+    //the new folder must not be loaded twice
+    fetchMore(parent);
+
     Folder newFolder;
     newFolder.name = folderName;
     newFolder.parentId = parentItem->id;
@@ -578,12 +693,17 @@ QModelIndex FolderModel::addFolderAtParent(const QString &folderName, const QMod
 
     FolderItem * item = new FolderItem(data);
     item->id = newFolder.id;
+    item->hasSubfolders = false;
+    item->childrenFetched = true;
 
     beginInsertRows(parent,0,0); //TODO calculate the destRow before inserting the new child
 
     parentItem->appendChild(item);
     destRow = parentItem->children().indexOf(item); //TODO optimize this, appendChild should return the index of the new item
     items.insert(item->id,item);
+    if(parentItem->numChildren >= 0)
+        parentItem->numChildren++;
+    parentItem->hasSubfolders = true;
 
     endInsertRows();
 
@@ -598,6 +718,10 @@ void FolderModel::deleteFolder(const QModelIndex &mi)
 
    FolderItem * parent = item->parent();
    parent->removeChild(mi.row());
+   unregisterItems(item);
+   if(parent->numChildren > 0)
+       parent->numChildren--;
+   parent->hasSubfolders = parent->childCount() > 0;
 
    Folder f;
    f.setId(item->id);
@@ -657,24 +781,6 @@ void FolderModelProxy::setFilter(const YACReader::SearchModifiers modifier, QStr
 
 void FolderModelProxy::setupFilteredModelData()
 {
-    beginResetModel();
-
-    //TODO hay que liberar memoria de anteriores filtrados
-
-    //inicializar el nodo ra�z
-
-    if(rootItem != 0)
-        delete rootItem; //TODO comprobar que se libera bien la memoria
-
-    rootItem = 0;
-
-    //inicializar el nodo ra�z
-    QList<QVariant> rootData;
-    rootData << "root";
-    rootItem = new FolderItem(rootData);
-    rootItem->id = ROOT;
-    rootItem->parentItem = 0;
-
     FolderModel * model = static_cast<FolderModel *>(sourceModel());
 
     //cargar la base de datos
@@ -725,13 +831,36 @@ void FolderModelProxy::setupFilteredModelData()
     }
         selectQuery.exec();
 
+    //the folders found and their ancestors must be loaded in the source model before filtering
+    while(selectQuery.next())
+        model->getIndexFromId(selectQuery.value(0).toULongLong(),db);
+
+    if(!selectQuery.seek(-1))
+        selectQuery.exec();
+
+    beginResetModel();
+
+    //TODO hay que liberar memoria de anteriores filtrados
+
+    if(rootItem != 0)
+        delete rootItem; //TODO comprobar que se libera bien la memoria
+
+    rootItem = 0;
+
+    //inicializar el nodo ra�z
+    QList<QVariant> rootData;
+    rootData << "root";
+    rootItem = new FolderItem(rootData);
+    rootItem->id = ROOT;
+    rootItem->parentItem = 0;
+
     setupFilteredModelData(selectQuery,rootItem);
+
+    endResetModel();
     }
     //selectQuery.finish();
     db.close();
     QSqlDatabase::removeDatabase(db.connectionName());
-
-    endResetModel();
 }
 
 void FolderModelProxy::clear()
@@ -99,6 +99,9 @@ public:
 	QModelIndex parent(const QModelIndex &index) const;
 	int rowCount(const QModelIndex &parent = QModelIndex()) const;
 	int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
 
     //Convenience methods
     void setupModelData(QString path);
@@ -116,6 +119,9 @@ public:
 
     void fetchMoreFromDB(const QModelIndex & parent);
 
+    //loads the ancestors of the folder if they haven't been fetched yet
+    QModelIndex getIndexFromId(qulonglong folderId);
+
     QModelIndex addFolderAtParent(const QString & folderName, const QModelIndex & parent);
 
     enum Columns {
@@ -137,7 +143,13 @@ public slots:
 
 private:
 	void setupModelData( QSqlQuery &sqlquery, FolderItem *parent);
-    void updateFolderModelData( QSqlQuery &sqlquery, FolderItem *parent);
+    QList<FolderItem *> updateFolderModelData( QSqlQuery &sqlquery);
+    void fetchChildren(FolderItem *item, QSqlDatabase &db);
+    void removeChildren(FolderItem *item);
+    void unregisterItems(FolderItem *item);
+    QModelIndex getIndexFromId(qulonglong folderId, QSqlDatabase &db);
+    FolderItem * itemFromIndex(const QModelIndex &index) const;
+    QModelIndex indexFromItem(FolderItem *item) const;
 
 	FolderItem *rootItem; //el árbol
 	QMap<unsigned long long int, FolderItem *> items; //relación entre folders
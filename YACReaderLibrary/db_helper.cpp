@@ -11,6 +11,11 @@
 #include <QSqlDatabase>
 #include <QSqlRecord>
 #include <QSqlQuery>
+#include <QSqlDriver>
+#include <QSharedPointer>
+#include <QThreadStorage>
+#include <QPointer>
+#include <QMutex>
 
 #include <limits>
 
@@ -24,13 +29,64 @@
 #include "qnaturalsorting.h"
 
 #include "QsLog.h"
+
+//prepared statements of one connection, they become invalid when the connection is closed (the driver is destroyed)
+struct ConnectionQueries
+{
+    ConnectionQueries(QSqlDriver * driver) : driver(driver) {}
+    ~ConnectionQueries() { qDeleteAll(queries); }
+
+    QPointer<QSqlDriver> driver;
+    QHash<QString, QSqlQuery *> queries;
+};
+
+//connection name -> prepared statements
+static QThreadStorage<QHash<QString, QSharedPointer<ConnectionQueries> > *> queryCache;
+
+QSqlQuery & DBHelper::cachedQuery(const QString & sql, const QSqlDatabase & db)
+{
+    if(!queryCache.hasLocalData())
+        queryCache.setLocalData(new QHash<QString, QSharedPointer<ConnectionQueries> >);
+
+    QSharedPointer<ConnectionQueries> & connectionQueries = (*queryCache.localData())[db.connectionName()];
+    if(connectionQueries.isNull() || connectionQueries->driver.isNull() || connectionQueries->driver != db.driver() || !db.isOpen())
+        connectionQueries.reset(new ConnectionQueries(db.driver()));
+
+    QSqlQuery * query = connectionQueries->queries.value(sql, nullptr);
+    if(query == nullptr)
+    {
+        query = new QSqlQuery(db);
+        if(!query->prepare(sql))
+            QLOG_ERROR() << "Unable to prepare query" << sql << query->lastError().text();
+        connectionQueries->queries.insert(sql, query);
+    }
+
+    return *query;
+}
+
 //server
 
+//the libraries are read again only when the settings file changes
 YACReaderLibraries DBHelper::getLibraries()
 {
-	YACReaderLibraries libraries;
-	libraries.load();
-	return libraries;
+    static QMutex librariesMutex;
+    static YACReaderLibraries libraries;
+    static QDateTime librariesModified;
+    static qint64 librariesSize = -1;
+
+    QMutexLocker locker(&librariesMutex);
+
+    QFileInfo settings(YACReader::getSettingsPath()+"/"+QCoreApplication::applicationName()+".ini");
+    QDateTime modified = settings.lastModified();
+    if(!librariesModified.isValid() || modified != librariesModified || settings.size() != librariesSize)
+    {
+        libraries = YACReaderLibraries();
+        libraries.load();
+        librariesModified = modified;
+        librariesSize = settings.size();
+    }
+
+    return libraries;
 }
 QList<LibraryItem *> DBHelper::getFolderSubfoldersFromLibrary(qulonglong libraryId, qulonglong folderId)
 {
@@ -60,6 +116,68 @@ QList<LibraryItem *> DBHelper::getFolderComicsFromLibrary(qulonglong libraryId,
     return list;
 }
 
+QList<LibraryItem *> DBHelper::getFolderContentFromLibrary(qulonglong libraryId, qulonglong folderId, int offset, int limit)
+{
+    QString libraryPath = DBHelper::getLibraries().getPath(libraryId);
+    QSqlDatabase db = DataBaseManagement::loadDatabase(libraryPath+"/.yacreaderlibrary");
+
+    QList<LibraryItem *> list = DBHelper::getFolderContent(folderId,offset,limit,db);
+
+    db.close();
+    QSqlDatabase::removeDatabase(db.connectionName());
+    return list;
+}
+
+QList<QPair<QString, int> > DBHelper::getFolderContentInitialsFromLibrary(qulonglong libraryId, qulonglong folderId)
+{
+    QString libraryPath = DBHelper::getLibraries().getPath(libraryId);
+    QSqlDatabase db = DataBaseManagement::loadDatabase(libraryPath+"/.yacreaderlibrary");
+
+    QList<QPair<QString, int> > initials;
+    {
+        //only the (parentId, sortKey) indexes are read
+        QSqlQuery & selectQuery = cachedQuery("SELECT substr(sortKey, 1, 1) AS initial, COUNT(*) FROM ("
+                                              "SELECT sortKey FROM folder WHERE parentId = :folderParentId AND id <> 1 "
+                                              "UNION ALL "
+                                              "SELECT sortKey FROM comic WHERE parentId = :comicParentId) "
+                                              "GROUP BY initial ORDER BY initial", db);
+        selectQuery.bindValue(":folderParentId", folderId);
+        selectQuery.bindValue(":comicParentId", folderId);
+
+        if(selectQuery.exec())
+        {
+            while(selectQuery.next())
+                initials.append(qMakePair(selectQuery.value(0).toString(), selectQuery.value(1).toInt()));
+
+            selectQuery.finish();
+        }
+        else
+        {
+            //libraries that haven't been updated to 9.6 don't have sort keys
+            QList<LibraryItem *> items = DBHelper::getFoldersFromParent(folderId,db,false);
+            items.append(DBHelper::getComicsFromParent(folderId,db,false));
+
+            QStringList initialsList;
+            for(LibraryItem * item : items)
+                initialsList.append(naturalSortKey(item->name).left(1));
+            qDeleteAll(items);
+
+            std::sort(initialsList.begin(), initialsList.end());
+            for(const QString & initial : initialsList)
+            {
+                if(!initials.isEmpty() && initials.last().first == initial)
+                    initials.last().second++;
+                else
+                    initials.append(qMakePair(initial, 1));
+            }
+        }
+    }
+
+    db.close();
+    QSqlDatabase::removeDatabase(db.connectionName());
+    return initials;
+}
+
 quint32 DBHelper::getNumChildrenFromFolder(qulonglong libraryId, qulonglong folderId)
 {
     QString libraryPath = DBHelper::getLibraries().getPath(libraryId);
@@ -114,6 +232,28 @@ ComicDB DBHelper::getComicInfo(qulonglong libraryId, qulonglong id)
 	return comic;
 }
 
+QList<ComicDB> DBHelper::getComicsInfo(qulonglong libraryId, const QList<qulonglong> & ids)
+{
+    QString libraryPath = DBHelper::getLibraries().getPath(libraryId);
+    QSqlDatabase db = DataBaseManagement::loadDatabase(libraryPath+"/.yacreaderlibrary");
+
+    QList<ComicDB> comics;
+
+    //a single read transaction, all the comics are read from the same snapshot of the DB
+    db.transaction();
+    foreach(qulonglong id, ids)
+    {
+        ComicDB comic = DBHelper::loadComic(id,db);
+        if(comic.info.existOnDb)
+            comics.append(comic);
+    }
+    db.commit();
+
+    db.close();
+    QSqlDatabase::removeDatabase(db.connectionName());
+    return comics;
+}
+
 QList<ComicDB> DBHelper::getSiblings(qulonglong libraryId, qulonglong parentId)
 {
     QString libraryPath = DBHelper::getLibraries().getPath(libraryId);
@@ -393,15 +533,13 @@ void DBHelper::removeFromDB(LibraryItem * item, QSqlDatabase & db)
 }
 void DBHelper::removeFromDB(Folder * folder, QSqlDatabase & db)
 {
-	QSqlQuery query(db);
-	query.prepare("DELETE FROM folder WHERE id = :id");
+	QSqlQuery & query = cachedQuery("DELETE FROM folder WHERE id = :id", db);
 	query.bindValue(":id", folder->id);
 	query.exec();
 }
 void DBHelper::removeFromDB(ComicDB * comic, QSqlDatabase & db)
 {
-	QSqlQuery query(db);
-	query.prepare("DELETE FROM comic WHERE id = :id");
+	QSqlQuery & query = cachedQuery("DELETE FROM comic WHERE id = :id", db);
 	query.bindValue(":id", comic->id);
     query.exec();
 }
@@ -502,8 +640,7 @@ void DBHelper::update(ComicInfo * comicInfo, QSqlDatabase & db)
     if(comicInfo == nullptr)
         return;
 
-	QSqlQuery updateComicInfo(db);
-	updateComicInfo.prepare("UPDATE comic_info SET "
+	QSqlQuery & updateComicInfo = cachedQuery("UPDATE comic_info SET "
 		"title = :title,"
 		
 		"coverPage = :coverPage,"
@@ -560,7 +697,7 @@ void DBHelper::update(ComicInfo * comicInfo, QSqlDatabase & db)
         "coverSizeRatio = :coverSizeRatio,"
         "originalCoverSize = :originalCoverSize"
 		//--
-		" WHERE id = :id ");
+		" WHERE id = :id ", db);
 
     updateComicInfo.bindValue(":title",comicInfo->title);
 
@@ -648,11 +785,10 @@ void DBHelper::update(const Folder & folder, QSqlDatabase &db)
 
 void DBHelper::updateChildrenInfo(const Folder & folder, QSqlDatabase & db)
 {
-    QSqlQuery updateFolderInfo(db);
-    updateFolderInfo.prepare("UPDATE folder SET "
-                             "numChildren = :numChildren, "
-                             "firstChildHash = :firstChildHash "
-                             "WHERE id = :id ");
+    QSqlQuery & updateFolderInfo = cachedQuery("UPDATE folder SET "
+                                               "numChildren = :numChildren, "
+                                               "firstChildHash = :firstChildHash "
+                                               "WHERE id = :id ", db);
     updateFolderInfo.bindValue(":numChildren", folder.getNumChildren());
     updateFolderInfo.bindValue(":firstChildHash", folder.getFirstChildHash());
     updateFolderInfo.bindValue(":id", folder.id);
@@ -668,17 +804,53 @@ void DBHelper::updateChildrenInfo(qulonglong folderId, QSqlDatabase & db)
     if(comics.count() > 0)
         firstComic = static_cast<ComicDB *>(comics.first());
 
-    QSqlQuery updateFolderInfo(db);
-    updateFolderInfo.prepare("UPDATE folder SET "
-                             "numChildren = :numChildren, "
-                             "firstChildHash = :firstChildHash "
-                             "WHERE id = :id ");
+    QSqlQuery & updateFolderInfo = cachedQuery("UPDATE folder SET "
+                                               "numChildren = :numChildren, "
+                                               "firstChildHash = :firstChildHash "
+                                               "WHERE id = :id ", db);
     updateFolderInfo.bindValue(":numChildren", subfolders.count() + comics.count());
     updateFolderInfo.bindValue(":firstChildHash", firstComic != NULL ? firstComic->info.hash : "");
     updateFolderInfo.bindValue(":id", folderId);
     updateFolderInfo.exec();
 }
 
+void DBHelper::updateSortKeys(QSqlDatabase & db)
+{
+    db.transaction();
+
+    {
+        QSqlQuery selectQuery(db);
+        selectQuery.setForwardOnly(true);
+        selectQuery.exec("SELECT id, name FROM folder");
+
+        QSqlQuery updateQuery(db);
+        updateQuery.prepare("UPDATE folder SET sortKey = :sortKey WHERE id = :id");
+        while(selectQuery.next())
+        {
+            updateQuery.bindValue(":sortKey", naturalSortKey(selectQuery.value(1).toString()));
+            updateQuery.bindValue(":id", selectQuery.value(0));
+            updateQuery.exec();
+        }
+    }
+
+    {
+        QSqlQuery selectQuery(db);
+        selectQuery.setForwardOnly(true);
+        selectQuery.exec("SELECT id, fileName FROM comic");
+
+        QSqlQuery updateQuery(db);
+        updateQuery.prepare("UPDATE comic SET sortKey = :sortKey WHERE id = :id");
+        while(selectQuery.next())
+        {
+            updateQuery.bindValue(":sortKey", naturalSortKey(selectQuery.value(1).toString()));
+            updateQuery.bindValue(":id", selectQuery.value(0));
+            updateQuery.exec();
+        }
+    }
+
+    db.commit();
+}
+
 void DBHelper::updateChildrenInfo(QSqlDatabase & db)
 {
     QSqlQuery selectQuery(db); //TODO check
@@ -724,14 +896,13 @@ void DBHelper::setComicAsReading(qulonglong libraryId, const ComicInfo &comicInf
 
 void DBHelper::updateReadingRemoteProgress(const ComicInfo &comicInfo, QSqlDatabase &db)
 {
-    QSqlQuery updateComicInfo(db);
-    updateComicInfo.prepare("UPDATE comic_info SET "
-                            "read = :read, "
-                            "currentPage = :currentPage, "
-                            "hasBeenOpened = :hasBeenOpened, "
-                            "lastTimeOpened = :lastTimeOpened, "
-                            "rating = :rating"
-                            " WHERE id = :id ");
+    QSqlQuery & updateComicInfo = cachedQuery("UPDATE comic_info SET "
+                                              "read = :read, "
+                                              "currentPage = :currentPage, "
+                                              "hasBeenOpened = :hasBeenOpened, "
+                                              "lastTimeOpened = :lastTimeOpened, "
+                                              "rating = :rating"
+                                              " WHERE id = :id ", db);
 
     updateComicInfo.bindValue(":read", comicInfo.read?1:0);
     updateComicInfo.bindValue(":currentPage", comicInfo.currentPage);
@@ -740,16 +911,31 @@ void DBHelper::updateReadingRemoteProgress(const ComicInfo &comicInfo, QSqlDatab
     updateComicInfo.bindValue(":id", comicInfo.id);
     updateComicInfo.bindValue(":rating", comicInfo.rating);
     updateComicInfo.exec();
-
-    updateComicInfo.clear();
 }
 
 
 void DBHelper::updateFromRemoteClient(qulonglong libraryId,const ComicInfo & comicInfo)
+{
+    DBHelper::updateFromRemoteClient(libraryId, QList<ComicInfo>() << comicInfo);
+}
+
+void DBHelper::updateFromRemoteClient(qulonglong libraryId, const QList<ComicInfo> & comics)
 {
     QString libraryPath = DBHelper::getLibraries().getPath(libraryId);
     QSqlDatabase db = DataBaseManagement::loadDatabase(libraryPath+"/.yacreaderlibrary");
 
+    //a single transaction, the DB is synced to disk once for the whole batch
+    db.transaction();
+    foreach(const ComicInfo & comicInfo, comics)
+        DBHelper::updateFromRemoteClient(comicInfo, db);
+    db.commit();
+
+    db.close();
+    QSqlDatabase::removeDatabase(db.connectionName());
+}
+
+void DBHelper::updateFromRemoteClient(const ComicInfo & comicInfo, QSqlDatabase & db)
+{
     ComicDB comic = DBHelper::loadComic(comicInfo.id,db);
 
     if(comic.info.hash == comicInfo.hash)
@@ -772,45 +958,59 @@ void DBHelper::updateFromRemoteClient(qulonglong libraryId,const ComicInfo & com
 
         DBHelper::updateReadingRemoteProgress(comic.info,db);
     }
-
-    db.close();
-    QSqlDatabase::removeDatabase(db.connectionName());
 }
 
 void DBHelper::updateFromRemoteClientWithHash(const ComicInfo & comicInfo)
+{
+    DBHelper::updateFromRemoteClientWithHash(QList<ComicInfo>() << comicInfo);
+}
+
+void DBHelper::updateFromRemoteClientWithHash(const QList<ComicInfo> & comics)
 {
      YACReaderLibraries libraries = DBHelper::getLibraries();
 
      QStringList names = libraries.getNames();
 
      foreach (QString name, names) {
-         QString libraryPath = DBHelper::getLibraries().getPath(libraries.getId(name));
+         QString libraryPath = libraries.getPath(name);
 
          QSqlDatabase db = DataBaseManagement::loadDatabase(libraryPath+"/.yacreaderlibrary");
 
-         ComicInfo info = loadComicInfo(comicInfo.hash, db);
+         db.transaction();
+         foreach(const ComicInfo & comicInfo, comics)
+             DBHelper::updateFromRemoteClientWithHash(comicInfo, db);
+         db.commit();
+
+         db.close();
+         QSqlDatabase::removeDatabase(db.connectionName());
+     }
+}
 
-         if(comicInfo.currentPage > 0)
-         {
-             info.currentPage = comicInfo.currentPage;
+bool DBHelper::updateFromRemoteClientWithHash(const ComicInfo & comicInfo, QSqlDatabase & db)
+{
+    //the hash is unique (and indexed) in comic_info, comics that are not in this library are skipped
+    ComicInfo info = loadComicInfo(comicInfo.hash, db);
+    if(!info.existOnDb)
+        return false;
 
-             if(info.currentPage == info.numPages)
-                 info.read = true;
+    if(comicInfo.currentPage > 0)
+    {
+        info.currentPage = comicInfo.currentPage;
 
-             info.hasBeenOpened = true;
+        if(info.currentPage == info.numPages)
+            info.read = true;
 
-             if (info.lastTimeOpened.toULongLong() < comicInfo.lastTimeOpened.toULongLong())
-                 info.lastTimeOpened = comicInfo.lastTimeOpened;
-         }
+        info.hasBeenOpened = true;
 
-         if(comicInfo.rating > 0)
-             info.rating = comicInfo.rating;
+        if (info.lastTimeOpened.toULongLong() < comicInfo.lastTimeOpened.toULongLong())
+            info.lastTimeOpened = comicInfo.lastTimeOpened;
+    }
 
-         DBHelper::update(&info, db);
+    if(comicInfo.rating > 0)
+        info.rating = comicInfo.rating;
 
-         db.close();
-         QSqlDatabase::removeDatabase(db.connectionName());
-     }
+    DBHelper::update(&info, db);
+    return true;
 }
 
 void DBHelper::renameLabel(qulonglong id, const QString &name, QSqlDatabase &db)
@@ -915,12 +1115,12 @@ void DBHelper::reasignOrderToComicsInReadingList(qulonglong readingListId, QList
 //inserts
 qulonglong DBHelper::insert(Folder * folder, QSqlDatabase & db)
 {
-	QSqlQuery query(db);
-	query.prepare("INSERT INTO folder (parentId, name, path) "
-				   "VALUES (:parentId, :name, :path)");
+	QSqlQuery & query = cachedQuery("INSERT INTO folder (parentId, name, path, sortKey) "
+	                                "VALUES (:parentId, :name, :path, :sortKey)", db);
 	query.bindValue(":parentId", folder->parentId);
 	query.bindValue(":name", folder->name);
 	query.bindValue(":path", folder->path);
+	query.bindValue(":sortKey", naturalSortKey(folder->name));
 	query.exec();
 
 	return query.lastInsertId().toULongLong();
@@ -930,9 +1130,8 @@ qulonglong DBHelper::insert(ComicDB * comic, QSqlDatabase & db)
 {
 	if(!comic->info.existOnDb)
 	{
-		QSqlQuery comicInfoInsert(db);
-        comicInfoInsert.prepare("INSERT INTO comic_info (hash,numPages,coverSizeRatio,originalCoverSize) "
-            "VALUES (:hash,:numPages,:coverSizeRatio,:originalCoverSize)");
+		QSqlQuery & comicInfoInsert = cachedQuery("INSERT INTO comic_info (hash,numPages,coverSizeRatio,originalCoverSize) "
+            "VALUES (:hash,:numPages,:coverSizeRatio,:originalCoverSize)", db);
 		comicInfoInsert.bindValue(":hash", comic->info.hash);
         comicInfoInsert.bindValue(":numPages", comic->info.numPages);
         comicInfoInsert.bindValue(":coverSizeRatio", comic->info.coverSizeRatio);
@@ -944,13 +1143,13 @@ qulonglong DBHelper::insert(ComicDB * comic, QSqlDatabase & db)
 	else
 		comic->_hasCover = true;
 	
-	QSqlQuery query(db);
-    query.prepare("INSERT INTO comic (parentId, comicInfoId, fileName, path) "
-                   "VALUES (:parentId,:comicInfoId,:name, :path)");
+	QSqlQuery & query = cachedQuery("INSERT INTO comic (parentId, comicInfoId, fileName, path, sortKey) "
+                                    "VALUES (:parentId,:comicInfoId,:name, :path, :sortKey)", db);
     query.bindValue(":parentId", comic->parentId);
     query.bindValue(":comicInfoId", comic->info.id);
     query.bindValue(":name", comic->name);
     query.bindValue(":path", comic->path);
+    query.bindValue(":sortKey", naturalSortKey(comic->name));
 	query.exec();
 
     return query.lastInsertId().toULongLong();
@@ -1069,8 +1268,7 @@ QList<LibraryItem *> DBHelper::getFoldersFromParent(qulonglong parentId, QSqlDat
 {
 	QList<LibraryItem *> list;
 
-	QSqlQuery selectQuery(db); //TODO check
-    selectQuery.prepare("SELECT * FROM folder WHERE parentId = :parentId and id <> 1");
+	QSqlQuery & selectQuery = cachedQuery("SELECT * FROM folder WHERE parentId = :parentId and id <> 1", db);
     selectQuery.bindValue(":parentId", parentId);
 	selectQuery.exec();
 
@@ -1117,6 +1315,7 @@ QList<LibraryItem *> DBHelper::getFoldersFromParent(qulonglong parentId, QSqlDat
 				list.insert(i,currentItem);
 		}
 	}
+	selectQuery.finish();
 
 	return list;
 }
@@ -1292,8 +1491,7 @@ QList<LibraryItem *> DBHelper::getComicsFromParent(qulonglong parentId, QSqlData
 {
     QList<LibraryItem *> list;
 
-	QSqlQuery selectQuery(db);
-    selectQuery.prepare("select c.id,c.parentId,c.fileName,c.path,ci.hash from comic c inner join comic_info ci on (c.comicInfoId = ci.id) where c.parentId = :parentId");
+	QSqlQuery & selectQuery = cachedQuery("select c.id,c.parentId,c.fileName,c.path,ci.hash from comic c inner join comic_info ci on (c.comicInfoId = ci.id) where c.parentId = :parentId", db);
     selectQuery.bindValue(":parentId", parentId);
 	selectQuery.exec();
 
@@ -1313,15 +1511,56 @@ QList<LibraryItem *> DBHelper::getComicsFromParent(qulonglong parentId, QSqlData
 
         list.append(currentItem);
 	}
+	selectQuery.finish();
 
     if (sort)
+        naturalSortByKey(list);
+
+	return list;
+}
+
+QList<LibraryItem *> DBHelper::getFolderContent(qulonglong folderId, int offset, int limit, QSqlDatabase & db)
+{
+    QList<LibraryItem *> list;
+
+    //each side of the compound select walks its (parentId, sortKey) index and SQLite merges them,
+    //so only the rows up to the requested page are read; the id keeps the order of equal keys stable
+    QSqlQuery & selectQuery = cachedQuery("SELECT id, sortKey, 0 AS isComic FROM folder WHERE parentId = :folderParentId AND id <> 1 "
+                                          "UNION ALL "
+                                          "SELECT id, sortKey, 1 AS isComic FROM comic WHERE parentId = :comicParentId "
+                                          "ORDER BY sortKey, id LIMIT :limit OFFSET :offset", db);
+    selectQuery.bindValue(":folderParentId", folderId);
+    selectQuery.bindValue(":comicParentId", folderId);
+    selectQuery.bindValue(":limit", limit < 0 ? -1 : limit);
+    selectQuery.bindValue(":offset", qMax(0, offset));
+    if(!selectQuery.exec())
     {
-        std::sort(list.begin(), list.end(), [](const LibraryItem * c1, const LibraryItem * c2){
-            return c1->name.localeAwareCompare(c2->name) < 0;
-        });
+        //libraries that haven't been updated to 9.6 don't have sort keys, they are sorted in memory
+        list = DBHelper::getFoldersFromParent(folderId,db,false);
+        list.append(DBHelper::getComicsFromParent(folderId,db,false));
+        naturalSortByKey(list);
+
+        QList<LibraryItem *> page = list.mid(qMax(0, offset), limit);
+        for(int i = 0; i < list.size(); i++)
+            if(i < offset || (limit >= 0 && i >= offset + limit))
+                delete list.at(i);
+        return page;
     }
 
-	return list;
+    QList<QPair<qulonglong, bool> > items;
+    while (selectQuery.next())
+        items.append(qMakePair(selectQuery.value(0).toULongLong(), selectQuery.value(2).toBool()));
+    selectQuery.finish();
+
+    for(const QPair<qulonglong, bool> & item : items)
+    {
+        if(item.second)
+            list.append(new ComicDB(DBHelper::loadComic(item.first, db)));
+        else
+            list.append(new Folder(DBHelper::loadFolder(item.first, db)));
+    }
+
+    return list;
 }
 
 QList<Label> DBHelper::getLabels(qulonglong libraryId)
@@ -1429,8 +1668,7 @@ Folder DBHelper::loadFolder(const QString &folderName, qulonglong parentId, QSql
 {
     Folder folder;
 
-    QSqlQuery query(db);
-    query.prepare("SELECT * FROM folder WHERE parentId = :parentId AND name = :folderName");
+    QSqlQuery & query = cachedQuery("SELECT * FROM folder WHERE parentId = :parentId AND name = :folderName", db);
     query.bindValue(":parentId",parentId);
     query.bindValue(":folderName", folderName);
     query.exec();
@@ -1464,6 +1702,7 @@ Folder DBHelper::loadFolder(const QString &folderName, qulonglong parentId, QSql
         folder.setFirstChildHash(query.value(firstChildHash).toString());
         folder.setCustomImage(query.value(customImage).toString());
     }
+    query.finish();
 
     return folder;
 }
@@ -1472,8 +1711,7 @@ ComicDB DBHelper::loadComic(qulonglong id, QSqlDatabase & db)
 {
 	ComicDB comic;
 
-	QSqlQuery selectQuery(db); 
-    selectQuery.prepare("select c.id,c.parentId,c.fileName,c.path,ci.hash from comic c inner join comic_info ci on (c.comicInfoId = ci.id) where c.id = :id");
+	QSqlQuery & selectQuery = cachedQuery("select c.id,c.parentId,c.fileName,c.path,ci.hash from comic c inner join comic_info ci on (c.comicInfoId = ci.id) where c.id = :id", db);
     selectQuery.bindValue(":id", id);
 	selectQuery.exec();
 
@@ -1490,8 +1728,11 @@ ComicDB DBHelper::loadComic(qulonglong id, QSqlDatabase & db)
         comic.parentId = selectQuery.value(parentId).toULongLong();
         comic.name = selectQuery.value(name).toString();
         comic.path = selectQuery.value(path).toString();
-        comic.info = DBHelper::loadComicInfo(selectQuery.value(hash).toString(),db);
+        QString comicHash = selectQuery.value(hash).toString();
+        selectQuery.finish();
+        comic.info = DBHelper::loadComicInfo(comicHash,db);
 	}
+	selectQuery.finish();
 
 	return comic;
 }
@@ -1522,8 +1763,7 @@ ComicInfo DBHelper::loadComicInfo(QString hash, QSqlDatabase & db)
 {
 	ComicInfo comicInfo;
 
-	QSqlQuery findComicInfo(db);
-    findComicInfo.prepare("SELECT * FROM comic_info WHERE hash = :hash");
+	QSqlQuery & findComicInfo = cachedQuery("SELECT * FROM comic_info WHERE hash = :hash", db);
     findComicInfo.bindValue(":hash", hash);
 	findComicInfo.exec();
 
@@ -1650,6 +1890,8 @@ ComicInfo DBHelper::loadComicInfo(QString hash, QSqlDatabase & db)
 	else
 		comicInfo.existOnDb = false;
 
+    findComicInfo.finish();
+
     return comicInfo;
 }
 
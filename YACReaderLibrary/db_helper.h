@@ -25,9 +25,14 @@ public:
     static	QList<LibraryItem *> getFolderSubfoldersFromLibrary(qulonglong libraryId, qulonglong folderId);
     static	QList<LibraryItem *> getFolderComicsFromLibrary(qulonglong libraryId, qulonglong folderId);
     static	QList<LibraryItem *> getFolderComicsFromLibrary(qulonglong libraryId, qulonglong folderId, bool sort);
+    //subfolders and comics mixed and naturally sorted by name, limit < 0 returns all the items from offset
+    static	QList<LibraryItem *> getFolderContentFromLibrary(qulonglong libraryId, qulonglong folderId, int offset = 0, int limit = -1);
+    //number of subfolders and comics grouped by the first char of their sort key, in sort order
+    static	QList<QPair<QString, int> > getFolderContentInitialsFromLibrary(qulonglong libraryId, qulonglong folderId);
     static  quint32 getNumChildrenFromFolder(qulonglong libraryId, qulonglong folderId);
     static	qulonglong getParentFromComicFolderId(qulonglong libraryId, qulonglong id);
     static	ComicDB getComicInfo(qulonglong libraryId, qulonglong id);
+    static  QList<ComicDB> getComicsInfo(qulonglong libraryId, const QList<qulonglong> & ids);
     static  QList<ComicDB> getSiblings(qulonglong libraryId, qulonglong parentId);
     static	QString getFolderName(qulonglong libraryId, qulonglong id);
 	static  QList<QString> getLibrariesNames();
@@ -67,11 +72,16 @@ public:
     static void updateChildrenInfo(const Folder & folder, QSqlDatabase & db);
     static void updateChildrenInfo(qulonglong folderId, QSqlDatabase & db);
     static void updateChildrenInfo(QSqlDatabase & db);
+    static void updateSortKeys(QSqlDatabase & db);
     static void updateProgress(qulonglong libraryId,const ComicInfo & comicInfo);
     static void setComicAsReading(qulonglong libraryId, const ComicInfo &comicInfo);
     static void updateReadingRemoteProgress(const ComicInfo & comicInfo, QSqlDatabase & db);
     static void updateFromRemoteClient(qulonglong libraryId,const ComicInfo & comicInfo);
+    static void updateFromRemoteClient(qulonglong libraryId, const QList<ComicInfo> & comics);
+    static void updateFromRemoteClient(const ComicInfo & comicInfo, QSqlDatabase & db);
     static void updateFromRemoteClientWithHash(const ComicInfo & comicInfo);
+    static void updateFromRemoteClientWithHash(const QList<ComicInfo> & comics);
+    static bool updateFromRemoteClientWithHash(const ComicInfo & comicInfo, QSqlDatabase & db);
     static void renameLabel(qulonglong id, const QString & name, QSqlDatabase & db);
     static void renameList(qulonglong id, const QString & name, QSqlDatabase & db);
     static void reasignOrderToSublists(QList<qulonglong> ids, QSqlDatabase & db);
@@ -82,6 +92,7 @@ public:
 	static QList<LibraryItem *> getFoldersFromParent(qulonglong parentId, QSqlDatabase & db, bool sort = true);
 	static QList<ComicDB> getSortedComicsFromParent(qulonglong parentId, QSqlDatabase & db);
 	static QList<LibraryItem *> getComicsFromParent(qulonglong parentId, QSqlDatabase & db, bool sort = true);
+    static QList<LibraryItem *> getFolderContent(qulonglong folderId, int offset, int limit, QSqlDatabase & db);
     static QList<Label> getLabels(qulonglong libraryId);
 
     //load
@@ -93,6 +104,10 @@ public:
     static QList<QString> loadSubfoldersNames(qulonglong folderId, QSqlDatabase & db);
     //queries
     static bool isFavoriteComic(qulonglong id, QSqlDatabase & db);
+
+    //prepared statements are cached per connection (and thread), the returned query is prepared and ready to be bound and executed
+    //it must not be used after the connection has been closed
+    static QSqlQuery & cachedQuery(const QString & sql, const QSqlDatabase & db);
 };
 
 #endif
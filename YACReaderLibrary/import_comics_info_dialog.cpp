@@ -3,6 +3,7 @@
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QFileDialog>
+#include <QMessageBox>
 #include <QProgressBar>
 
 #include "data_base_management.h"
@@ -89,14 +90,28 @@ void ImportComicsInfoDialog::import()
 	Importer * importer = new Importer();
 	importer->source = path->text();
 	importer->dest = dest;
+	connect(importer,SIGNAL(progress(int,int)),this,SLOT(updateProgress(int,int)));
+	connect(importer,SIGNAL(failed()),this,SLOT(importFailed()));
 	connect(importer,SIGNAL(finished()),this,SLOT(close()));
 	connect(importer,SIGNAL(finished()),this,SLOT(hide()));
 	importer->start();
 }
 
+void ImportComicsInfoDialog::updateProgress(int done, int total)
+{
+	progressBar->setMaximum(total);
+	progressBar->setValue(done);
+}
+
+void ImportComicsInfoDialog::importFailed()
+{
+	QMessageBox::critical(this,tr("Error"),tr("Unable to import the comics info, see the log for details."));
+}
+
 void ImportComicsInfoDialog::close()
 {
 	path->clear();
+	progressBar->setMaximum(0);
 	progressBar->hide();
 	accept->setDisabled(true);
 	QDialog::close();
@@ -105,7 +120,10 @@ void ImportComicsInfoDialog::close()
 
 void Importer::run()
 {
-	DataBaseManagement::importComicsInfo(source,dest);
+	if(!DataBaseManagement::importComicsInfo(source,dest,[this](int done, int total){
+		emit progress(done, total);
+	}))
+		emit failed();
 }
 
 
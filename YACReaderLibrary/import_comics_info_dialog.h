@@ -11,9 +11,13 @@
 
 class Importer : public QThread
 {
+	Q_OBJECT
 public:
 	QString source;
 	QString dest;
+signals:
+	void progress(int done, int total);
+	void failed();
 private:
 	void run();
 };
@@ -46,6 +50,8 @@ private:
 public slots:
 		void findPath();
 		void import();
+		void updateProgress(int done, int total);
+		void importFailed();
 		void close();
 };
 
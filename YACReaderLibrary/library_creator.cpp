@@ -22,9 +22,13 @@
 #include <algorithm>
 using namespace std;
 
+//max number of changes (or ms) before committing the current batch
+static const int COMMIT_BATCH_SIZE = 500;
+static const int COMMIT_BATCH_INTERVAL = 2000;
+
 //--------------------------------------------------------------------------------
 LibraryCreator::LibraryCreator()
-    :creation(false), partialUpdate(false)
+    :_pendingChanges(0), creation(false), partialUpdate(false)
 {
     _nameFilter << Comic::comicExtensions;
 }
@@ -148,6 +152,8 @@ void LibraryCreator::run()
 
 		/*QSqlQuery pragma("PRAGMA foreign_keys = ON",_database);*/
 		_database.transaction();
+		_pendingChanges = 0;
+		_lastCommit.start();
 		//se crea la librería
 		create(QDir(_source));
 
@@ -180,7 +186,11 @@ void LibraryCreator::run()
 			return;
 		}
 		QSqlQuery pragma("PRAGMA foreign_keys = ON",_database);
+		//the new folders and comics are inserted with their sort keys
+		DataBaseManagement::addSortKeys(_database);
 		_database.transaction();
+		_pendingChanges = 0;
+		_lastCommit.start();
 		
 		if(partialUpdate)
 		{
@@ -224,6 +234,18 @@ void LibraryCreator::run()
 	creation = false;
 }
 
+void LibraryCreator::batchCommit()
+{
+	_pendingChanges++;
+	if(_pendingChanges >= COMMIT_BATCH_SIZE || _lastCommit.elapsed() >= COMMIT_BATCH_INTERVAL)
+	{
+		_database.commit();
+		_database.transaction();
+		_pendingChanges = 0;
+		_lastCommit.restart();
+	}
+}
+
 void LibraryCreator::stop()
 {
 	_database.commit();
@@ -336,6 +358,7 @@ void LibraryCreator::insertComic(const QString & relativePath,const QFileInfo &
 
 		comic.parentId = _currentPathFolders.last().id;
 		DBHelper::insert(&comic,_database);
+		batchCommit();
 	}
 }
 
@@ -398,6 +421,7 @@ void LibraryCreator::update(QDir dirS)
 				if(stopRunning)
 					return;
 				DBHelper::removeFromDB(listD.at(j),(_database));
+				batchCommit();
 			}
 			updated = true;
 		}
@@ -496,6 +520,7 @@ void LibraryCreator::update(QDir dirS)
 						{
 							//QLOG_WARN() << "dir source > dest" << nameS << nameD;
 							DBHelper::removeFromDB(fileInfoD,_database);
+							batchCommit();
 							j++;
 						}
 						else
@@ -529,6 +554,7 @@ void LibraryCreator::update(QDir dirS)
 					if(fileInfoD->isDir()) //delete this folder from library
 					{
 						DBHelper::removeFromDB(fileInfoD,_database);
+						batchCommit();
 						j++;
 					}
 					else //both are files  //BUG on windows (no case sensitive)
@@ -557,6 +583,7 @@ void LibraryCreator::update(QDir dirS)
 							if(comparation > 0) //delete thumbnail
 							{
 								DBHelper::removeFromDB(fileInfoD,_database);
+								batchCommit();
 								j++;
 							}
 							else //same file
@@ -12,6 +12,7 @@
 #include <QtGui>
 #include <QMutex>
 #include <QThread>
+#include <QElapsedTimer>
 #include <QSqlDatabase>
 #include <QModelIndex>
 
@@ -47,6 +48,10 @@
 		qulonglong insertFolders();//devuelve el id del último folder añadido (último en la ruta)
 		bool checkCover(const QString & hash);
 		void insertComic(const QString & relativePath,const QFileInfo & fileInfo);
+		//the work is committed in batches, this way readers (GUI, server) can see the progress of long updates
+		void batchCommit();
+		int _pendingChanges;
+		QElapsedTimer _lastCommit;
 		//qulonglong insertFolder(qulonglong parentId,const Folder & folder);
 		//qulonglong insertComic(const Comic & comic);
 		bool stopRunning;
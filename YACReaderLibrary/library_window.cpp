@@ -1187,6 +1187,8 @@ void LibraryWindow::loadLibrary(const QString & name)
 
             if(comparation == 0) //en caso de que la versión se igual que la actual
 			{
+                DataBaseManagement::addSortKeys(path);
+
                 foldersModel->setupModelData(path);
                 foldersModelProxy->setSourceModel(foldersModel);
                 foldersView->setModel(foldersModelProxy);
@@ -1770,6 +1772,10 @@ void LibraryWindow::checkMaxNumLibraries()
 
 void LibraryWindow::selectSubfolder(const QModelIndex &mi, int child)
 {
+    //the children of the folder are loaded lazily
+    if(foldersModel->canFetchMore(mi))
+        foldersModel->fetchMore(mi);
+
     QModelIndex dest = foldersModel->index(child,0,mi);
     foldersView->setCurrentIndex(dest);
     navigationController->selectedFolder(dest);
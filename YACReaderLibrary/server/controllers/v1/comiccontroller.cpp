@@ -19,15 +19,13 @@ ComicController::ComicController() {}
 void ComicController::service(HttpRequest& request, HttpResponse& response)
 {
     HttpSession session=Static::sessionStore->getSession(request,response,false);
-    YACReaderHttpSession *ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
+    QSharedPointer<YACReaderHttpSession> ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    qulonglong libraryId = pathElements.at(2).toLongLong();
+    qulonglong libraryId = request.getPathParameter("libraryId").toLongLong();
     QString libraryName = DBHelper::getLibraryName(libraryId);
-    qulonglong comicId = pathElements.at(4).toULongLong();
+    qulonglong comicId = request.getPathParameter("comicId").toULongLong();
 
-    bool remoteComic = path.endsWith("remote");
+    bool remoteComic = request.getPathParameter("remote").toBool();
 
     //TODO
     //if(pathElements.size() == 6)
@@ -52,33 +50,18 @@ void ComicController::service(HttpRequest& request, HttpResponse& response)
 
     if(comicFile != NULL)
     {
-        QThread * thread = NULL;
-
-        thread = new QThread();
-
-        comicFile->moveToThread(thread);
-
-        connect(comicFile, SIGNAL(errorOpening()), thread, SLOT(quit()));
-        connect(comicFile, SIGNAL(errorOpening(QString)), thread, SLOT(quit()));
-        connect(comicFile, SIGNAL(imagesLoaded()), thread, SLOT(quit()));
-        connect(thread, SIGNAL(started()), comicFile, SLOT(process()));
-        connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
-
-        comicFile->load(libraries.getPath(libraryId)+comic.path);
-
-        if(thread != NULL)
-            thread->start();
+        QSharedPointer<Comic> loadingComic = YACReaderHttpSession::loadComic(comicFile, libraries.getPath(libraryId)+comic.path);
 
         if(remoteComic)
         {
             QLOG_TRACE() << "remote comic requested";
-            ySession->setCurrentRemoteComic(comic.id, comicFile);
+            ySession->setCurrentRemoteComic(comic.id, loadingComic);
 
         }
         else
         {
             QLOG_TRACE() << "comic requested";
-            ySession->setCurrentComic(comic.id, comicFile);
+            ySession->setCurrentComic(comic.id, loadingComic);
         }
 
         response.setHeader("Content-Type", "text/plain; charset=utf-8");
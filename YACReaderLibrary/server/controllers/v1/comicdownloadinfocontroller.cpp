@@ -12,11 +12,9 @@ void ComicDownloadInfoController::service(HttpRequest& request, HttpResponse& re
 {
     response.setHeader("Content-Type", "text/plain; charset=utf-8");
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
 
-    qulonglong libraryId = pathElements.at(2).toLongLong();
-    qulonglong comicId = pathElements.at(4).toULongLong();
+    qulonglong libraryId = request.getPathParameter("libraryId").toLongLong();
+    qulonglong comicId = request.getPathParameter("comicId").toULongLong();
 
     ComicDB comic = DBHelper::getComicInfo(libraryId, comicId);
 
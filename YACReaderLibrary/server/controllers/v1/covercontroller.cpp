@@ -11,7 +11,7 @@ CoverController::CoverController() {}
 void CoverController::service(HttpRequest& request, HttpResponse& response)
 {
     HttpSession session=Static::sessionStore->getSession(request,response,false);
-    YACReaderHttpSession *ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
+    QSharedPointer<YACReaderHttpSession> ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
 
     response.setHeader("Content-Type", "image/jpeg");
     response.setHeader("Connection","close");
@@ -19,13 +19,16 @@ void CoverController::service(HttpRequest& request, HttpResponse& response)
 
     YACReaderLibraries libraries = DBHelper::getLibraries();
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    QString libraryName = DBHelper::getLibraryName(pathElements.at(2).toInt());
-    QString fileName = pathElements.at(4);
+    QString libraryName = DBHelper::getLibraryName(request.getPathParameter("libraryId").toInt());
+    QString fileName = request.getPathParameter("fileName").toString();
 
     bool folderCover = request.getParameter("folderCover").length()>0;
 
+    //same default as the static files when the session is gone
+    QString display = "@2x";
+    if (!ySession.isNull())
+        display = ySession->getDisplayType();
+
     //response.writeText(path+"<br/>");
     //response.writeText(libraryName+"<br/>");
     //response.writeText(libraries.value(libraryName)+"/.yacreaderlibrary/covers/"+fileName+"<br/>");
@@ -44,40 +47,9 @@ void CoverController::service(HttpRequest& request, HttpResponse& response)
     //	file.close();
     //}
 
-    QImage img(libraries.getPath(libraryName)+"/.yacreaderlibrary/covers/"+fileName);
-    if (!img.isNull()) {
-
-        int width = 80, height = 120;
-        if(ySession->getDisplayType()=="@2x")
-        {
-            width = 160;
-            height = 240;
-        }
-
-        if(float(img.width())/img.height() < 0.66666)
-            img = img.scaledToWidth(width,Qt::SmoothTransformation);
-        else
-            img = img.scaledToHeight(height,Qt::SmoothTransformation);
-
-        QImage destImg(width,height,QImage::Format_RGB32);
-        destImg.fill(Qt::black);
-        QPainter p(&destImg);
-
-        p.drawImage((width-img.width())/2,(height-img.height())/2,img);
-
-        if(folderCover)
-        {
-             if(ySession->getDisplayType()=="@2x")
-                p.drawImage(0,0,QImage(":/images/f_overlayed_retina.png"));
-             else
-                p.drawImage(0,0,QImage(":/images/f_overlayed.png"));
-        }
-
-        QByteArray ba;
-        QBuffer buffer(&ba);
-        buffer.open(QIODevice::WriteOnly);
-        destImg.save(&buffer, "JPG");
-        response.write(ba,true);
+    QByteArray cover = Static::coverCache->getCover(libraries.getPath(libraryName), fileName, display=="@2x", folderCover);
+    if (!cover.isEmpty()) {
+        response.write(cover,true);
     }
     //DONE else, hay que devolver un 404
     else
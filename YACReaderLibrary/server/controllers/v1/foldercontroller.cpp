@@ -4,6 +4,7 @@
 #include "yacreader_http_session.h"
 
 #include "db_helper.h"  //get libraries
+#include "yacreader_libraries.h"
 #include "comic_db.h"
 
 #include "folder.h"
@@ -11,19 +12,10 @@
 #include "template.h"
 #include "../static.h"
 
-#include "qnaturalsorting.h"
 #include "yacreader_global.h"
 
 #include "QsLog.h"
 
-struct LibraryItemSorter
-{
-	bool operator()(const LibraryItem * a,const LibraryItem * b) const
-	{
-		return naturalSortLessThanCI(a->name,b->name);
-	} 
-};
-
 FolderController::FolderController() {}
 
 void FolderController::service(HttpRequest& request, HttpResponse& response)
@@ -34,7 +26,7 @@ void FolderController::service(HttpRequest& request, HttpResponse& response)
     bool showlessInfoPerFolder = settings->value(REMOTE_BROWSE_PERFORMANCE_WORKAROUND,false).toBool();
 
 	HttpSession session=Static::sessionStore->getSession(request,response,false);
-    YACReaderHttpSession *ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
+    QSharedPointer<YACReaderHttpSession> ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
 
     response.setHeader("Content-Type", "text/html; charset=utf-8");
 	response.setHeader("Connection","close");
@@ -44,11 +36,9 @@ void FolderController::service(HttpRequest& request, HttpResponse& response)
 
     Template t=Static::templateLoader->getTemplate("folder_"+ySession->getDeviceType(),request.getHeader("Accept-Language"));
 	t.enableWarnings();
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-	QStringList pathElements = path.split('/');
-	int libraryId = pathElements.at(2).toInt();
+	int libraryId = request.getPathParameter("libraryId").toInt();
 	QString libraryName = DBHelper::getLibraryName(libraryId);
-    qulonglong folderId = pathElements.at(4).toULongLong();
+    qulonglong folderId = request.getPathParameter("folderId").toULongLong();
 
     folderId = qMax<qulonglong>(1,folderId);
 
@@ -63,16 +53,11 @@ void FolderController::service(HttpRequest& request, HttpResponse& response)
         t.setVariable("folder.name",folderName);
 	else
 		t.setVariable("folder.name",libraryName);
-    QList<LibraryItem *> folderContent = DBHelper::getFolderSubfoldersFromLibrary(libraryId,folderId);
-    QList<LibraryItem *> folderComics = DBHelper::getFolderComicsFromLibrary(libraryId,folderId);
+    //the items are counted by initial (used for the alpha index), only the current page is loaded
+    QList<QPair<QString, int> > initials = DBHelper::getFolderContentInitialsFromLibrary(libraryId,folderId);
 
 	//response.writeText(libraryName);
 
-	folderContent.append(folderComics);
-
-	qSort(folderContent.begin(),folderContent.end(),LibraryItemSorter());
-	folderComics.clear();
-
     //qulonglong backId = DBHelper::getParentFromComicFolderId(libraryName,folderId);
 
 	int page = 0;
@@ -137,9 +122,9 @@ void FolderController::service(HttpRequest& request, HttpResponse& response)
 
     int elementsPerPage = 24;
 
-	int numFolders = folderContent.length();
-	//int numComics = folderComics.length();
-	int totalLength = folderContent.length() + folderComics.length();
+	int totalLength = 0;
+	for(QList<QPair<QString, int> >::const_iterator itr=initials.constBegin();itr!=initials.constEnd();itr++)
+		totalLength += itr->second;
 
 //	int numFolderPages = numFolders / elementsPerPage + ((numFolders%elementsPerPage)>0?1:0);
 	int numPages = totalLength / elementsPerPage + ((totalLength%elementsPerPage)>0?1:0);
@@ -151,8 +136,22 @@ void FolderController::service(HttpRequest& request, HttpResponse& response)
 	else if(page >= numPages)
 		page = numPages-1;
 
-	int indexCurrentPage = page*elementsPerPage;
-	int numFoldersAtCurrentPage = qMax(0,qMin(numFolders - indexCurrentPage, elementsPerPage));
+	QList<LibraryItem *> folderContent;
+	if(page >= 0)
+		folderContent = DBHelper::getFolderContentFromLibrary(libraryId,folderId,page*elementsPerPage,elementsPerPage);
+	int numFoldersAtCurrentPage = folderContent.length();
+
+    //the sized covers of the page are rendered while the client reads it
+    QStringList comicCovers, folderCovers;
+    foreach(LibraryItem * item, folderContent)
+    {
+        if(!item->isDir())
+            comicCovers.append(static_cast<ComicDB *>(item)->info.hash + ".jpg");
+        else if(!showlessInfoPerFolder && !static_cast<Folder *>(item)->getFirstChildHash().isEmpty())
+            folderCovers.append(static_cast<Folder *>(item)->getFirstChildHash() + ".jpg");
+    }
+    if(!comicCovers.isEmpty() || !folderCovers.isEmpty())
+        Static::coverPrefetcher->prefetchSized(DBHelper::getLibraries().getPath(libraryId), comicCovers, folderCovers, ySession->getDisplayType()=="@2x");
 
     //PATH
     QStack<QPair<qulonglong,quint32> > foldersPath = ySession->getNavigationPath();
@@ -170,8 +169,8 @@ void FolderController::service(HttpRequest& request, HttpResponse& response)
         int i = 0;
         while(i<numFoldersAtCurrentPage)
         {
-            LibraryItem * item = folderContent.at(i + (page*elementsPerPage));
-            t.setVariable(QString("element%1.name").arg(i),folderContent.at(i + (page*elementsPerPage))->name);
+            LibraryItem * item = folderContent.at(i);
+            t.setVariable(QString("element%1.name").arg(i),item->name);
             if(item->isDir())
             {
                 t.setVariable(QString("element%1.class").arg(i),"folder");
@@ -182,12 +181,17 @@ void FolderController::service(HttpRequest& request, HttpResponse& response)
                 }
                 else
                 {
-                    QList<LibraryItem *> children = DBHelper::getFolderComicsFromLibrary(libraryId, item->id);
-                    if(children.length()>0)
+                    QString firstChildHash = static_cast<Folder *>(item)->getFirstChildHash();
+                    if(firstChildHash.isEmpty())
                     {
-                        const ComicDB * comic = static_cast<ComicDB*>(children.at(0));
-                        t.setVariable(QString("element%1.image.url").arg(i),QString("/library/%1/cover/%2.jpg?folderCover=true").arg(libraryId).arg(comic->info.hash));
+                        QList<LibraryItem *> children = DBHelper::getFolderComicsFromLibrary(libraryId, item->id);
+                        if(children.length()>0)
+                            firstChildHash = static_cast<ComicDB*>(children.at(0))->info.hash;
+                        qDeleteAll(children);
                     }
+
+                    if(!firstChildHash.isEmpty())
+                        t.setVariable(QString("element%1.image.url").arg(i),QString("/library/%1/cover/%2.jpg?folderCover=true").arg(libraryId).arg(firstChildHash));
                     else
                         t.setVariable(QString("element%1.image.url").arg(i),"/images/f.png");
                 }
@@ -198,7 +202,7 @@ void FolderController::service(HttpRequest& request, HttpResponse& response)
                 //t.setVariable(QString("element%1.url").arg(i),"/library/"+libraryName+"/folder/"+QString("%1").arg(folderContent.at(i + (page*10))->id));
                 //t.setVariable(QString("element%1.downloadurl").arg(i),"/library/"+libraryName+"/folder/"+QString("%1/info").arg(folderContent.at(i + (page*elementsPerPage))->id));
 
-                t.setVariable(QString("element%1.download").arg(i),QString("<a onclick=\"this.innerHTML='IMPORTING';this.className='importedButton';\" class =\"importButton\" href=\"%1\">IMPORT</a>").arg("/library/"+QString::number(libraryId)+"/folder/"+QString("%1/info").arg(folderContent.at(i + (page*elementsPerPage))->id)));
+                t.setVariable(QString("element%1.download").arg(i),QString("<a onclick=\"this.innerHTML='IMPORTING';this.className='importedButton';\" class =\"importButton\" href=\"%1\">IMPORT</a>").arg("/library/"+QString::number(libraryId)+"/folder/"+QString("%1/info").arg(item->id)));
                 t.setVariable(QString("element%1.read").arg(i),"");
 
                 t.setVariable(QString("element%1.size").arg(i),"");
@@ -251,44 +255,35 @@ void FolderController::service(HttpRequest& request, HttpResponse& response)
 	{
 		t.setCondition("pageIndex",true);
 
-		QMap<QString,int> indexCount;
+		//the initials come in sort order (accents and case are already folded in the sort keys)
+		QList<QPair<QString, int> > index;
 
 		QString firstChar;
-		int xyz = 1;
-		for(QList<LibraryItem *>::const_iterator itr=folderContent.constBegin();itr!=folderContent.constEnd();itr++)
+		for(QList<QPair<QString, int> >::const_iterator itr=initials.constBegin();itr!=initials.constEnd();itr++)
 		{
-			firstChar = QString((*itr)->name[0]).toUpper();
-			firstChar = firstChar.normalized(QString::NormalizationForm_D).at(0);//TODO _D or _KD??
-			bool ok;
-			/*int dec = */firstChar.toInt(&ok, 10);
-			if(ok)
+			firstChar = itr->first.toUpper();
+			if(firstChar.isEmpty() || firstChar.at(0).isDigit())
 				firstChar = "#";
-			//response.writeText(QString("%1 - %2 <br />").arg((*itr)->name).arg(xyz));
-			if(indexCount.contains(firstChar))
-				indexCount.insert(firstChar, indexCount.value(firstChar)+1);
+			if(!index.isEmpty() && index.last().first == firstChar)
+				index.last().second += itr->second;
 			else
-				indexCount.insert(firstChar, 1);
-
-			xyz++;
+				index.append(qMakePair(firstChar, itr->second));
 		}
 
-		QList<QString> index = indexCount.keys();
 		if(index.length()>1)
 		{
 			t.setCondition("alphaIndex",true);
 
-			qSort(index.begin(),index.end(),naturalSortLessThanCI);
 			t.loop("index",index.length());
 			int i=0;
 			int count=0;
 			int indexPage=0;
-			for(QList<QString>::const_iterator itr=index.constBegin();itr!=index.constEnd();itr++)
+			for(QList<QPair<QString, int> >::const_iterator itr=index.constBegin();itr!=index.constEnd();itr++)
 			{
-				//response.writeText(QString("%1 - %2 <br />").arg(*itr).arg(count));
-				t.setVariable(QString("index%1.indexname").arg(i), *itr);
+				t.setVariable(QString("index%1.indexname").arg(i), itr->first);
                 t.setVariable(QString("index%1.url").arg(i),QString("/library/%1/folder/%2?page=%3").arg(libraryId).arg(folderId).arg(indexPage));
 				i++;
-				count += indexCount.value(*itr);
+				count += itr->second;
 				indexPage = count/elementsPerPage;
 			}
 		}
@@ -334,4 +329,5 @@ void FolderController::service(HttpRequest& request, HttpResponse& response)
 
     response.write(t.toUtf8(), true);
 
+    qDeleteAll(folderContent);
 }
@@ -18,22 +18,29 @@ PageController::PageController() {}
 void PageController::service(HttpRequest& request, HttpResponse& response)
 {
     HttpSession session=Static::sessionStore->getSession(request,response,false);
-    YACReaderHttpSession *ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
+    QSharedPointer<YACReaderHttpSession> ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    bool remote = path.endsWith("remote");
+    bool remote = request.getPathParameter("remote").toBool();
 
     //QByteArray path2=request.getPath();
     //qDebug("PageController: request to -> %s ",path2.data());
 
-    QStringList pathElements = path.split('/');
-    QString libraryName = DBHelper::getLibraryName(pathElements.at(2).toInt());
-    qulonglong comicId = pathElements.at(4).toULongLong();
-    unsigned int page = pathElements.at(6).toUInt();
+    QString libraryName = DBHelper::getLibraryName(request.getPathParameter("libraryId").toInt());
+    qulonglong comicId = request.getPathParameter("comicId").toULongLong();
+    unsigned int page = request.getPathParameter("page").toUInt();
 
     //qDebug("lib name : %s",pathElements.at(2).data());
 
-    Comic * comicFile;
+    //the session could have expired
+    if(ySession.isNull())
+    {
+        response.setStatus(404,"not found");
+        response.write("404 not found",true);
+        return;
+    }
+
+    //the reference keeps the comic alive while the page is written, even if the session dismisses it
+    QSharedPointer<Comic> comicFile;
     qulonglong currentComicId;
     if(remote)
     {
@@ -48,7 +55,7 @@ void PageController::service(HttpRequest& request, HttpResponse& response)
         currentComicId = ySession->getCurrentComicId();
     }
 
-    if(currentComicId != 0 && !QPointer<Comic>(comicFile).isNull())
+    if(currentComicId != 0 && !comicFile.isNull())
     {
         if(comicId == currentComicId && page < comicFile->numPages())
         {
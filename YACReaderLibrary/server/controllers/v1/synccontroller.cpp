@@ -5,6 +5,7 @@
 
 #include "comic_db.h"
 #include "db_helper.h"
+#include "../static.h"
 
 SyncController::SyncController()
 {
@@ -20,6 +21,9 @@ void SyncController::service(HttpRequest &request, HttpResponse &response)
     if(postData.length()>0) {
         QList<QString> data = postData.split("\n");
 
+        //the updates are applied per library, each library is updated in a single transaction
+        QMap<qulonglong, QList<ComicInfo> > updates;
+
         qulonglong libraryId;
         qulonglong comicId;
         int currentPage;
@@ -48,9 +52,15 @@ void SyncController::service(HttpRequest &request, HttpResponse &response)
                     info.rating = currentRating;
                 }
 
-                DBHelper::updateFromRemoteClient(libraryId,info);
+                updates[libraryId].append(info);
             }
         }
+
+        for(QMap<qulonglong, QList<ComicInfo> >::const_iterator itr = updates.constBegin(); itr != updates.constEnd(); itr++)
+        {
+            DBHelper::updateFromRemoteClient(itr.key(), itr.value());
+            Static::httpCache->libraryUpdated(itr.key());
+        }
     }
     else
     {
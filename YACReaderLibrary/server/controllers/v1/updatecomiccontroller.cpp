@@ -17,11 +17,9 @@ void UpdateComicController::service(HttpRequest &request, HttpResponse &response
 {
     HttpSession session=Static::sessionStore->getSession(request,response,false);
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    qulonglong libraryId = pathElements.at(2).toULongLong();
+    qulonglong libraryId = request.getPathParameter("libraryId").toULongLong();
     QString libraryName = DBHelper::getLibraryName(libraryId);
-    qulonglong comicId = pathElements.at(4).toULongLong();
+    qulonglong comicId = request.getPathParameter("comicId").toULongLong();
 
     QString postData = QString::fromUtf8(request.getBody());
 
@@ -34,6 +32,7 @@ void UpdateComicController::service(HttpRequest &request, HttpResponse &response
         info.currentPage = currentPage;
         info.id = comicId;
         DBHelper::updateProgress(libraryId,info);
+        Static::httpCache->libraryUpdated(libraryId);
     }
     else
     {
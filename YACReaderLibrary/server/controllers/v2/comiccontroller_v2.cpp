@@ -19,21 +19,24 @@ ComicControllerV2::ComicControllerV2() {}
 void ComicControllerV2::service(HttpRequest& request, HttpResponse& response)
 {
     QByteArray token = request.getHeader("x-request-id");
-    YACReaderHttpSession *ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(token);
+    QSharedPointer<YACReaderHttpSession> ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(token);
     
-    if (ySession == nullptr) {
+    if (ySession.isNull()) {
         response.setStatus(404,"not found");
         response.write("404 not found",true);
         return;
     }
     
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-	QStringList pathElements = path.split('/');
-    qulonglong libraryId = pathElements.at(3).toLongLong();
+    qulonglong libraryId = request.getPathParameter("libraryId").toLongLong();
     QString libraryName = DBHelper::getLibraryName(libraryId);
-    qulonglong comicId = pathElements.at(5).toULongLong();
+    qulonglong comicId = request.getPathParameter("comicId").toULongLong();
 
-    bool remoteComic = path.endsWith("remote");
+    bool remoteComic = request.getPathParameter("remote").toBool();
+
+    //size and format of the pages for this device, see PageControllerV2
+    YACReaderPageVariants::Profile profile = YACReaderPageVariants::profileFromRequest(request);
+    if(!profile.isNull())
+        ySession->setPageProfile(profile);
 
 	//TODO
 	//if(pathElements.size() == 6)
@@ -51,38 +54,38 @@ void ComicControllerV2::service(HttpRequest& request, HttpResponse& response)
 	
     ComicDB comic = DBHelper::getComicInfo(libraryId, comicId);
 
-    Comic * comicFile = FactoryComic::newComic(libraries.getPath(libraryId)+comic.path);
+    //comic files that can be read page by page are not loaded, PageControllerV2 extracts each page on demand
+    QString comicPath = libraries.getPath(libraryId)+comic.path;
+    bool randomAccess = YACReaderComicPages::isRandomAccess(comicPath);
+    Comic * comicFile = randomAccess ? NULL : FactoryComic::newComic(comicPath);
 
-	if(comicFile != NULL)
+	if(randomAccess)
 	{
-		QThread * thread = NULL;
-
-		thread = new QThread();
-
-		comicFile->moveToThread(thread);
-
-        connect(comicFile, SIGNAL(errorOpening()), thread, SLOT(quit()));
-        connect(comicFile, SIGNAL(errorOpening(QString)), thread, SLOT(quit()));
-        connect(comicFile, SIGNAL(imagesLoaded()), thread, SLOT(quit()));
-		connect(thread, SIGNAL(started()), comicFile, SLOT(process()));
-		connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
-
-        comicFile->load(libraries.getPath(libraryId)+comic.path);
+		//the session holds the comic in the shared cache, other devices reading it use the same pages
+		if(remoteComic)
+			ySession->setCurrentRemoteComic(comic.id, Static::comicPages->handle(libraryId, comic.id));
+		else
+			ySession->setCurrentComic(comic.id, Static::comicPages->handle(libraryId, comic.id));
+	}
 
-		if(thread != NULL)
-			thread->start();
+	if(randomAccess || comicFile != NULL)
+	{
+		if(comicFile != NULL)
+		{
+        QSharedPointer<Comic> loadingComic = YACReaderHttpSession::loadComic(comicFile, comicPath);
 
         if(remoteComic)
         {
             QLOG_TRACE() << "remote comic requested";
-            ySession->setCurrentRemoteComic(comic.id, comicFile);
+            ySession->setCurrentRemoteComic(comic.id, loadingComic);
 
         }
         else
         {
             QLOG_TRACE() << "comic requested";
-            ySession->setCurrentComic(comic.id, comicFile);
+            ySession->setCurrentComic(comic.id, loadingComic);
         }
+		}
 
         response.setHeader("Content-Type", "text/plain; charset=utf-8");
 		//TODO this field is not used by the client!
@@ -0,0 +1,179 @@
+#include "comicfilecontroller_v2.h"
+
+#include "db_helper.h"
+#include "yacreader_libraries.h"
+#include "yacreader_http_cache.h"
+
+#include "comic_db.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QUrl>
+
+#include "QsLog.h"
+
+QAtomicInt ComicFileControllerV2::downloads;
+int ComicFileControllerV2::maxDownloads = 4;
+
+ComicFileControllerV2::ComicFileControllerV2() {}
+
+void ComicFileControllerV2::setMaxDownloads(int max)
+{
+    maxDownloads = max;
+}
+
+void ComicFileControllerV2::service(HttpRequest& request, HttpResponse& response)
+{
+    qulonglong libraryId = request.getPathParameter("libraryId").toULongLong();
+    qulonglong comicId = request.getPathParameter("comicId").toULongLong();
+
+    QString libraryPath = DBHelper::getLibraries().getPath(libraryId);
+    ComicDB comic = DBHelper::getComicInfo(libraryId, comicId);
+
+    QFile file(libraryPath+comic.path);
+    if(libraryPath.isEmpty() || comic.path.isEmpty() || !file.open(QIODevice::ReadOnly))
+    {
+        response.setStatus(404,"not found");
+        response.write("404 not found",true);
+        return;
+    }
+
+    QFileInfo info(file);
+    qint64 size = info.size();
+
+    //the hash identifies the comic, the size and time of the file detect changes not updated in the library yet
+    QByteArray etag = "\"" + comic.info.hash.toLatin1() + "-" + QByteArray::number(info.lastModified().toMSecsSinceEpoch(),36) + "\"";
+
+    response.setHeader("ETag", etag);
+    response.setHeader("Accept-Ranges", "bytes");
+
+    if(YACReaderHttpCache::matchesETag(request.getHeader("If-None-Match"), etag))
+    {
+        response.setStatus(304,"Not Modified");
+        response.write(QByteArray(),true);
+        return;
+    }
+
+    //the slot is released when the request ends, the client is expected to try again later
+    if(downloads.fetchAndAddOrdered(1) >= maxDownloads && maxDownloads > 0)
+    {
+        downloads.deref();
+        response.setStatus(503,"Service Unavailable");
+        response.setHeader("Retry-After", "10");
+        response.write("503 too many downloads",true);
+        return;
+    }
+
+    struct DownloadSlot {
+        ~DownloadSlot() { downloads.deref(); }
+    } slot;
+
+    QString suffix = info.suffix().toLower();
+    if(suffix == "cbz" || suffix == "zip")
+        response.setHeader("Content-Type", "application/vnd.comicbook+zip");
+    else if(suffix == "cbr" || suffix == "rar")
+        response.setHeader("Content-Type", "application/vnd.comicbook-rar");
+    else if(suffix == "pdf")
+        response.setHeader("Content-Type", "application/pdf");
+    else
+        response.setHeader("Content-Type", "application/octet-stream");
+
+    response.setHeader("Content-Disposition", "attachment; filename*=UTF-8''" + QUrl::toPercentEncoding(info.fileName()));
+
+    qint64 first = 0;
+    qint64 last = size - 1;
+
+    //a range is only honored if the client still has the same version of the file
+    QByteArray range = request.getHeader("Range");
+    QByteArray ifRange = request.getHeader("If-Range");
+    if(!range.isEmpty() && (ifRange.isEmpty() || ifRange == etag))
+    {
+        //invalid ranges are ignored (RFC 7233, 3.1)
+        RangeResult result = parseRange(range, size, first, last);
+        if(result == Satisfiable)
+        {
+            response.setStatus(206,"Partial Content");
+            response.setHeader("Content-Range", "bytes " + QByteArray::number(first) + "-" + QByteArray::number(last) + "/" + QByteArray::number(size));
+        }
+        else if(result == Unsatisfiable)
+        {
+            response.setStatus(416,"Range Not Satisfiable");
+            response.setHeader("Content-Range", "bytes */" + QByteArray::number(size));
+            response.write(QByteArray(),true);
+            return;
+        }
+    }
+
+    qint64 remaining = last - first + 1;
+    response.setHeader("Content-Length", QByteArray::number(remaining));
+
+    if(remaining <= 0 || !file.seek(first))
+    {
+        response.write(QByteArray(),true);
+        return;
+    }
+
+    //HttpResponse blocks while the client is not reading, only a few blocks are in memory
+    while(remaining > 0 && response.isConnected())
+    {
+        QByteArray block = file.read(qMin(remaining, qint64(65536)));
+        if(block.isEmpty())
+        {
+            //the Content-Length has already been sent, closing the connection tells the client that the body is incomplete
+            QLOG_ERROR() << "Unable to read" << file.fileName() << file.errorString();
+            response.getHeaders().insert("Connection", "close");
+            break;
+        }
+
+        remaining -= block.size();
+        response.write(block, remaining == 0);
+    }
+}
+
+ComicFileControllerV2::RangeResult ComicFileControllerV2::parseRange(const QByteArray &range, qint64 size, qint64 &first, qint64 &last)
+{
+    QByteArray spec = range.trimmed();
+    if(!spec.startsWith("bytes=") || spec.contains(','))
+        return NoRange;
+
+    spec = spec.mid(6).trimmed();
+    int dash = spec.indexOf('-');
+    if(dash < 0)
+        return NoRange;
+
+    QByteArray start = spec.left(dash).trimmed();
+    QByteArray end = spec.mid(dash+1).trimmed();
+    bool ok = true;
+
+    if(start.isEmpty())
+    {
+        //suffix range, the last bytes of the file
+        qint64 length = end.toLongLong(&ok);
+        if(!ok || length < 0)
+            return NoRange;
+        if(length == 0 || size <= 0)
+            return Unsatisfiable;
+        first = qMax(size - length, qint64(0));
+        last = size - 1;
+        return Satisfiable;
+    }
+
+    first = start.toLongLong(&ok);
+    if(!ok || first < 0)
+        return NoRange;
+
+    last = size - 1;
+    if(!end.isEmpty())
+    {
+        qint64 value = end.toLongLong(&ok);
+        if(!ok || value < first)
+            return NoRange;
+        last = qMin(value, size - 1);
+    }
+
+    if(first >= size)
+        return Unsatisfiable;
+
+    return Satisfiable;
+}
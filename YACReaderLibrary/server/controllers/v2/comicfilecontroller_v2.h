@@ -0,0 +1,54 @@
+#ifndef COMICFILECONTROLLER_V2_H
+#define COMICFILECONTROLLER_V2_H
+
+#include "httprequest.h"
+#include "httpresponse.h"
+#include "httprequesthandler.h"
+
+#include <QAtomicInt>
+
+/**
+  Sends the original file of a comic, for reading it offline.
+  <p>
+  The file is streamed from disk in small blocks, the memory used doesn't depend on the size
+  of the comic. Single byte ranges (Range and If-Range headers) are supported so interrupted
+  downloads can be resumed, the ETag is built from the hash of the comic and its file.
+  <p>
+  Each download takes a worker thread until the file has been sent, only maxDownloads files are
+  sent at the same time so the rest of the requests can be served. Other downloads are answered
+  with 503 and a Retry-After header.
+  <p>
+  Settings:
+  <code><pre>
+  maxDownloads=4
+  </pre></code>
+*/
+
+class ComicFileControllerV2 : public HttpRequestHandler {
+    Q_OBJECT
+    Q_DISABLE_COPY(ComicFileControllerV2)
+public:
+    /** Constructor **/
+    ComicFileControllerV2();
+
+    /** Generates the response */
+    void service(HttpRequest& request, HttpResponse& response);
+
+    /** Maximum number of files sent at the same time, 0 for no limit. Set by Startup. */
+    static void setMaxDownloads(int max);
+
+private:
+    enum RangeResult {
+        NoRange, //no range, an invalid range or several ranges, the whole file is sent
+        Satisfiable,
+        Unsatisfiable //valid but out of the file
+    };
+
+    /** Parses a Range header with a single range, multiple ranges are not supported. */
+    static RangeResult parseRange(const QByteArray& range, qint64 size, qint64& first, qint64& last);
+
+    static QAtomicInt downloads;
+    static int maxDownloads;
+};
+
+#endif // COMICFILECONTROLLER_V2_H
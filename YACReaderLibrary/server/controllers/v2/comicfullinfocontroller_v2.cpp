@@ -23,10 +23,8 @@ void ComicFullinfoController_v2::service(HttpRequest& request, HttpResponse& res
 {
     response.setHeader("Content-Type", "application/json");
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    int libraryId = pathElements.at(3).toInt();
-    qulonglong comicId = pathElements.at(5).toULongLong();
+    int libraryId = request.getPathParameter("libraryId").toInt();
+    qulonglong comicId = request.getPathParameter("comicId").toULongLong();
 
     serviceContent(libraryId, comicId, response);
 
@@ -0,0 +1,38 @@
+#include "comicsfullinfocontroller_v2.h"
+
+#include "db_helper.h"
+#include "comic_db.h"
+
+#include "yacreader_server_data_helper.h"
+
+ComicsFullInfoControllerV2::ComicsFullInfoControllerV2() {}
+
+void ComicsFullInfoControllerV2::service(HttpRequest& request, HttpResponse& response)
+{
+    response.setHeader("Content-Type", "application/json");
+
+    qulonglong libraryId = request.getPathParameter("libraryId").toULongLong();
+
+    QList<qulonglong> ids;
+    foreach(QByteArray id, request.getBody().replace(',', '\n').split('\n'))
+    {
+        bool ok;
+        qulonglong comicId = id.trimmed().toULongLong(&ok);
+        if(ok)
+            ids.append(comicId);
+    }
+
+    QList<ComicDB> comics = DBHelper::getComicsInfo(libraryId, ids);
+
+    QJsonArray items;
+
+    for(const ComicDB &comic : comics)
+    {
+        items.append(YACReaderServerDataHelper::fullComicToJSON(libraryId, comic));
+    }
+
+    QJsonDocument output(items);
+
+    response.setStatus(200,"OK");
+    response.write(output.toJson(QJsonDocument::Compact),true);
+}
@@ -0,0 +1,24 @@
+#ifndef COMICSFULLINFOCONTROLLER_V2_H
+#define COMICSFULLINFOCONTROLLER_V2_H
+
+#include "httprequest.h"
+#include "httpresponse.h"
+#include "httprequesthandler.h"
+
+/**
+  Full info of several comics of a library in one request.
+  <p>
+  The ids of the comics are sent in the body, separated by new lines or commas. The response
+  is a JSON array with the comics found, in the same format as ComicFullinfoController_v2.
+*/
+
+class ComicsFullInfoControllerV2 : public HttpRequestHandler {
+    Q_OBJECT
+    Q_DISABLE_COPY(ComicsFullInfoControllerV2)
+public:
+    ComicsFullInfoControllerV2();
+
+    void service(HttpRequest& request, HttpResponse& response);
+};
+
+#endif // COMICSFULLINFOCONTROLLER_V2_H
@@ -6,26 +6,24 @@
 #include "template.h"
 #include "../static.h"
 
+#include <QFileInfo>
+#include <QDateTime>
+
 CoverControllerV2::CoverControllerV2() {}
 
 void CoverControllerV2::service(HttpRequest& request, HttpResponse& response)
 {
-	response.setHeader("Content-Type", "image/jpeg");
+	if (serviceCached(request, response))
+		return;
 
 	YACReaderLibraries libraries = DBHelper::getLibraries();
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-	QStringList pathElements = path.split('/');
-    QString libraryName = DBHelper::getLibraryName(pathElements.at(3).toInt());
-    QString fileName = pathElements.at(5);
-
-	QImage img(libraries.getPath(libraryName)+"/.yacreaderlibrary/covers/"+fileName);
-	if (!img.isNull()) {
-		QByteArray ba;
-		QBuffer buffer(&ba);
-		buffer.open(QIODevice::WriteOnly);
-        img.save(&buffer, "JPG");
-		response.write(ba,true);
+    QString libraryName = DBHelper::getLibraryName(request.getPathParameter("libraryId").toInt());
+    QString fileName = request.getPathParameter("fileName").toString();
+
+	QFile file(libraries.getPath(libraryName)+"/.yacreaderlibrary/covers/"+fileName);
+	if (fileName.endsWith(".jpg") && file.open(QIODevice::ReadOnly)) {
+		writeCover(request, response, file.readAll(), YACReaderCoverPrefetcher::coverETag(QFileInfo(file)));
 	}
 	else
 	{
@@ -34,3 +32,36 @@ void CoverControllerV2::service(HttpRequest& request, HttpResponse& response)
 	}
 }
 
+bool CoverControllerV2::serviceCached(HttpRequest& request, HttpResponse& response)
+{
+	QByteArray data, etag;
+	if (!Static::coverPrefetcher->getCover(request.getPathParameter("libraryId").toULongLong(), request.getPathParameter("fileName").toString(), data, etag))
+		return false;
+
+	writeCover(request, response, data, etag);
+	return true;
+}
+
+void CoverControllerV2::writeCover(HttpRequest& request, HttpResponse& response, const QByteArray& data, const QByteArray& etag)
+{
+	//covers are stored as JPEG, they are sent as they are
+	//a cover can be regenerated under the same hash, clients revalidate it with the ETag unless the
+	//URL carries the version of the cover (?v=, the date part of the ETag), which never changes its content
+	QByteArray version = etag.mid(etag.lastIndexOf('-') + 1);
+	version.chop(1);
+
+	response.setHeader("ETag", etag);
+	if (!version.isEmpty() && request.getParameter("v") == version)
+		response.setHeader("Cache-Control", "max-age=31536000, immutable");
+	else
+		response.setHeader("Cache-Control", "no-cache");
+
+	if (YACReaderHttpCache::matchesETag(request.getHeader("If-None-Match"), etag)) {
+		response.setStatus(304,"Not Modified");
+		response.write(QByteArray(),true);
+		return;
+	}
+
+	response.setHeader("Content-Type", "image/jpeg");
+	response.write(data,true);
+}
@@ -5,6 +5,13 @@
 #include "httpresponse.h"
 #include "httprequesthandler.h"
 
+/**
+  Sends the covers of the comics, /v2/library/:libraryId/cover/<hash>.jpg
+  <p>
+  The responses are revalidated with their ETag. Covers requested with their version,
+  ?v=<version> with the date part of the ETag, are cached as immutable.
+*/
+
 class CoverControllerV2 : public HttpRequestHandler {
     Q_OBJECT
     Q_DISABLE_COPY(CoverControllerV2)
@@ -15,6 +22,15 @@ public:
 
     /** Generates the response */
     void service(HttpRequest& request, HttpResponse& response);
+
+    /**
+      Generates the response if the cover has been prefetched, the disk isn't read.
+      @return false if the cover isn't in memory
+    */
+    static bool serviceCached(HttpRequest& request, HttpResponse& response);
+
+private:
+    static void writeCover(HttpRequest& request, HttpResponse& response, const QByteArray& data, const QByteArray& etag);
 };
 
 #endif // COVERCONTROLLER_H
@@ -0,0 +1,59 @@
+#include "coverscontroller_v2.h"
+
+#include "db_helper.h"  //get libraries
+#include "yacreader_libraries.h"
+#include "yacreader_route_table.h"
+#include "../static.h"
+
+#include <QFile>
+
+CoversControllerV2::CoversControllerV2() {}
+
+void CoversControllerV2::service(HttpRequest& request, HttpResponse& response)
+{
+    qulonglong libraryId = request.getPathParameter("libraryId").toULongLong();
+    QString libraryPath = DBHelper::getLibraries().getPath(libraryId);
+
+    QList<QByteArray> fileNames;
+    QByteArray bundle = request.getParameter("bundle");
+    if(!bundle.isEmpty())
+    {
+        QStringList bundleCovers;
+        if(!Static::coverPrefetcher->getBundle(libraryId, bundle, bundleCovers))
+        {
+            response.setStatus(404,"not found");
+            response.write("404 not found",true);
+            return;
+        }
+
+        foreach(const QString & fileName, bundleCovers)
+            fileNames.append(fileName.toLatin1());
+    }
+    else
+        fileNames = request.getBody().split('\n');
+
+    response.setHeader("Content-Type", "application/x-yacreader-covers");
+
+    //the covers are sent as they are read, the client can show them while the rest arrive
+    foreach(QByteArray fileName, fileNames)
+    {
+        fileName = fileName.trimmed();
+        if(fileName.isEmpty())
+            continue;
+
+        QByteArray data, etag;
+        if(YACReaderRouteTable::isCoverFileName(fileName) && !Static::coverPrefetcher->getCover(libraryId, QString::fromLatin1(fileName), data, etag))
+        {
+            QFile file(libraryPath+"/.yacreaderlibrary/covers/"+QString::fromLatin1(fileName));
+            if(file.open(QIODevice::ReadOnly))
+                data = file.readAll();
+        }
+
+        response.write(fileName + ":" + QByteArray::number(data.size()) + "\r\n" + data);
+
+        if(!response.isConnected())
+            return;
+    }
+
+    response.write(QByteArray(),true);
+}
@@ -0,0 +1,36 @@
+#ifndef COVERSCONTROLLER_V2_H
+#define COVERSCONTROLLER_V2_H
+
+#include "httprequest.h"
+#include "httpresponse.h"
+#include "httprequesthandler.h"
+
+/**
+  Several covers of a library in one response.
+  <p>
+  The cover file names (hash + .jpg, as in CoverControllerV2) are sent in the body, one per line.
+  Each cover is sent as a header line followed by the JPEG data, in the order requested:
+  <code><pre>
+  fileName:size\r\n
+  size bytes
+  </pre></code>
+  Covers that don't exist are sent with size 0.
+  <p>
+  Instead of the file names, a cover bundle token returned by a listing (see
+  YACReaderCoverPrefetcher) can be sent in the bundle parameter, then the covers of the listing
+  are sent in its order. Expired tokens get a 404 response.
+*/
+
+class CoversControllerV2 : public HttpRequestHandler {
+    Q_OBJECT
+    Q_DISABLE_COPY(CoversControllerV2)
+public:
+
+    /** Constructor */
+    CoversControllerV2();
+
+    /** Generates the response */
+    void service(HttpRequest& request, HttpResponse& response);
+};
+
+#endif // COVERSCONTROLLER_V2_H
@@ -4,6 +4,7 @@
 #include "comic_db.h"
 
 #include "yacreader_server_data_helper.h"
+#include "../static.h"
 
 FavoritesControllerV2::FavoritesControllerV2() {}
 
@@ -11,16 +12,14 @@ void FavoritesControllerV2::service(HttpRequest &request, HttpResponse &response
 {
     response.setHeader("Content-Type", "text/plain; charset=utf-8");
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    int libraryId = pathElements.at(3).toInt();
+    int libraryId = request.getPathParameter("libraryId").toInt();
 
-    serviceContent(libraryId, response);
-
-    response.write("",true);
+    Static::httpCache->serviceListing(request, response, libraryId, "favorites", [&]() {
+        return serviceContent(libraryId);
+    });
 }
 
-void FavoritesControllerV2::serviceContent(const int library, HttpResponse &response)
+QByteArray FavoritesControllerV2::serviceContent(const int library)
 {
     QList<ComicDB> comics = DBHelper::getFavorites(library);
 
@@ -33,7 +32,7 @@ void FavoritesControllerV2::serviceContent(const int library, HttpResponse &resp
     
     QJsonDocument output(items);
     
-    response.write(output.toJson(QJsonDocument::Compact));
+    return output.toJson(QJsonDocument::Compact);
 }
 
 
@@ -7,52 +7,53 @@
 #include "folder.h"
 
 #include "yacreader_server_data_helper.h"
+#include "../static.h"
 
-#include "qnaturalsorting.h"
-
 #include "QsLog.h"
 
 #include <chrono>
 #include <ctime>
 using namespace std;
 
-struct LibraryItemSorter
-{
-    bool operator()(const LibraryItem * a,const LibraryItem * b) const
-    {
-        return naturalSortLessThanCI(a->name,b->name);
-    }
-};
-
 FolderContentControllerV2::FolderContentControllerV2() {}
 
 void FolderContentControllerV2::service(HttpRequest& request, HttpResponse& response)
 {
     response.setHeader("Content-Type", "application/json");
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    int libraryId = pathElements.at(3).toInt();
-    qulonglong parentId = pathElements.at(5).toULongLong();
+    int libraryId = request.getPathParameter("libraryId").toInt();
+    qulonglong parentId = request.getPathParameter("folderId").toULongLong();
+
+    //optional pagination, ?offset=n&limit=m returns the items [n, n+m) of the sorted listing
+    int offset = qMax(0, request.getParameter("offset").toInt());
+    bool limited = false;
+    int limit = request.getParameter("limit").toInt(&limited);
+    if(!limited || limit < 0)
+        limit = -1;
 
-    serviceContent(libraryId, parentId, response);
+    QString listing = "folder/"+QString::number(parentId);
+    if(offset > 0 || limit >= 0)
+        listing += QString("/%1-%2").arg(offset).arg(limit);
 
     response.setStatus(200,"OK");
-    response.write("",true);
+    Static::httpCache->serviceListing(request, response, libraryId, listing, [&]()-> QByteArray {
+        //the covers of the listing are loaded while the client reads it
+        if(!YACReaderCoverPrefetcher::isBundleRequested(request))
+            return serviceContent(libraryId, parentId, offset, limit);
+
+        QStringList covers;
+        QByteArray content = serviceContent(libraryId, parentId, offset, limit, &covers);
+        response.setHeader("X-Cover-Bundle", Static::coverPrefetcher->createBundle(libraryId, covers));
+        return content;
+    });
 }
 
-void FolderContentControllerV2::serviceContent(const int &library, const qulonglong &folderId, HttpResponse &response)
+QByteArray FolderContentControllerV2::serviceContent(const int &library, const qulonglong &folderId, int offset, int limit, QStringList *covers)
 {
 #ifdef QT_DEBUG
     auto started = std::chrono::high_resolution_clock::now();
 #endif
-    QList<LibraryItem *> folderContent = DBHelper::getFolderSubfoldersFromLibrary(library,folderId);
-    QList<LibraryItem *> folderComics = DBHelper::getFolderComicsFromLibrary(library,folderId);
-
-    folderContent.append(folderComics);
-    qSort(folderContent.begin(),folderContent.end(),LibraryItemSorter());
-
-    folderComics.clear();
+    QList<LibraryItem *> folderContent = DBHelper::getFolderContentFromLibrary(library,folderId,offset,limit);
 
     QJsonArray items;
 
@@ -64,21 +65,28 @@ void FolderContentControllerV2::serviceContent(const int &library, const qulongl
         {
             currentFolder = (Folder *)(*itr);
             items.append(YACReaderServerDataHelper::folderToJSON(library, *currentFolder));
+            if(covers != nullptr && !currentFolder->getFirstChildHash().isEmpty())
+                covers->append(currentFolder->getFirstChildHash() + ".jpg");
         }
         else
         {
             currentComic = (ComicDB *)(*itr);
             items.append(YACReaderServerDataHelper::comicToJSON(library, *currentComic));
+            if(covers != nullptr && !currentComic->info.hash.isEmpty())
+                covers->append(currentComic->info.hash + ".jpg");
         }
     }
 
+    qDeleteAll(folderContent);
+
     QJsonDocument output(items);
 
-    response.write(output.toJson(QJsonDocument::Compact));
 #ifdef QT_DEBUG
     auto done = std::chrono::high_resolution_clock::now();
     
     QLOG_TRACE() << "num items = " << items.count();
     QLOG_TRACE() << std::chrono::duration_cast<std::chrono::milliseconds>(done-started).count();
 #endif
+
+    return output.toJson(QJsonDocument::Compact);
 }
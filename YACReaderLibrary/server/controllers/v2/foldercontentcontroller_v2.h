@@ -16,7 +16,8 @@ public:
 	void service(HttpRequest& request, HttpResponse& response);
 
 private:
-    void serviceContent(const int &library, const qulonglong &folderId, HttpResponse &response);
+    /** @param covers if not null, the file names of the covers of the listing are added in order */
+    QByteArray serviceContent(const int &library, const qulonglong &folderId, int offset, int limit, QStringList *covers = nullptr);
 };
 
 #endif // FOLDERCONTENTCONTROLLER_H
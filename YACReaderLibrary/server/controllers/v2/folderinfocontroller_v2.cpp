@@ -14,11 +14,9 @@ void FolderInfoControllerV2::service(HttpRequest& request, HttpResponse& respons
 {
     response.setHeader("Content-Type", "text/plain; charset=utf-8");
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-	QStringList pathElements = path.split('/');
-    int libraryId = pathElements.at(3).toInt();
+    int libraryId = request.getPathParameter("libraryId").toInt();
 	QString libraryName = DBHelper::getLibraryName(libraryId);
-    qulonglong parentId = pathElements.at(5).toULongLong();
+    qulonglong parentId = request.getPathParameter("folderId").toULongLong();
 
     serviceComics(libraryId, parentId, response);
 
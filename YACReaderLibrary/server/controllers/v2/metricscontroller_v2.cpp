@@ -0,0 +1,21 @@
+#include "metricscontroller_v2.h"
+
+#include "../static.h"
+
+MetricsControllerV2::MetricsControllerV2() {}
+
+void MetricsControllerV2::service(HttpRequest& request, HttpResponse& response)
+{
+    Q_UNUSED(request);
+
+    if(!Static::metrics->isEnabled())
+    {
+        response.setStatus(404,"not found");
+        response.write("404 not found",true);
+        return;
+    }
+
+    response.setHeader("Content-Type", "text/plain; version=0.0.4; charset=utf-8");
+    response.setHeader("Cache-Control", "no-store");
+    response.write(Static::metrics->toPrometheus(),true);
+}
@@ -0,0 +1,25 @@
+#ifndef METRICSCONTROLLER_V2_H
+#define METRICSCONTROLLER_V2_H
+
+#include "httprequest.h"
+#include "httpresponse.h"
+#include "httprequesthandler.h"
+
+/**
+  Metrics of the server in the Prometheus text format, see YACReaderServerMetrics.
+  It answers 404 unless metrics/enabled is set.
+*/
+
+class MetricsControllerV2 : public HttpRequestHandler {
+    Q_OBJECT
+    Q_DISABLE_COPY(MetricsControllerV2)
+public:
+
+    /** Constructor */
+    MetricsControllerV2();
+
+    /** Generates the response */
+    void service(HttpRequest& request, HttpResponse& response);
+};
+
+#endif // METRICSCONTROLLER_V2_H
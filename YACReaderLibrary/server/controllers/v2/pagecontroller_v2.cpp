@@ -16,37 +16,82 @@
 PageControllerV2::PageControllerV2() {}
 
 void PageControllerV2::service(HttpRequest& request, HttpResponse& response)
-{
-    QByteArray token = request.getHeader("x-request-id");
-    YACReaderHttpSession *ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(token);
-    
-    if (ySession == nullptr) {
-        response.setStatus(424,"no session for this comic");
-        response.write("424 no session for this comic",true);
-        return;
-    }
-    
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    bool remote = path.endsWith("remote");
-    
-    QStringList pathElements = path.split('/');
-    QString libraryName = DBHelper::getLibraryName(pathElements.at(2).toInt());
-    qulonglong comicId = pathElements.at(5).toULongLong();
-    unsigned int page = pathElements.at(7).toUInt();
+{
+    QByteArray token = request.getHeader("x-request-id");
+    QSharedPointer<YACReaderHttpSession> ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(token);
+
+    bool remote = request.getPathParameter("remote").toBool();
     
-    Comic * comicFile;
-    qulonglong currentComicId;
-    if(remote)
+    qulonglong libraryId = request.getPathParameter("libraryId").toULongLong();
+    qulonglong comicId = request.getPathParameter("comicId").toULongLong();
+    unsigned int page = request.getPathParameter("page").toUInt();
+
+    //the size and format requested are kept for the next pages
+    YACReaderPageVariants::Profile profile = YACReaderPageVariants::profileFromRequest(request);
+    if(!ySession.isNull())
     {
-        QLOG_TRACE() << "se recupera comic remoto para servir páginas";
-        comicFile = ySession->getCurrentRemoteComic();
-        currentComicId = ySession->getCurrentRemoteComicId();
+        if(profile.isNull())
+            profile = ySession->getPageProfile();
+        else
+            ySession->setPageProfile(profile);
     }
-    else
+
+    //the reference keeps the comic alive while the page is written, even if the session dismisses it
+    QSharedPointer<Comic> comicFile;
+    qulonglong currentComicId = 0;
+    if(!ySession.isNull())
     {
-        QLOG_TRACE() << "se recupera comic para servir páginas";
-        comicFile = ySession->getCurrentComic();
-        currentComicId = ySession->getCurrentComicId();
+        if(remote)
+        {
+            QLOG_TRACE() << "se recupera comic remoto para servir páginas";
+            comicFile = ySession->getCurrentRemoteComic();
+            currentComicId = ySession->getCurrentRemoteComicId();
+        }
+        else
+        {
+            QLOG_TRACE() << "se recupera comic para servir páginas";
+            comicFile = ySession->getCurrentComic();
+            currentComicId = ySession->getCurrentComicId();
+        }
+    }
+
+    bool sessionComic = !comicFile.isNull() && comicId == currentComicId;
+
+    //the page has already been extracted by the comic opened in the session
+    if(sessionComic && !comicFile->hasBeenAnErrorOpening() && page < comicFile->numPages() && comicFile->pageIsLoaded(page))
+    {
+        writePage(comicFile->getRawPage(page), profile, response);
+        return;
+    }
+
+    //stateless, only the requested page is extracted from the comic file
+    QByteArray pageData;
+    switch(Static::comicPages->getPage(libraryId, comicId, page, pageData))
+    {
+    case YACReaderComicPages::Ok:
+        writePage(pageData, profile, response);
+        return;
+
+    case YACReaderComicPages::NotFound:
+        response.setStatus(404,"not found");
+        response.write("404 not found",true);
+        return;
+
+    case YACReaderComicPages::Unsupported:
+        break;
+    }
+
+    //PDF comics are served from the comic opened in the session
+    if (ySession.isNull()) {
+        response.setStatus(424,"no session for this comic");
+        response.write("424 no session for this comic",true);
+        return;
+    }
+
+    if (comicFile.isNull()) {
+        response.setStatus(404,"not found");
+        response.write("404 not found",true);
+        return;
     }
 
     if (comicFile->hasBeenAnErrorOpening()) {
@@ -61,42 +106,26 @@ void PageControllerV2::service(HttpRequest& request, HttpResponse& response)
         return;
     }
     
-    if(currentComicId != 0 && !QPointer<Comic>(comicFile).isNull())
-    {
-        if (comicFile->numPages() == 0) {
-            response.setStatus(412,"opening file");
-            response.write("412 opening file",true);
+    if(currentComicId != 0)
+    {
+        if (comicFile->numPages() == 0) {
+            response.setStatus(412,"opening file");
+            response.write("412 opening file",true);
         } else {
             if(comicId == currentComicId && page < comicFile->numPages())
             {
-                if(comicFile->pageIsLoaded(page))
-                {
-                    response.setHeader("Content-Type", "image/jpeg");
-                    response.setHeader("Transfer-Encoding","chunked");
-                    QByteArray pageData = comicFile->getRawPage(page);
-                    QDataStream data(pageData);
-                    char buffer[100000];
-                    while (!data.atEnd()) {
-                        int len = data.readRawData(buffer,100000);
-                        response.write(QByteArray(buffer,len));
-                    }
-                    response.write(QByteArray(),true);
-                }
-                else
-                {
-                    response.setStatus(412,"loading page");
-                    response.write("412 loading page",true);
-                }
+                response.setStatus(412,"loading page");
+                response.write("412 loading page",true);
             }
             else
-            {
-                if(comicId != currentComicId)
+            {
+                if(comicId != currentComicId)
                 {
                     //delete comicFile;
                     if(remote)
                         ySession->dismissCurrentRemoteComic();
                     else
-                        ySession->dismissCurrentComic();
+                        ySession->dismissCurrentComic();
                 }
                 response.setStatus(404,"not found");
                 response.write("404 not found",true);
@@ -109,3 +138,12 @@ void PageControllerV2::service(HttpRequest& request, HttpResponse& response)
         response.write("404 not found",true);
     }
 }
+
+void PageControllerV2::writePage(const QByteArray &pageData, const YACReaderPageVariants::Profile &profile, HttpResponse &response)
+{
+    QByteArray contentType;
+    QByteArray data = Static::pageVariants->getPage(pageData, profile, contentType);
+
+    response.setHeader("Content-Type", contentType);
+    response.write(data,true);
+}
@@ -4,6 +4,7 @@
 #include "httprequest.h"
 #include "httpresponse.h"
 #include "httprequesthandler.h"
+#include "yacreader_page_variants.h"
 
 class PageControllerV2 : public HttpRequestHandler {
 	Q_OBJECT
@@ -15,6 +16,10 @@ public:
 
 	/** Generates the response */
 	void service(HttpRequest& request, HttpResponse& response);
+
+private:
+    /** Writes the page sized for the profile of the client */
+    void writePage(const QByteArray& pageData, const YACReaderPageVariants::Profile& profile, HttpResponse& response);
 };
 
 #endif // PAGECONTROLLER_H
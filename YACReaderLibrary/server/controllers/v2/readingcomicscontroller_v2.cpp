@@ -4,6 +4,7 @@
 #include "comic_db.h"
 
 #include "yacreader_server_data_helper.h"
+#include "../static.h"
 
 ReadingComicsControllerV2::ReadingComicsControllerV2()
 {
@@ -14,17 +15,15 @@ void ReadingComicsControllerV2::service(HttpRequest &request, HttpResponse &resp
 {
     response.setHeader("Content-Type", "application/json");
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    int libraryId = pathElements.at(3).toInt();
-
-    serviceContent(libraryId, response);
+    int libraryId = request.getPathParameter("libraryId").toInt();
 
     response.setStatus(200,"OK");
-    response.write("",true);
+    Static::httpCache->serviceListing(request, response, libraryId, "reading", [&]() {
+        return serviceContent(libraryId);
+    });
 }
 
-void ReadingComicsControllerV2::serviceContent(const int &library, HttpResponse &response)
+QByteArray ReadingComicsControllerV2::serviceContent(const int &library)
 {
     QList<ComicDB> readingComics = DBHelper::getReading(library);
 
@@ -37,5 +36,5 @@ void ReadingComicsControllerV2::serviceContent(const int &library, HttpResponse
 
     QJsonDocument output(comics);
 
-    response.write(output.toJson(QJsonDocument::Compact));
+    return output.toJson(QJsonDocument::Compact);
 }
@@ -4,6 +4,7 @@
 #include "comic_db.h"
 
 #include "yacreader_server_data_helper.h"
+#include "../static.h"
 
 ReadingListContentControllerV2::ReadingListContentControllerV2()
 {
@@ -14,17 +15,22 @@ void ReadingListContentControllerV2::service(HttpRequest &request, HttpResponse
 {
     response.setHeader("Content-Type", "text/plain; charset=utf-8");
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    int libraryId = pathElements.at(3).toInt();
-    qulonglong readingListId = pathElements.at(5).toULongLong();
+    int libraryId = request.getPathParameter("libraryId").toInt();
+    qulonglong readingListId = request.getPathParameter("readingListId").toULongLong();
 
-    serviceContent(libraryId, readingListId, response);
+    Static::httpCache->serviceListing(request, response, libraryId, "readinglist/"+QString::number(readingListId), [&]()-> QByteArray {
+        //the covers of the listing are loaded while the client reads it
+        if(!YACReaderCoverPrefetcher::isBundleRequested(request))
+            return serviceContent(libraryId, readingListId);
 
-    response.write("",true);
+        QStringList covers;
+        QByteArray content = serviceContent(libraryId, readingListId, &covers);
+        response.setHeader("X-Cover-Bundle", Static::coverPrefetcher->createBundle(libraryId, covers));
+        return content;
+    });
 }
 
-void ReadingListContentControllerV2::serviceContent(const int &library, const qulonglong &readingListId, HttpResponse &response)
+QByteArray ReadingListContentControllerV2::serviceContent(const int &library, const qulonglong &readingListId, QStringList *covers)
 {
     QList<ComicDB> comics = DBHelper::getReadingListFullContent(library, readingListId);
 
@@ -33,9 +39,11 @@ void ReadingListContentControllerV2::serviceContent(const int &library, const qu
     for(const ComicDB &comic : comics)
     {
         items.append(YACReaderServerDataHelper::comicToJSON(library, comic));
+        if(covers != nullptr)
+            covers->append(comic.info.hash + ".jpg");
     }
 
     QJsonDocument output(items);
 
-    response.write(output.toJson(QJsonDocument::Compact));
+    return output.toJson(QJsonDocument::Compact);
 }
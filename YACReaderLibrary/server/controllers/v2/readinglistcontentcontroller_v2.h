@@ -14,7 +14,8 @@ public:
     void service(HttpRequest& request, HttpResponse& response);
 
 private:
-    void serviceContent(const int &library, const qulonglong &readingListId, HttpResponse &response);
+    /** @param covers if not null, the file names of the covers of the listing are added in order */
+    QByteArray serviceContent(const int &library, const qulonglong &readingListId, QStringList *covers = nullptr);
 };
 
 #endif // READINGLISTCONTENTCONTROLLER_H
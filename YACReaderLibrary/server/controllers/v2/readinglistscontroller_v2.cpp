@@ -3,6 +3,7 @@
 #include "db_helper.h"
 #include "reading_list.h"
 #include "yacreader_server_data_helper.h"
+#include "../static.h"
 
 
 
@@ -15,16 +16,14 @@ void ReadingListsControllerV2::service(HttpRequest &request, HttpResponse &respo
 {
     response.setHeader("Content-Type", "text/plain; charset=utf-8");
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    int libraryId = pathElements.at(3).toInt();
+    int libraryId = request.getPathParameter("libraryId").toInt();
 
-    serviceContent(libraryId, response);
-
-    response.write("",true);
+    Static::httpCache->serviceListing(request, response, libraryId, "readinglists", [&]() {
+        return serviceContent(libraryId);
+    });
 }
 
-void ReadingListsControllerV2::serviceContent(const int library, HttpResponse &response)
+QByteArray ReadingListsControllerV2::serviceContent(const int library)
 {
     QList<ReadingList> readingLists = DBHelper::getReadingLists(library);
 
@@ -37,5 +36,5 @@ void ReadingListsControllerV2::serviceContent(const int library, HttpResponse &r
 
     QJsonDocument output(items);
 
-    response.write(output.toJson(QJsonDocument::Compact));
+    return output.toJson(QJsonDocument::Compact);
 }
@@ -14,7 +14,7 @@ public:
     void service(HttpRequest& request, HttpResponse& response);
 
 private:
-    void serviceContent(const int library, HttpResponse &response);
+    QByteArray serviceContent(const int library);
 };
 
 #endif // READINGLISTSCONTROLLER_H
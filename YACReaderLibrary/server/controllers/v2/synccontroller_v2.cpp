@@ -5,74 +5,167 @@
 
 #include "comic_db.h"
 #include "db_helper.h"
+#include "../static.h"
 
-SyncControllerV2::SyncControllerV2()
+//a sync line is far shorter, anything longer is not sync data
+#define MAX_LINE_SIZE 65536
+//number of updates applied in a single transaction per library
+#define MAX_PENDING_UPDATES 1000
+
+/**
+  Parses the lines of the body and applies the updates in batches.
+*/
+class SyncBodySink : public HttpRequestBodySink {
+public:
+    SyncBodySink();
+
+    bool write(const QByteArray& data);
+
+    /** Parses the last line and applies the pending updates */
+    void finish();
+
+    bool hasReceivedData() const { return received; }
+    bool isRejected() const { return rejected; }
+
+private:
+    void parseLine(const QString & comicInfo);
+    void applyUpdates();
+
+    QByteArray pendingLine;
+
+    //the updates are applied per library, each library is updated in a single transaction per batch
+    QMap<qulonglong, QList<ComicInfo> > updates;
+    QList<ComicInfo> updatesWithHash;
+    int pendingUpdates;
+
+    bool received;
+    bool rejected;
+};
+
+SyncBodySink::SyncBodySink()
+    :pendingUpdates(0), received(false), rejected(false)
 {
 
 }
 
-void SyncControllerV2::service(HttpRequest &request, HttpResponse &response)
+bool SyncBodySink::write(const QByteArray &data)
+{
+    QLOG_TRACE() << "POST DATA: " << QString::fromUtf8(data);
+
+    received = received || !data.isEmpty();
+    pendingLine.append(data);
+
+    int start = 0;
+    int end;
+    while((end = pendingLine.indexOf('\n', start)) >= 0)
+    {
+        parseLine(QString::fromUtf8(pendingLine.constData() + start, end - start));
+        start = end + 1;
+    }
+    pendingLine.remove(0, start);
+
+    if(pendingLine.size() > MAX_LINE_SIZE)
+    {
+        QLOG_WARN() << "Sync line too long, the request is rejected";
+        rejected = true;
+        return false;
+    }
+
+    if(pendingUpdates >= MAX_PENDING_UPDATES)
+        applyUpdates();
+
+    return true;
+}
+
+void SyncBodySink::finish()
 {
-    QString postData = QString::fromUtf8(request.getBody());
+    if(!pendingLine.isEmpty())
+    {
+        parseLine(QString::fromUtf8(pendingLine));
+        pendingLine.clear();
+    }
+
+    applyUpdates();
+}
 
-    QLOG_TRACE() << "POST DATA: " << postData;
+void SyncBodySink::parseLine(const QString &comicInfo)
+{
+    QList<QString> comicInfoProgress = comicInfo.split("\t");
 
-    if(postData.length()>0) {
-        QList<QString> data = postData.split("\n");
+    if(comicInfoProgress.length() == 6)
+    {
+        ComicInfo info;
+        info.hash = comicInfoProgress.at(2); //TODO remove the hash check and add UUIDs for libraries
+        info.currentPage = comicInfoProgress.at(3).toInt();
+        info.rating = comicInfoProgress.at(4).toInt();
+        info.lastTimeOpened = comicInfoProgress.at(5).toULong();
 
-        qulonglong libraryId;
-        qulonglong comicId;
-        int currentPage;
-        int currentRating;
-        unsigned long long lastTimeOpened;
-        QString hash;
-        foreach(QString comicInfo, data)
+        if (comicInfoProgress.at(0) != "unknown")
+        {
+            info.id = comicInfoProgress.at(1).toULongLong();
+            updates[comicInfoProgress.at(0).toULongLong()].append(info);
+        }
+        else
         {
-            QList<QString> comicInfoProgress = comicInfo.split("\t");
-
-            if(comicInfoProgress.length() == 6)
-            {
-                if (comicInfoProgress.at(0) != "unknown")
-                {
-                    libraryId = comicInfoProgress.at(0).toULongLong();
-                    comicId = comicInfoProgress.at(1).toULongLong();
-                    hash = comicInfoProgress.at(2);
-                    currentPage = comicInfoProgress.at(3).toInt();
-
-                    ComicInfo info;
-                    info.currentPage = currentPage;
-                    info.hash = hash; //TODO remove the hash check and add UUIDs for libraries
-                    info.id = comicId;
-
-                    currentRating = comicInfoProgress.at(4).toInt();
-                    info.rating = currentRating;
-
-                    lastTimeOpened = comicInfoProgress.at(5).toULong();
-                    info.lastTimeOpened = lastTimeOpened;
-
-                    DBHelper::updateFromRemoteClient(libraryId,info);
-                }
-                else
-                {
-                    hash = comicInfoProgress.at(2);
-                    currentPage = comicInfoProgress.at(3).toInt();
-
-                    ComicInfo info;
-                    info.currentPage = currentPage;
-                    info.hash = hash;
-
-                    currentRating = comicInfoProgress.at(4).toInt();
-                    info.rating = currentRating;
-
-                    lastTimeOpened = comicInfoProgress.at(5).toULong();
-                    info.lastTimeOpened = lastTimeOpened;
-
-                    DBHelper::updateFromRemoteClientWithHash(info);
-                }
-            }
+            updatesWithHash.append(info);
         }
+
+        pendingUpdates++;
     }
-    else
+}
+
+void SyncBodySink::applyUpdates()
+{
+    for(QMap<qulonglong, QList<ComicInfo> >::const_iterator itr = updates.constBegin(); itr != updates.constEnd(); itr++)
+    {
+        DBHelper::updateFromRemoteClient(itr.key(), itr.value());
+        Static::httpCache->libraryUpdated(itr.key());
+    }
+
+    //comics from unknown libraries are looked up by hash in every library
+    if(!updatesWithHash.isEmpty())
+    {
+        DBHelper::updateFromRemoteClientWithHash(updatesWithHash);
+        Static::httpCache->librariesUpdated();
+    }
+
+    updates.clear();
+    updatesWithHash.clear();
+    pendingUpdates = 0;
+}
+
+SyncControllerV2::SyncControllerV2()
+{
+
+}
+
+HttpRequestBodySink * SyncControllerV2::createBodySink()
+{
+    return new SyncBodySink;
+}
+
+void SyncControllerV2::service(HttpRequest &request, HttpResponse &response)
+{
+    SyncBodySink * sink = static_cast<SyncBodySink *>(request.getBodySink());
+
+    //small bodies and requests without Content-Length are stored in memory
+    SyncBodySink bufferedSink;
+    if(sink == nullptr)
+    {
+        sink = &bufferedSink;
+        sink->write(request.getBody());
+    }
+
+    if(sink->isRejected())
+    {
+        response.setStatus(400,"Invalid sync data");
+        response.write("",true);
+        return;
+    }
+
+    sink->finish();
+
+    if(!sink->hasReceivedData())
     {
         response.setStatus(412,"No comic info received");
         response.write("",true);
@@ -81,4 +174,3 @@ void SyncControllerV2::service(HttpRequest &request, HttpResponse &response)
 
     response.write("OK",true);
 }
-
@@ -16,6 +16,9 @@ public:
 
     /** Generates the response */
     void service(HttpRequest& request, HttpResponse& response);
+
+    /** The updates are applied while the body is received, so batches of any size use constant memory */
+    static HttpRequestBodySink * createBodySink();
 };
 
 #endif // SYNCCONTROLLER_H
@@ -4,6 +4,7 @@
 #include "comic_db.h"
 
 #include "yacreader_server_data_helper.h"
+#include "../static.h"
 
 #include <QUrl>
 
@@ -16,17 +17,15 @@ void TagContentControllerV2::service(HttpRequest &request, HttpResponse &respons
 {
     response.setHeader("Content-Type", "text/plain; charset=utf-8");
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    int libraryId = pathElements.at(3).toInt();
-    qulonglong tagId = pathElements.at(5).toULongLong();
+    int libraryId = request.getPathParameter("libraryId").toInt();
+    qulonglong tagId = request.getPathParameter("tagId").toULongLong();
 
-    serviceContent(libraryId, tagId, response);
-
-    response.write("",true);
+    Static::httpCache->serviceListing(request, response, libraryId, "tag/"+QString::number(tagId), [&]() {
+        return serviceContent(libraryId, tagId);
+    });
 }
 
-void TagContentControllerV2::serviceContent(const int &library, const qulonglong &tagId, HttpResponse &response)
+QByteArray TagContentControllerV2::serviceContent(const int &library, const qulonglong &tagId)
 {
     QList<ComicDB> comics = DBHelper::getLabelComics(library, tagId);
     
@@ -39,5 +38,5 @@ void TagContentControllerV2::serviceContent(const int &library, const qulonglong
     
     QJsonDocument output(items);
     
-    response.write(output.toJson(QJsonDocument::Compact));
+    return output.toJson(QJsonDocument::Compact);
 }
@@ -16,7 +16,7 @@ public:
     void service(HttpRequest& request, HttpResponse& response);
 
 private:
-    void serviceContent(const int &library, const qulonglong &tagId, HttpResponse &response);
+    QByteArray serviceContent(const int &library, const qulonglong &tagId);
 };
 
 #endif // TAGCONTENTCONTROLLER_H
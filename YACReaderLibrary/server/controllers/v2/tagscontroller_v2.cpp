@@ -17,20 +17,25 @@ void TagsControllerV2::service(HttpRequest& request, HttpResponse& response)
 {
     response.setHeader("Content-Type", "text/plain; charset=utf-8");
 
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    int libraryId = pathElements.at(3).toInt();
+    int libraryId = request.getPathParameter("libraryId").toInt();
 
-    QList<Label> labels = DBHelper::getLabels(libraryId);
+    Static::httpCache->serviceListing(request, response, libraryId, "tags", [&]() {
+        return serviceContent(libraryId);
+    });
+}
+
+QByteArray TagsControllerV2::serviceContent(const int library)
+{
+    QList<Label> labels = DBHelper::getLabels(library);
 
     QJsonArray items;
 
     for(QList<Label>::const_iterator itr = labels.constBegin();itr!=labels.constEnd();itr++)
     {
-        items.append(YACReaderServerDataHelper::labelToJSON(libraryId, *itr));
+        items.append(YACReaderServerDataHelper::labelToJSON(library, *itr));
     }
 
     QJsonDocument output(items);
 
-    response.write(output.toJson(QJsonDocument::Compact));;
+    return output.toJson(QJsonDocument::Compact);
 }
@@ -17,6 +17,9 @@ public:
 
     /** Generates the response */
     void service(HttpRequest& request, HttpResponse& response);
+
+private:
+    QByteArray serviceContent(const int library);
 };
 
 #endif // TAGSCONTROLLER_H
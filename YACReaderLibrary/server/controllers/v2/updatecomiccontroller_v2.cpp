@@ -15,11 +15,9 @@ UpdateComicControllerV2::UpdateComicControllerV2(){}
 
 void UpdateComicControllerV2::service(HttpRequest &request, HttpResponse &response)
 {
-    QString path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
-    QStringList pathElements = path.split('/');
-    qulonglong libraryId = pathElements.at(3).toULongLong();
+    qulonglong libraryId = request.getPathParameter("libraryId").toULongLong();
     QString libraryName = DBHelper::getLibraryName(libraryId);
-    qulonglong comicId = pathElements.at(5).toULongLong();
+    qulonglong comicId = request.getPathParameter("comicId").toULongLong();
 
     QString postData = QString::fromUtf8(request.getBody());
 
@@ -33,6 +31,7 @@ void UpdateComicControllerV2::service(HttpRequest &request, HttpResponse &respon
         info.currentPage = currentPage;
         info.id = comicId;
         DBHelper::updateProgress(libraryId,info);
+        Static::httpCache->libraryUpdated(libraryId);
 
         if (data.length() > 1) {
             if (data.at(1).isEmpty() == false) {
@@ -5,42 +5,219 @@
 
 #include "httpconnectionhandler.h"
 #include "httpresponse.h"
+#include <QRunnable>
 
-HttpConnectionHandler::HttpConnectionHandler(QSettings* settings, HttpRequestHandler* requestHandler, QSslConfiguration* sslConfiguration)
-    : QThread()
+/**
+  Processes a complete request in a worker thread. A streamed body is passed to its sink
+  first, while it is received.
+*/
+class HttpConnectionHandler::RequestTask : public QRunnable {
+public:
+
+    RequestTask(HttpConnectionHandler* handler, HttpRequest* request)
+        : handler(handler), request(request) {}
+
+    void run()
+    {
+        // Pass the streamed body to the sink
+        bool bodyAccepted=true;
+        if (request->getBodySink())
+        {
+            bodyAccepted=receiveBody();
+            if (bodyAccepted && request->getStatus()==HttpRequest::abort)
+            {
+                // The connection has been lost or timed out, nobody waits for the response
+                QMetaObject::invokeMethod(handler,"requestFinished",Qt::QueuedConnection,Q_ARG(bool,true));
+                return;
+            }
+        }
+
+        // Copy the Connection:close header to the response
+        HttpResponse response(handler);
+        bool closeConnection=QString::compare(request->getHeader("Connection"),"close",Qt::CaseInsensitive)==0;
+        if (closeConnection)
+        {
+            response.setHeader("Connection","close");
+        }
+
+        // The rest of a rejected body must not be taken for the next request
+        else if (!bodyAccepted)
+        {
+            closeConnection=true;
+            response.setHeader("Connection","close");
+        }
+
+        // In case of HTTP 1.0 protocol add the Connection:close header.
+        // This ensures that the HttpResponse does not activate chunked mode, which is not spported by HTTP 1.0.
+        else
+        {
+            bool http1_0=QString::compare(request->getVersion(),"HTTP/1.0",Qt::CaseInsensitive)==0;
+            if (http1_0)
+            {
+                closeConnection=true;
+                response.setHeader("Connection","close");
+            }
+        }
+
+        // Text and JSON bodies are compressed if the client accepts it
+        int compressionThreshold=handler->settings->value("compressionThreshold",1024).toInt();
+        if (compressionThreshold>=0)
+        {
+            response.enableCompression(request->getHeader("Accept-Encoding"),compressionThreshold);
+        }
+
+        // Tell the client how long an idle connection is kept open
+        if (!closeConnection)
+        {
+            int readTimeout=handler->settings->value("readTimeout",10000).toInt();
+            response.setHeader("Keep-Alive","timeout="+QByteArray::number(qMax(1,readTimeout/1000)));
+        }
+
+        // Call the request mapper
+        try
+        {
+            handler->requestHandler->service(*request, response);
+        }
+        catch (...)
+        {
+            qCritical("HttpConnectionHandler (%p): An uncatched exception occured in the request handler",handler);
+        }
+
+        // Finalize sending the response if not already done
+        if (!response.hasSentLastPart())
+        {
+            response.write(QByteArray(),true);
+        }
+
+        // Find out whether the connection must be closed
+        if (!closeConnection)
+        {
+            // Maybe the request handler or mapper added a Connection:close header in the meantime
+            bool closeResponse=QString::compare(response.getHeaders().value("Connection"),"close",Qt::CaseInsensitive)==0;
+            if (closeResponse==true)
+            {
+                closeConnection=true;
+            }
+            else
+            {
+                // If we have no Content-Length header and did not use chunked mode, then we have to close the
+                // connection to tell the HTTP client that the end of the response has been reached.
+                bool hasContentLength=response.getHeaders().contains("Content-Length");
+                if (!hasContentLength && response.hasBody())
+                {
+                    bool hasChunkedMode=QString::compare(response.getHeaders().value("Transfer-Encoding"),"chunked",Qt::CaseInsensitive)==0;
+                    if (!hasChunkedMode)
+                    {
+                        closeConnection=true;
+                    }
+                }
+            }
+        }
+
+        // Continue in the I/O thread
+        QMetaObject::invokeMethod(handler,"requestFinished",Qt::QueuedConnection,Q_ARG(bool,closeConnection));
+    }
+
+private:
+
+    /** Pass the parts of the body to the sink, returns false if the sink has rejected them */
+    bool receiveBody()
+    {
+        HttpRequestBodySink* sink=request->getBodySink();
+        QByteArray data;
+        while (request->takeBodyData(data))
+        {
+            // The buffer has space again, let the I/O thread continue reading
+            QMetaObject::invokeMethod(handler,"read",Qt::QueuedConnection);
+            if (!sink->write(data))
+            {
+                qWarning("HttpConnectionHandler (%p): the request body has been rejected",handler);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    HttpConnectionHandler* handler;
+    HttpRequest* request;
+};
+
+
+/**
+  Collects a response generated in the I/O thread, it is written to the socket at once.
+*/
+class ResponseBuffer : public HttpResponseOutput {
+public:
+
+    bool write(const QByteArray& data)
+    {
+        buffer.append(data);
+        return true;
+    }
+
+    void flush() {}
+
+    bool isConnected() const
+    {
+        return true;
+    }
+
+    QByteArray buffer;
+};
+
+
+QAtomicInt HttpConnectionHandler::connectionCount;
+
+
+int HttpConnectionHandler::getConnectionCount()
+{
+    return connectionCount.load();
+}
+
+
+HttpConnectionHandler::HttpConnectionHandler(QSettings* settings, HttpRequestHandler* requestHandler, QThreadPool* workers, QSslConfiguration* sslConfiguration)
+    : QObject(), readTimer(this)
 {
     Q_ASSERT(settings!=0);
     Q_ASSERT(requestHandler!=0);
+    Q_ASSERT(workers!=0);
     this->settings=settings;
     this->requestHandler=requestHandler;
+    this->workers=workers;
     this->sslConfiguration=sslConfiguration;
     currentRequest=0;
-    busy=false;
+    processing=false;
+    queuedBytes=0;
+    bufferedBytes=0;
+    closed=false;
+    maxPendingBytes=settings->value("maxPendingBytes",65536).toLongLong();
+    bodyBufferSize=settings->value("bodyBufferSize",65536).toInt();
+    connectionCount.ref();
 
     // Create TCP or SSL socket
     createSocket();
 
-    // execute signals in my own thread
-    moveToThread(this);
-    socket->moveToThread(this);
-    readTimer.moveToThread(this);
-
     // Connect signals
     connect(socket, SIGNAL(readyRead()), SLOT(read()));
     connect(socket, SIGNAL(disconnected()), SLOT(disconnected()));
+    connect(socket, SIGNAL(bytesWritten(qint64)), SLOT(bytesWritten()));
     connect(&readTimer, SIGNAL(timeout()), SLOT(readTimeout()));
     readTimer.setSingleShot(true);
 
-    qDebug("HttpConnectionHandler (%p): constructed", this);
-    this->start();
+    #ifdef SUPERVERBOSE
+        qDebug("HttpConnectionHandler (%p): constructed", this);
+    #endif
 }
 
 
 HttpConnectionHandler::~HttpConnectionHandler()
 {
-    quit();
-    wait();
-    qDebug("HttpConnectionHandler (%p): destroyed", this);
+    connectionCount.deref();
+    readTimer.stop();
+    delete currentRequest;
+    #ifdef SUPERVERBOSE
+        qDebug("HttpConnectionHandler (%p): destroyed", this);
+    #endif
 }
 
 
@@ -50,7 +227,7 @@ void HttpConnectionHandler::createSocket()
     #ifndef QT_NO_OPENSSL
         if (sslConfiguration)
         {
-            QSslSocket* sslSocket=new QSslSocket();
+            QSslSocket* sslSocket=new QSslSocket(this);
             sslSocket->setSslConfiguration(*sslConfiguration);
             socket=sslSocket;
             qDebug("HttpConnectionHandler (%p): SSL is enabled", this);
@@ -58,42 +235,21 @@ void HttpConnectionHandler::createSocket()
         }
     #endif
     // else create an instance of QTcpSocket
-    socket=new QTcpSocket();
-}
-
-
-void HttpConnectionHandler::run()
-{
-    qDebug("HttpConnectionHandler (%p): thread started", this);
-    try
-    {
-        exec();
-    }
-    catch (...)
-    {
-        qCritical("HttpConnectionHandler (%p): an uncatched exception occured in the thread",this);
-    }
-    socket->close();
-    delete socket;
-    readTimer.stop();
-    qDebug("HttpConnectionHandler (%p): thread stopped", this);
+    socket=new QTcpSocket(this);
 }
 
 
 void HttpConnectionHandler::handleConnection(tSocketDescriptor socketDescriptor)
 {
-    qDebug("HttpConnectionHandler (%p): handle new connection", this);
-    busy = true;
-    Q_ASSERT(socket->isOpen()==false); // if not, then the handler is already busy
-
-    //UGLY workaround - we need to clear writebuffer before reusing this socket
-    //https://bugreports.qt-project.org/browse/QTBUG-28914
-    socket->connectToHost("",0);
-    socket->abort();
+    #ifdef SUPERVERBOSE
+        qDebug("HttpConnectionHandler (%p): handle new connection", this);
+    #endif
 
     if (!socket->setSocketDescriptor(socketDescriptor))
     {
         qCritical("HttpConnectionHandler (%p): cannot initialize socket: %s", this,qPrintable(socket->errorString()));
+        closed=true;
+        deleteLater();
         return;
     }
 
@@ -109,20 +265,71 @@ void HttpConnectionHandler::handleConnection(tSocketDescriptor socketDescriptor)
     // Start timer for read timeout
     int readTimeout=settings->value("readTimeout",10000).toInt();
     readTimer.start(readTimeout);
-    // delete previous request
-    delete currentRequest;
-    currentRequest=0;
 }
 
 
-bool HttpConnectionHandler::isBusy()
+bool HttpConnectionHandler::write(const QByteArray& data)
+{
+    QMutexLocker locker(&outputMutex);
+
+    // If the output buffer has become large, then wait until it has been sent.
+    while (!closed && queuedBytes+bufferedBytes>maxPendingBytes)
+    {
+        outputWritten.wait(&outputMutex);
+    }
+
+    if (closed)
+    {
+        return false;
+    }
+
+    queuedBytes+=data.size();
+    QMetaObject::invokeMethod(this,"writeData",Qt::QueuedConnection,Q_ARG(QByteArray,data));
+    return true;
+}
+
+
+void HttpConnectionHandler::flush()
+{
+    QMetaObject::invokeMethod(this,"flushData",Qt::QueuedConnection);
+}
+
+
+bool HttpConnectionHandler::isConnected() const
+{
+    QMutexLocker locker(&outputMutex);
+    return !closed;
+}
+
+
+void HttpConnectionHandler::writeData(QByteArray data)
+{
+    if (socket->isOpen())
+    {
+        socket->write(data);
+    }
+
+    QMutexLocker locker(&outputMutex);
+    queuedBytes-=data.size();
+    bufferedBytes=socket->bytesToWrite();
+    outputWritten.wakeAll();
+}
+
+
+void HttpConnectionHandler::flushData()
 {
-    return busy;
+    if (socket->isOpen())
+    {
+        socket->flush();
+    }
 }
 
-void HttpConnectionHandler::setBusy()
+
+void HttpConnectionHandler::bytesWritten()
 {
-    this->busy = true;
+    QMutexLocker locker(&outputMutex);
+    bufferedBytes=socket->bytesToWrite();
+    outputWritten.wakeAll();
 }
 
 
@@ -135,21 +342,149 @@ void HttpConnectionHandler::readTimeout()
 
     socket->flush();
     socket->disconnectFromHost();
-    delete currentRequest;
-    currentRequest=0;
+    if (!processing)
+    {
+        delete currentRequest;
+        currentRequest=0;
+    }
+    else
+    {
+        // Wake up a worker that waits for the rest of a streamed body
+        currentRequest->abortBody();
+    }
 }
 
 
 void HttpConnectionHandler::disconnected()
 {
-    qDebug("HttpConnectionHandler (%p): disconnected", this);
+    #ifdef SUPERVERBOSE
+        qDebug("HttpConnectionHandler (%p): disconnected", this);
+    #endif
     socket->close();
     readTimer.stop();
-    busy = false;
+
+    {
+        QMutexLocker locker(&outputMutex);
+        closed=true;
+        outputWritten.wakeAll();
+    }
+
+    // The worker still uses this handler, it will be deleted in requestFinished()
+    if (!processing)
+    {
+        deleteLater();
+    }
+    else
+    {
+        // Wake up a worker that waits for the rest of a streamed body
+        currentRequest->abortBody();
+    }
+}
+
+
+void HttpConnectionHandler::requestFinished(bool closeConnection)
+{
+    #ifdef SUPERVERBOSE
+        qDebug("HttpConnectionHandler (%p): finished request",this);
+    #endif
+
+    processing=false;
+    delete currentRequest;
+    currentRequest=0;
+
+    // The read buffer may have been limited for a streamed body
+    socket->setReadBufferSize(0);
+
+    if (isConnected()==false)
+    {
+        deleteLater();
+        return;
+    }
+
+    // Close the connection or prepare for the next request on the same connection.
+    if (closeConnection)
+    {
+        socket->flush();
+        socket->disconnectFromHost();
+    }
+    else
+    {
+        // Start timer for next request
+        int readTimeout=settings->value("readTimeout",10000).toInt();
+        readTimer.start(readTimeout);
+
+        // Requests received while this one was processed (HTTP pipelining)
+        read();
+    }
+}
+
+
+bool HttpConnectionHandler::serviceImmediately(HttpRequest* request)
+{
+    // Let a worker wait until the client reads what it has been sent
+    if (socket->bytesToWrite()>maxPendingBytes)
+    {
+        return false;
+    }
+
+    // Only persistent connections, closing them is left to the worker
+    if (QString::compare(request->getHeader("Connection"),"close",Qt::CaseInsensitive)==0 ||
+        QString::compare(request->getVersion(),"HTTP/1.0",Qt::CaseInsensitive)==0)
+    {
+        return false;
+    }
+
+    ResponseBuffer output;
+    HttpResponse response(&output);
+    int readTimeout=settings->value("readTimeout",10000).toInt();
+    response.setHeader("Keep-Alive","timeout="+QByteArray::number(qMax(1,readTimeout/1000)));
+
+    bool answered=false;
+    try
+    {
+        answered=requestHandler->serviceImmediately(*request, response);
+    }
+    catch (...)
+    {
+        qCritical("HttpConnectionHandler (%p): An uncatched exception occured in the request handler",this);
+    }
+
+    if (!answered)
+    {
+        return false;
+    }
+
+    if (!response.hasSentLastPart())
+    {
+        response.write(QByteArray(),true);
+    }
+
+    socket->write(output.buffer);
+
+    QMutexLocker locker(&outputMutex);
+    bufferedBytes=socket->bytesToWrite();
+    return true;
 }
 
+
 void HttpConnectionHandler::read()
 {
+    // Nothing is read from a connection that is being closed, e.g. the rest of a rejected body
+    if (socket->state()!=QAbstractSocket::ConnectedState)
+    {
+        return;
+    }
+
+    // The next request is read when the current one has been processed,
+    // only the body of a streamed request is read while it is processed
+    if (processing && currentRequest->getStatus()!=HttpRequest::waitForBody)
+    {
+        return;
+    }
+
+    // True if a request has been answered in this thread
+    bool answered=false;
+
     // The loop adds support for HTTP pipelinig
     while (socket->bytesAvailable())
     {
@@ -160,12 +495,19 @@ void HttpConnectionHandler::read()
         // Create new HttpRequest object if necessary
         if (!currentRequest)
         {
-            currentRequest=new HttpRequest(settings);
+            currentRequest=new HttpRequest(settings,requestHandler);
         }
 
         // Collect data for the request object
         while (socket->bytesAvailable() && currentRequest->getStatus()!=HttpRequest::complete && currentRequest->getStatus()!=HttpRequest::abort)
         {
+            // Wait until the worker has taken the buffered part of a streamed body,
+            // the client is not the one to blame for the delay
+            if (currentRequest->isBodyBufferFull())
+            {
+                readTimer.stop();
+                return;
+            }
             currentRequest->readFromSocket(socket);
             if (currentRequest->getStatus()==HttpRequest::waitForBody)
             {
@@ -173,12 +515,26 @@ void HttpConnectionHandler::read()
                 // expire during large file uploads.
                 int readTimeout=settings->value("readTimeout",10000).toInt();
                 readTimer.start(readTimeout);
+
+                // Let a worker pass a streamed body to its sink while it is received,
+                // the socket buffers no more than the worker does
+                if (!processing && currentRequest->getBodySink())
+                {
+                    processing=true;
+                    socket->setReadBufferSize(bodyBufferSize);
+                    workers->start(new RequestTask(this,currentRequest));
+                }
             }
         }
 
         // If the request is aborted, return error message and close the connection
         if (currentRequest->getStatus()==HttpRequest::abort)
         {
+            // The worker of a streamed body finishes the request
+            if (processing)
+            {
+                return;
+            }
             socket->write("HTTP/1.1 413 entity too large\r\nConnection: close\r\n\r\n413 Entity too large\r\n");
             socket->flush();
             socket->disconnectFromHost();
@@ -187,89 +543,38 @@ void HttpConnectionHandler::read()
             return;
         }
 
-        // If the request is complete, let the request mapper dispatch it
+        // If the request is complete, let a worker dispatch it to the request mapper
         if (currentRequest->getStatus()==HttpRequest::complete)
         {
             readTimer.stop();
-            qDebug("HttpConnectionHandler (%p): received request",this);
-
-            // Copy the Connection:close header to the response
-            HttpResponse response(socket);
-            bool closeConnection=QString::compare(currentRequest->getHeader("Connection"),"close",Qt::CaseInsensitive)==0;
-            if (closeConnection)
-            {
-                response.setHeader("Connection","close");
-            }
-
-            // In case of HTTP 1.0 protocol add the Connection:close header.
-            // This ensures that the HttpResponse does not activate chunked mode, which is not spported by HTTP 1.0.
-            else
-            {
-                bool http1_0=QString::compare(currentRequest->getVersion(),"HTTP/1.0",Qt::CaseInsensitive)==0;
-                if (http1_0)
-                {
-                    closeConnection=true;
-                    response.setHeader("Connection","close");
-                }
-            }
+            #ifdef SUPERVERBOSE
+                qDebug("HttpConnectionHandler (%p): received request",this);
+            #endif
 
-            // Call the request mapper
-            try
-            {
-                requestHandler->service(*currentRequest, response);
-            }
-            catch (...)
+            // The worker is already processing a streamed request
+            if (processing)
             {
-                qCritical("HttpConnectionHandler (%p): An uncatched exception occured in the request handler",this);
+                return;
             }
 
-            // Finalize sending the response if not already done
-            if (!response.hasSentLastPart())
+            if (serviceImmediately(currentRequest))
             {
-                response.write(QByteArray(),true);
-            }
-
-            qDebug("HttpConnectionHandler (%p): finished request",this);
-
-            // Find out whether the connection must be closed
-            if (!closeConnection)
-            {
-                // Maybe the request handler or mapper added a Connection:close header in the meantime
-                bool closeResponse=QString::compare(response.getHeaders().value("Connection"),"close",Qt::CaseInsensitive)==0;
-                if (closeResponse==true)
-                {
-                    closeConnection=true;
-                }
-                else
-                {
-                    // If we have no Content-Length header and did not use chunked mode, then we have to close the
-                    // connection to tell the HTTP client that the end of the response has been reached.
-                    bool hasContentLength=response.getHeaders().contains("Content-Length");
-                    if (!hasContentLength)
-                    {
-                        bool hasChunkedMode=QString::compare(response.getHeaders().value("Transfer-Encoding"),"chunked",Qt::CaseInsensitive)==0;
-                        if (!hasChunkedMode)
-                        {
-                            closeConnection=true;
-                        }
-                    }
-                }
+                delete currentRequest;
+                currentRequest=0;
+                answered=true;
+                continue;
             }
 
-            // Close the connection or prepare for the next request on the same connection.
-            if (closeConnection)
-            {
-                socket->flush();
-                socket->disconnectFromHost();
-            }
-            else
-            {
-                // Start timer for next request
-                int readTimeout=settings->value("readTimeout",10000).toInt();
-                readTimer.start(readTimeout);
-            }
-            delete currentRequest;
-            currentRequest=0;
+            processing=true;
+            workers->start(new RequestTask(this,currentRequest));
+            return;
         }
     }
+
+    // Start timer for next request
+    if (answered)
+    {
+        int readTimeout=settings->value("readTimeout",10000).toInt();
+        readTimer.start(readTimeout);
+    }
 }
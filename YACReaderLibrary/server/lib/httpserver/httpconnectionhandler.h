@@ -13,8 +13,13 @@
 #include <QSettings>
 #include <QTimer>
 #include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
 #include "httpglobal.h"
 #include "httprequest.h"
+#include "httpresponse.h"
 #include "httprequesthandler.h"
 
 /** Alias type definition, for compatibility to different Qt versions */
@@ -30,21 +35,41 @@
 #endif
 
 /**
-  The connection handler accepts incoming connections and dispatches incoming requests to to a
-  request mapper. Since HTTP clients can send multiple requests before waiting for the response,
-  the incoming requests are queued and processed one after the other.
+  The connection handler serves one connection. It lives in one of the I/O threads of the
+  HttpConnectionHandlerPool, where the socket events of many connections are processed by the
+  same event loop. Complete requests are dispatched to the request mapper in a worker thread.
+  Since HTTP clients can send multiple requests before waiting for the response, the incoming
+  requests are processed one after the other, so each connection uses at most one worker.
+  <p>
+  The response is passed back to the I/O thread. Workers block while more than maxPendingBytes
+  of the response are waiting to be sent, so slow clients don't fill the memory.
+  <p>
+  Requests that the request handler can answer without blocking (see
+  HttpRequestHandler::serviceImmediately()) are answered in the I/O thread, so a pipelined
+  sequence of them is answered back to back.
+  <p>
+  The body of a request with a sink (see HttpRequestHandler::createBodySink()) is passed to
+  the worker while it is received. The connection stops reading while bodyBufferSize bytes
+  are waiting for the worker, so the client is slowed down by TCP flow control instead of
+  filling the memory.
   <p>
   Example for the required configuration settings:
   <code><pre>
   readTimeout=60000
   maxRequestSize=16000
   maxMultiPartSize=1000000
+  maxPendingBytes=65536
+  bodyBufferSize=65536
+  compressionThreshold=1024
   </pre></code>
   <p>
-  The readTimeout value defines the maximum time to wait for a complete HTTP request.
+  The readTimeout value defines the maximum time to wait for a complete HTTP request, it is
+  also the time an idle keep-alive connection is kept open.
+  Text and JSON responses of at least compressionThreshold bytes are compressed if the client
+  accepts gzip or deflate, -1 disables the compression.
   @see HttpRequest for description of config settings maxRequestSize and maxMultiPartSize.
 */
-class DECLSPEC HttpConnectionHandler : public QThread {
+class DECLSPEC HttpConnectionHandler : public QObject, public HttpResponseOutput {
     Q_OBJECT
     Q_DISABLE_COPY(HttpConnectionHandler)
 
@@ -54,21 +79,33 @@ public:
       Constructor.
       @param settings Configuration settings of the HTTP webserver
       @param requestHandler Handler that will process each incoming HTTP request
+      @param workers Thread pool where the requests are processed
       @param sslConfiguration SSL (HTTPS) will be used if not NULL
     */
-    HttpConnectionHandler(QSettings* settings, HttpRequestHandler* requestHandler, QSslConfiguration* sslConfiguration=NULL);
+    HttpConnectionHandler(QSettings* settings, HttpRequestHandler* requestHandler, QThreadPool* workers, QSslConfiguration* sslConfiguration=NULL);
 
     /** Destructor */
     virtual ~HttpConnectionHandler();
 
-    /** Returns true, if this handler is in use. */
-    bool isBusy();
+    /** Write response data, called by the worker thread */
+    bool write(const QByteArray& data);
 
-    /** Mark this handler as busy */
-    void setBusy();
+    /** Flush the response data, called by the worker thread */
+    void flush();
+
+    /** Returns false if the connection has been lost, called by the worker thread */
+    bool isConnected() const;
+
+    /** Number of connection handlers (open connections) in the process */
+    static int getConnectionCount();
 
 private:
 
+    /** Number of connection handlers */
+    static QAtomicInt connectionCount;
+
+    class RequestTask;
+
     /** Configuration settings */
     QSettings* settings;
 
@@ -84,18 +121,45 @@ private:
     /** Dispatches received requests to services */
     HttpRequestHandler* requestHandler;
 
-    /** This shows the busy-state from a very early time */
-    bool busy;
+    /** Thread pool where the requests are processed */
+    QThreadPool* workers;
 
     /** Configuration for SSL */
     QSslConfiguration* sslConfiguration;
 
-    /** Executes the threads own event loop */
-    void run();
+    /** True while the current request is processed by a worker */
+    bool processing;
+
+    /** Response data sent by the worker that has not been passed to the socket yet */
+    qint64 queuedBytes;
+
+    /** Response data in the output buffer of the socket */
+    qint64 bufferedBytes;
+
+    /** Maximum of response data waiting to be written */
+    qint64 maxPendingBytes;
+
+    /** Maximum of streamed request body data waiting for the worker */
+    int bodyBufferSize;
+
+    /** True when the connection has been closed */
+    bool closed;
+
+    /** Used to synchronize the worker with the I/O thread */
+    mutable QMutex outputMutex;
+
+    /** Wakes up the worker when the pending data has been written */
+    QWaitCondition outputWritten;
 
     /**  Create SSL or TCP socket */
     void createSocket();
 
+    /**
+      Let the request handler answer the request in the I/O thread.
+      @return false if the request must be processed by a worker
+    */
+    bool serviceImmediately(HttpRequest* request);
+
 public slots:
 
     /**
@@ -115,6 +179,18 @@ private slots:
     /** Received from the socket when a connection has been closed */
     void disconnected();
 
+    /** Received from the socket when data has been written */
+    void bytesWritten();
+
+    /** Received from the worker with response data */
+    void writeData(QByteArray data);
+
+    /** Received from the worker to flush the response */
+    void flushData();
+
+    /** Received from the worker when the request has been processed */
+    void requestFinished(bool closeConnection);
+
 };
 
 #endif // HTTPCONNECTIONHANDLER_H
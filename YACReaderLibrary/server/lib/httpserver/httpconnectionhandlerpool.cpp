@@ -15,18 +15,39 @@ HttpConnectionHandlerPool::HttpConnectionHandlerPool(QSettings* settings, HttpRe
     this->requestHandler=requestHandler;
     this->sslConfiguration=NULL;
     loadSslConfig();
-    cleanupTimer.start(settings->value("cleanupInterval",1000).toInt());
-    connect(&cleanupTimer, SIGNAL(timeout()), SLOT(cleanup()));
+
+    maxConnections=settings->value("maxConnections",1000).toInt();
+    workers.setMaxThreadCount(qMax(1,settings->value("workerThreads",16).toInt()));
+
+    int ioThreadCount=qMax(1,settings->value("ioThreads",2).toInt());
+    for (int i=0; i<ioThreadCount; i++)
+    {
+        QThread* thread=new QThread();
+        thread->start();
+        ioThreads.append(thread);
+    }
+    nextIoThread=0;
 }
 
 
 HttpConnectionHandlerPool::~HttpConnectionHandlerPool()
 {
-    // delete all connection handlers and wait until their threads are closed
-    foreach(HttpConnectionHandler* handler, pool)
+    // wait until the running requests are processed
+    workers.waitForDone();
+
+    // stop the event loops and delete the connection handlers that are still alive
+    foreach(QThread* thread, ioThreads)
     {
-       delete handler;
+        thread->quit();
+        thread->wait();
     }
+
+    mutex.lock();
+    QList<QObject*> remaining=handlers.toList();
+    mutex.unlock();
+    qDeleteAll(remaining);
+
+    qDeleteAll(ioThreads);
     delete sslConfiguration;
     qDebug("HttpConnectionHandlerPool (%p): destroyed", this);
 }
@@ -34,52 +55,28 @@ HttpConnectionHandlerPool::~HttpConnectionHandlerPool()
 
 HttpConnectionHandler* HttpConnectionHandlerPool::getConnectionHandler()
 {
-    HttpConnectionHandler* freeHandler=0;
+    HttpConnectionHandler* handler=0;
     mutex.lock();
-    // find a free handler in pool
-    foreach(HttpConnectionHandler* handler, pool)
-    {
-        if (!handler->isBusy())
-        {
-            freeHandler=handler;
-            freeHandler->setBusy();
-            break;
-        }
-    }
-    // create a new handler, if necessary
-    if (!freeHandler)
+    if (handlers.count()<maxConnections)
     {
-        int maxConnectionHandlers=settings->value("maxThreads",100).toInt();
-        if (pool.count()<maxConnectionHandlers)
-        {
-            freeHandler=new HttpConnectionHandler(settings,requestHandler,sslConfiguration);
-            freeHandler->setBusy();
-            pool.append(freeHandler);
-        }
+        handler=new HttpConnectionHandler(settings,requestHandler,&workers,sslConfiguration);
+        connect(handler, SIGNAL(destroyed(QObject*)), SLOT(handlerDestroyed(QObject*)), Qt::DirectConnection);
+        handlers.insert(handler);
+
+        // the connections are distributed between the I/O threads
+        QThread* thread=ioThreads.at(nextIoThread);
+        nextIoThread=(nextIoThread+1)%ioThreads.count();
+        handler->moveToThread(thread);
     }
     mutex.unlock();
-    return freeHandler;
+    return handler;
 }
 
 
-void HttpConnectionHandlerPool::cleanup()
+void HttpConnectionHandlerPool::handlerDestroyed(QObject* handler)
 {
-    int maxIdleHandlers=settings->value("minThreads",1).toInt();
-    int idleCounter=0;
     mutex.lock();
-    foreach(HttpConnectionHandler* handler, pool)
-    {
-        if (!handler->isBusy())
-        {
-            if (++idleCounter > maxIdleHandlers)
-            {
-                delete handler;
-                pool.removeOne(handler);
-                qDebug("HttpConnectionHandlerPool: Removed connection handler (%p), pool size is now %i",handler,pool.size());
-                break; // remove only one handler in each interval
-            }
-        }
-    }
+    handlers.remove(handler);
     mutex.unlock();
 }
 
@@ -2,31 +2,32 @@
 #define HTTPCONNECTIONHANDLERPOOL_H
 
 #include <QList>
-#include <QTimer>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
 #include <QObject>
 #include <QMutex>
 #include "httpglobal.h"
 #include "httpconnectionhandler.h"
 
 /**
-  Pool of http connection handlers. The size of the pool grows and
-  shrinks on demand.
+  Pool of http connection handlers. The connections are served by a fixed number of I/O
+  threads, each one multiplexes the sockets of many connections in its event loop. The
+  requests are processed by a bounded pool of worker threads, a connection never has more
+  than one request in the workers, so a single client can't take all of them.
   <p>
   Example for the required configuration settings:
   <code><pre>
-  minThreads=4
-  maxThreads=100
-  cleanupInterval=60000
+  ioThreads=2
+  workerThreads=16
+  maxConnections=1000
   readTimeout=60000
   ;sslKeyFile=ssl/my.key
   ;sslCertFile=ssl/my.cert
   maxRequestSize=16000
   maxMultiPartSize=1000000
   </pre></code>
-  After server start, the size of the thread pool is always 0. Threads
-  are started on demand when requests come in. The cleanup timer reduces
-  the number of idle threads slowly by closing one thread in each interval.
-  But the configured minimum number of threads are kept running.
+  New connections are rejected when there are already maxConnections.
   <p>
   For SSL support, you need an OpenSSL certificate file and a key file.
   Both can be created with the command
@@ -59,7 +60,7 @@ public:
     /** Destructor */
     virtual ~HttpConnectionHandlerPool();
 
-    /** Get a free connection handler, or 0 if not available. */
+    /** Get a connection handler for a new connection, or 0 if there are too many connections. */
     HttpConnectionHandler* getConnectionHandler();
 
 private:
@@ -70,11 +71,20 @@ private:
     /** Will be assigned to each Connectionhandler during their creation */
     HttpRequestHandler* requestHandler;
 
-    /** Pool of connection handlers */
-    QList<HttpConnectionHandler*> pool;
+    /** Threads running the event loops of the connections */
+    QList<QThread*> ioThreads;
 
-    /** Timer to clean-up unused connection handler */
-    QTimer cleanupTimer;
+    /** I/O thread for the next connection */
+    int nextIoThread;
+
+    /** Threads processing the requests */
+    QThreadPool workers;
+
+    /** Live connection handlers */
+    QSet<QObject*> handlers;
+
+    /** Maximum number of live connections */
+    int maxConnections;
 
     /** Used to synchronize threads */
     QMutex mutex;
@@ -87,8 +97,8 @@ private:
 
 private slots:
 
-    /** Received from the clean-up timer.  */
-    void cleanup();
+    /** Received from a connection handler when it is deleted */
+    void handlerDestroyed(QObject* handler);
 
 };
 
@@ -22,9 +22,9 @@
   <code><pre>
   ;host=192.168.0.100
   port=8080
-  minThreads=1
-  maxThreads=10
-  cleanupInterval=1000
+  ioThreads=2
+  workerThreads=16
+  maxConnections=1000
   readTimeout=60000
   ;sslKeyFile=ssl/my.key
   ;sslCertFile=ssl/my.cert
@@ -34,7 +34,7 @@
   The optional host parameter binds the listener to one network interface.
   The listener handles all network interfaces if no host is configured.
   The port number specifies the incoming TCP port that this listener listens to.
-  @see HttpConnectionHandlerPool for description of config settings minThreads, maxThreads, cleanupInterval and ssl settings
+  @see HttpConnectionHandlerPool for description of config settings ioThreads, workerThreads, maxConnections and ssl settings
   @see HttpConnectionHandler for description of the readTimeout
   @see HttpRequest for description of config settings maxRequestSize and maxMultiPartSize
 */
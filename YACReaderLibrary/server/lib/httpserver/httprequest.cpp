@@ -7,14 +7,19 @@
 #include <QList>
 #include <QDir>
 #include "httpcookie.h"
+#include "httprequesthandler.h"
 
-HttpRequest::HttpRequest(QSettings* settings)
+HttpRequest::HttpRequest(QSettings* settings, HttpRequestHandler* requestHandler)
 {
     status=waitForRequest;
     currentSize=0;
     expectedBodySize=0;
+    receivedBodySize=0;
+    bodySink=0;
+    this->requestHandler=requestHandler;
     maxSize=settings->value("maxRequestSize","16000").toInt();
     maxMultiPartSize=settings->value("maxMultiPartSize","1000000").toInt();
+    bodyBufferSize=settings->value("bodyBufferSize","65536").toInt();
 }
 
 void HttpRequest::readRequest(QTcpSocket* socket)
@@ -114,7 +119,14 @@ void HttpRequest::readHeader(QTcpSocket* socket)
         QByteArray contentLength=headers.value("content-length");
         if (!contentLength.isEmpty())
         {
-            expectedBodySize=contentLength.toInt();
+            expectedBodySize=contentLength.toLongLong();
+        }
+        // The parameters of the URL are available to the request handler that decides where the body goes
+        decodeRequestParams();
+        extractCookies();
+        if (expectedBodySize>0 && requestHandler)
+        {
+            bodySink=requestHandler->createBodySink(*this);
         }
         if (expectedBodySize==0)
         {
@@ -123,6 +135,13 @@ void HttpRequest::readHeader(QTcpSocket* socket)
             #endif
             status=complete;
         }
+        else if (bodySink)
+        {
+            #ifdef SUPERVERBOSE
+                qDebug("HttpRequest: stream %lli bytes body",expectedBodySize);
+            #endif
+            status=waitForBody;
+        }
         else if (boundary.isEmpty() && expectedBodySize+currentSize>maxSize)
         {
             qWarning("HttpRequest: expected body is too large");
@@ -135,7 +154,7 @@ void HttpRequest::readHeader(QTcpSocket* socket)
         }
         else {
             #ifdef SUPERVERBOSE
-                qDebug("HttpRequest: expect %i bytes body",expectedBodySize);
+                qDebug("HttpRequest: expect %lli bytes body",expectedBodySize);
             #endif
             status=waitForBody;
         }
@@ -145,13 +164,31 @@ void HttpRequest::readHeader(QTcpSocket* socket)
 void HttpRequest::readBody(QTcpSocket* socket)
 {
     Q_ASSERT(expectedBodySize!=0);
-    if (boundary.isEmpty())
+    if (bodySink)
+    {
+        // streamed body, the worker takes it from the buffer
+        QMutexLocker locker(&bodyMutex);
+        qint64 toRead=qMin(expectedBodySize-receivedBodySize,(qint64) (bodyBufferSize-bodyBuffer.size()));
+        if (toRead<=0)
+        {
+            return;
+        }
+        QByteArray newData=socket->read(toRead);
+        receivedBodySize+=newData.size();
+        bodyBuffer.append(newData);
+        if (receivedBodySize>=expectedBodySize)
+        {
+            status=complete;
+        }
+        bodyReceived.wakeAll();
+    }
+    else if (boundary.isEmpty())
     {
         // normal body, no multipart
         #ifdef SUPERVERBOSE
             qDebug("HttpRequest: receive body");
         #endif
-        int toRead=expectedBodySize-bodyData.size();
+        qint64 toRead=expectedBodySize-bodyData.size();
         QByteArray newData=socket->read(toRead);
         currentSize+=newData.size();
         bodyData.append(newData);
@@ -171,8 +208,8 @@ void HttpRequest::readBody(QTcpSocket* socket)
             tempFile.open();
         }
         // Transfer data in 64kb blocks
-        int fileSize=tempFile.size();
-        int toRead=expectedBodySize-fileSize;
+        qint64 fileSize=tempFile.size();
+        qint64 toRead=expectedBodySize-fileSize;
         if (toRead>65536)
         {
             toRead=65536;
@@ -206,27 +243,29 @@ void HttpRequest::decodeRequestParams()
         qDebug("HttpRequest: extract and decode request parameters");
     #endif
     // Get URL parameters
-    QByteArray rawParameters;
     int questionMark=path.indexOf('?');
     if (questionMark>=0)
     {
-        rawParameters=path.mid(questionMark+1);
+        decodeParams(path.mid(questionMark+1));
         path=path.left(questionMark);
     }
+}
+
+void HttpRequest::decodeBodyParams()
+{
     // Get request body parameters
     QByteArray contentType=headers.value("content-type");
     if (!bodyData.isEmpty() && (contentType.isEmpty() || contentType.startsWith("application/x-www-form-urlencoded")))
     {
-        if (!rawParameters.isEmpty())
-        {
-            rawParameters.append('&');
-            rawParameters.append(bodyData);
-        }
-        else
-        {
-            rawParameters=bodyData;
-        }
+        #ifdef SUPERVERBOSE
+            qDebug("HttpRequest: decode body parameters");
+        #endif
+        decodeParams(bodyData);
     }
+}
+
+void HttpRequest::decodeParams(const QByteArray& rawParameters)
+{
     // Split the parameters into pairs of value and name
     QList<QByteArray> list=rawParameters.split('&');
     foreach (QByteArray part, list)
@@ -300,10 +339,9 @@ void HttpRequest::readFromSocket(QTcpSocket* socket)
     }
     if (status==complete)
     {
-        // Extract and decode request parameters from url and body
-        decodeRequestParams();
-        // Extract cookies from headers
-        extractCookies();
+        // Extract and decode request parameters from the body, the URL and the cookies
+        // have been decoded when the headers were complete
+        decodeBodyParams();
     }
 }
 
@@ -368,11 +406,62 @@ QMultiMap<QByteArray,QByteArray> HttpRequest::getParameterMap() const
     return parameters;
 }
 
+QVariant HttpRequest::getPathParameter(const QByteArray& name) const
+{
+    return pathParameters.value(name);
+}
+
+void HttpRequest::setPathParameter(const QByteArray& name, const QVariant& value)
+{
+    pathParameters.insert(name,value);
+}
+
 QByteArray HttpRequest::getBody() const
 {
     return bodyData;
 }
 
+HttpRequestBodySink* HttpRequest::getBodySink() const
+{
+    return bodySink;
+}
+
+bool HttpRequest::takeBodyData(QByteArray& data)
+{
+    QMutexLocker locker(&bodyMutex);
+    while (bodyBuffer.isEmpty() && status==waitForBody)
+    {
+        bodyReceived.wait(&bodyMutex);
+    }
+    if (status==abort)
+    {
+        return false;
+    }
+    data=bodyBuffer;
+    bodyBuffer.clear();
+    return !data.isEmpty();
+}
+
+bool HttpRequest::isBodyBufferFull() const
+{
+    if (!bodySink)
+    {
+        return false;
+    }
+    QMutexLocker locker(&bodyMutex);
+    return bodyBuffer.size()>=bodyBufferSize;
+}
+
+void HttpRequest::abortBody()
+{
+    QMutexLocker locker(&bodyMutex);
+    if (status==waitForBody)
+    {
+        status=abort;
+        bodyReceived.wakeAll();
+    }
+}
+
 QByteArray HttpRequest::urlDecode(const QByteArray source)
 {
     QByteArray buffer(source);
@@ -520,6 +609,7 @@ void HttpRequest::parseMultiPartFile()
 
 HttpRequest::~HttpRequest()
 {
+    delete bodySink;
     foreach(QByteArray key, uploadedFiles.keys())
     {
         QTemporaryFile* file=uploadedFiles.value(key);
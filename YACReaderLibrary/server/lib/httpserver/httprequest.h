@@ -11,11 +11,33 @@
 #include <QTcpSocket>
 #include <QMap>
 #include <QMultiMap>
+#include <QMutex>
 #include <QSettings>
 #include <QTemporaryFile>
 #include <QUuid>
+#include <QVariant>
+#include <QWaitCondition>
 #include "httpglobal.h"
 
+class HttpRequestHandler;
+
+/**
+  Destination of a streamed request body, see HttpRequestHandler::createBodySink().
+*/
+
+class DECLSPEC HttpRequestBodySink {
+public:
+
+    virtual ~HttpRequestBodySink() {}
+
+    /**
+      Receive the next part of the body, called by the worker thread of the request.
+      The connection stops reading from the client until this method returns.
+      @return false to reject the rest of the body
+    */
+    virtual bool write(const QByteArray& data)=0;
+};
+
 /**
   This object represents a single HTTP request. It reads the request
   from a TCP socket and provides getters for the individual parts
@@ -25,12 +47,17 @@
   <code><pre>
   maxRequestSize=16000
   maxMultiPartSize=1000000
+  bodyBufferSize=65536
   </pre></code>
   <p>
   MaxRequestSize is the maximum size of a HTTP request. In case of
   multipart/form-data requests (also known as file-upload), the maximum
   size of the body must not exceed maxMultiPartSize.
   The body is always a little larger than the file itself.
+  <p>
+  The body of a request whose sink has been created by the request handler is not
+  limited by these sizes. It is passed to the sink in parts while it is received,
+  at most bodyBufferSize bytes are kept in memory.
 */
 
 class DECLSPEC HttpRequest {
@@ -45,8 +72,9 @@ public:
     /**
       Constructor.
       @param settings Configuration settings
+      @param requestHandler Asked for a sink when the headers have been received, may be NULL
     */
-    HttpRequest(QSettings* settings);
+    HttpRequest(QSettings* settings, HttpRequestHandler* requestHandler=NULL);
 
     /**
       Destructor.
@@ -116,9 +144,38 @@ public:
     /** Get all HTTP request parameters. */
     QMultiMap<QByteArray,QByteArray> getParameterMap() const;
 
-    /** Get the HTTP request body.  */
+    /**
+      Get a parameter taken from the path by the request handler, e.g. an id.
+      @param name Name of the parameter, case-sensitive.
+      @return An invalid QVariant if the parameter has not been set.
+    */
+    QVariant getPathParameter(const QByteArray& name) const;
+
+    /**
+      Set a parameter taken from the path, the request handler calls this
+      method while it finds the controller for the request.
+    */
+    void setPathParameter(const QByteArray& name, const QVariant& value);
+
+    /** Get the HTTP request body. It is empty if the body has been passed to a sink. */
     QByteArray getBody() const;
 
+    /** Get the sink of a streamed body, or NULL if the body is stored in memory. */
+    HttpRequestBodySink* getBodySink() const;
+
+    /**
+      Take the received part of a streamed body, called by the worker thread.
+      Blocks until data is available.
+      @return false when the whole body has been taken or the request has been aborted
+    */
+    bool takeBodyData(QByteArray& data);
+
+    /** Returns true while the received part of a streamed body fills the buffer */
+    bool isBodyBufferFull() const;
+
+    /** Abort the request while a streamed body is received, e.g. when the connection has been lost */
+    void abortBody();
+
     /**
       Decode an URL parameter.
       E.g. replace "%23" by '#' and replace '+' by ' '.
@@ -161,6 +218,9 @@ private:
     /** Parameters of the request */
     QMultiMap<QByteArray,QByteArray> parameters;
 
+    /** Parameters taken from the path */
+    QMap<QByteArray,QVariant> pathParameters;
+
     /** Uploaded files of the request, key is the field name. */
     QMap<QByteArray,QTemporaryFile*> uploadedFiles;
 
@@ -198,7 +258,28 @@ private:
     int currentSize;
 
     /** Expected size of body */
-    int expectedBodySize;
+    qint64 expectedBodySize;
+
+    /** Asked for a sink of the body, may be NULL */
+    HttpRequestHandler* requestHandler;
+
+    /** Receives the body instead of bodyData, NULL if the body is stored in memory */
+    HttpRequestBodySink* bodySink;
+
+    /** Received part of a streamed body that the worker has not taken yet */
+    QByteArray bodyBuffer;
+
+    /** Maximum size of bodyBuffer */
+    int bodyBufferSize;
+
+    /** Size of the streamed body received so far */
+    qint64 receivedBodySize;
+
+    /** Synchronizes the worker with the I/O thread while a streamed body is received */
+    mutable QMutex bodyMutex;
+
+    /** Wakes up the worker when a part of a streamed body has been received */
+    QWaitCondition bodyReceived;
 
     /** Name of the current header, or empty if no header is being processed */
     QByteArray currentHeader;
@@ -221,9 +302,15 @@ private:
     /** Sub-procedure of readFromSocket(), read the request body. */
     void readBody(QTcpSocket* socket);
 
-    /** Sub-procedure of readFromSocket(), extract and decode request parameters. */
+    /** Sub-procedure of readFromSocket(), extract and decode the parameters of the URL. */
     void decodeRequestParams();
 
+    /** Sub-procedure of readFromSocket(), decode the parameters of a form sent in the body. */
+    void decodeBodyParams();
+
+    /** Split parameters into pairs of name and value */
+    void decodeParams(const QByteArray& rawParameters);
+
     /** Sub-procedure of readFromSocket(), extract cookies from headers */
     void extractCookies();
 
@@ -19,3 +19,16 @@ void HttpRequestHandler::service(HttpRequest& request, HttpResponse& response)
     response.setStatus(501,"not implemented");
     response.write("501 not implemented",true);
 }
+
+bool HttpRequestHandler::serviceImmediately(HttpRequest& request, HttpResponse& response)
+{
+    Q_UNUSED(request);
+    Q_UNUSED(response);
+    return false;
+}
+
+HttpRequestBodySink* HttpRequestHandler::createBodySink(HttpRequest& request)
+{
+    Q_UNUSED(request);
+    return NULL;
+}
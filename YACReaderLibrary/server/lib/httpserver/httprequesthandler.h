@@ -44,6 +44,33 @@ public:
     */
     virtual void service(HttpRequest& request, HttpResponse& response);
 
+    /**
+      Generate the response of a request that can be answered without blocking, e.g. from
+      data cached in memory. It is called in the I/O thread of the connection before the
+      request is passed to a worker, so pipelined requests answered here are sent back to
+      back without waiting for a worker. The default implementation returns false.
+      @param request The received HTTP request
+      @param response Must be used to return the response, only if the method returns true
+      @return false if the request must be processed by service()
+      @warning This method must be thread safe and it must not block
+    */
+    virtual bool serviceImmediately(HttpRequest& request, HttpResponse& response);
+
+    /**
+      Create the sink of a request body that shall be processed while it is received
+      instead of being stored in memory, e.g. large uploads. It is called in the I/O thread
+      when the headers (and the parameters of the URL) have been received. The sink is
+      owned by the request and it is fed by the worker thread that calls service() after
+      the last part of the body, so the client is slowed down to the pace of the sink.
+      The body is not limited by maxRequestSize. If the sink rejects a part of the body,
+      service() is called without the rest of it and the connection is closed after the
+      response. The default implementation returns NULL.
+      @param request The request, without the body
+      @return NULL if the body shall be stored in memory
+      @warning This method must be thread safe and it must not block
+    */
+    virtual HttpRequestBodySink* createBodySink(HttpRequest& request);
+
 };
 
 #endif // HTTPREQUESTHANDLER_H
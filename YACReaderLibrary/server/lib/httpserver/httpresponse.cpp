@@ -4,15 +4,148 @@
 */
 
 #include "httpresponse.h"
+#include <zlib.h>
 
-HttpResponse::HttpResponse(QTcpSocket* socket)
+HttpResponse::HttpResponse(HttpResponseOutput* output)
 {
-    this->socket=socket;
+    this->output=output;
     statusCode=200;
     statusText="OK";
     sentHeaders=false;
     sentLastPart=false;
     chunkedMode=false;
+    bodyBytes=0;
+    compressionThreshold=0;
+    compressor=NULL;
+}
+
+HttpResponse::~HttpResponse()
+{
+    if (compressor)
+    {
+        deflateEnd(compressor);
+        delete compressor;
+    }
+}
+
+void HttpResponse::enableCompression(const QByteArray& acceptEncoding, int threshold)
+{
+    Q_ASSERT(sentHeaders==false);
+    acceptedEncoding.clear();
+    compressionThreshold=threshold;
+
+    // Prefer gzip, skip the codings disabled with q=0. The * entry only applies
+    // to the codings that are not listed.
+    bool gzip=false;
+    bool gzipListed=false;
+    bool deflate=false;
+    bool deflateListed=false;
+    bool any=false;
+    foreach(QByteArray coding, acceptEncoding.split(','))
+    {
+        QList<QByteArray> parameters=coding.split(';');
+        QByteArray name=parameters.at(0).trimmed().toLower();
+        bool accepted=true;
+        for (int i=1; i<parameters.size(); i++)
+        {
+            QByteArray parameter=parameters.at(i).trimmed();
+            if (parameter.startsWith("q=") && parameter.mid(2).toDouble()<=0)
+            {
+                accepted=false;
+            }
+        }
+        if (name=="gzip")
+        {
+            gzip=accepted;
+            gzipListed=true;
+        }
+        else if (name=="deflate")
+        {
+            deflate=accepted;
+            deflateListed=true;
+        }
+        else if (name=="*")
+        {
+            any=accepted;
+        }
+    }
+    if (!gzipListed)
+    {
+        gzip=any;
+    }
+    if (!deflateListed)
+    {
+        deflate=any;
+    }
+    if (gzip)
+    {
+        acceptedEncoding="gzip";
+    }
+    else if (deflate)
+    {
+        acceptedEncoding="deflate";
+    }
+}
+
+bool HttpResponse::startCompression(const QByteArray& data, bool lastPart)
+{
+    if (acceptedEncoding.isEmpty() || !hasBody() || statusCode==206)
+    {
+        return false;
+    }
+    if (headers.contains("Content-Encoding") || (lastPart && data.size()<compressionThreshold))
+    {
+        return false;
+    }
+    // A streamed body with a known length is sent as it is (file downloads, ranges)
+    if (!lastPart && headers.contains("Content-Length"))
+    {
+        return false;
+    }
+    QByteArray contentType=headers.value("Content-Type",headers.value("content-type")).toLower();
+    bool text=contentType.startsWith("text/") || contentType.contains("json") || contentType.contains("javascript") || contentType.contains("xml");
+    if (!text)
+    {
+        return false;
+    }
+
+    compressor=new z_stream;
+    compressor->zalloc=Z_NULL;
+    compressor->zfree=Z_NULL;
+    compressor->opaque=Z_NULL;
+    // windowBits+16 writes a gzip header and trailer instead of the zlib ones
+    int windowBits=acceptedEncoding=="gzip" ? MAX_WBITS+16 : MAX_WBITS;
+    if (deflateInit2(compressor,Z_DEFAULT_COMPRESSION,Z_DEFLATED,windowBits,8,Z_DEFAULT_STRATEGY)!=Z_OK)
+    {
+        qWarning("HttpResponse: cannot initialize the compression");
+        delete compressor;
+        compressor=NULL;
+        return false;
+    }
+
+    // The length of the body is not known until it has been compressed
+    headers.remove("Content-Length");
+    headers.insert("Content-Encoding",acceptedEncoding);
+    headers.insert("Vary","Accept-Encoding");
+    return true;
+}
+
+QByteArray HttpResponse::compress(const QByteArray& data, bool lastPart)
+{
+    QByteArray result;
+    char buffer[16384];
+    compressor->next_in=(Bytef*)data.constData();
+    compressor->avail_in=data.size();
+    int flush=lastPart ? Z_FINISH : Z_NO_FLUSH;
+    do
+    {
+        compressor->next_out=(Bytef*)buffer;
+        compressor->avail_out=sizeof(buffer);
+        deflate(compressor,flush);
+        result.append(buffer,sizeof(buffer)-compressor->avail_out);
+    }
+    while (compressor->avail_out==0);
+    return result;
 }
 
 void HttpResponse::setHeader(QByteArray name, QByteArray value)
@@ -43,6 +176,11 @@ int HttpResponse::getStatusCode() const
    return this->statusCode;
 }
 
+bool HttpResponse::hasBody() const
+{
+    return statusCode>=200 && statusCode!=204 && statusCode!=304;
+}
+
 void HttpResponse::writeHeaders()
 {
     Q_ASSERT(sentHeaders==false);
@@ -66,31 +204,13 @@ void HttpResponse::writeHeaders()
         buffer.append("\r\n");
     }
     buffer.append("\r\n");
-    writeToSocket(buffer);
+    writeToOutput(buffer);
     sentHeaders=true;
 }
 
-bool HttpResponse::writeToSocket(QByteArray data)
+bool HttpResponse::writeToOutput(QByteArray data)
 {
-    int remaining=data.size();
-    char* ptr=data.data();
-    while (socket->isOpen() && remaining>0)
-    {
-        // If the output buffer has become large, then wait until it has been sent.
-        if (socket->bytesToWrite()>16384)
-        {
-            socket->waitForBytesWritten(-1);
-        }
-
-        int written=socket->write(ptr,remaining);
-        if (written==-1)
-        {
-          return false;
-        }
-        ptr+=written;
-        remaining-=written;
-    }
-    return true;
+    return output->write(data);
 }
 
 void HttpResponse::write(QByteArray data, bool lastPart)
@@ -98,18 +218,31 @@ void HttpResponse::write(QByteArray data, bool lastPart)
     Q_ASSERT(sentLastPart==false);
 
     // Send HTTP headers, if not already done (that happens only on the first call to write())
+    bool compressed=false;
     if (sentHeaders==false)
     {
+        // A single part body is compressed before the Content-Length is set
+        if (startCompression(data,lastPart) && lastPart)
+        {
+            data=compress(data,true);
+            compressed=true;
+        }
+
         // If the whole response is generated with a single call to write(), then we know the total
         // size of the response and therefore can set the Content-Length header automatically.
-        if (lastPart)
+        // Responses without a body, e.g. 304 Not Modified, have neither Content-Length nor chunks.
+        if (!hasBody())
+        {
+            headers.remove("Content-Length");
+        }
+        else if (lastPart)
         {
            // Automatically set the Content-Length header
            headers.insert("Content-Length",QByteArray::number(data.size()));
         }
 
-        // else if we will not close the connection at the end, them we must use the chunked mode.
-        else
+        // else if the length is unknown and we will not close the connection at the end, them we must use the chunked mode.
+        else if (!headers.contains("Content-Length"))
         {
             QByteArray connectionValue=headers.value("Connection",headers.value("connection"));
             bool connectionClose=QString::compare(connectionValue,"close",Qt::CaseInsensitive)==0;
@@ -123,23 +256,30 @@ void HttpResponse::write(QByteArray data, bool lastPart)
         writeHeaders();
     }
 
+    // Compress the parts of a streamed body, the end of the stream is sent with the last one
+    if (compressor && !compressed)
+    {
+        data=compress(data,lastPart);
+    }
+
     // Send data
     if (data.size()>0)
     {
+        bodyBytes+=data.size();
         if (chunkedMode)
         {
             if (data.size()>0)
             {
                 QByteArray size=QByteArray::number(data.size(),16);
-                writeToSocket(size);
-                writeToSocket("\r\n");
-                writeToSocket(data);
-                writeToSocket("\r\n");
+                writeToOutput(size);
+                writeToOutput("\r\n");
+                writeToOutput(data);
+                writeToOutput("\r\n");
             }
         }
         else
         {
-            writeToSocket(data);
+            writeToOutput(data);
         }
     }
 
@@ -148,9 +288,9 @@ void HttpResponse::write(QByteArray data, bool lastPart)
     {
         if (chunkedMode)
         {
-            writeToSocket("0\r\n\r\n");
+            writeToOutput("0\r\n\r\n");
         }
-        socket->flush();
+        output->flush();
         sentLastPart=true;
     }
 }
@@ -162,6 +302,12 @@ bool HttpResponse::hasSentLastPart() const
 }
 
 
+qint64 HttpResponse::getBodyBytes() const
+{
+    return bodyBytes;
+}
+
+
 void HttpResponse::setCookie(const HttpCookie& cookie)
 {
     Q_ASSERT(sentHeaders==false);
@@ -188,11 +334,11 @@ void HttpResponse::redirect(const QByteArray& url)
 
 void HttpResponse::flush()
 {
-    socket->flush();
+    output->flush();
 }
 
 
 bool HttpResponse::isConnected() const
 {
-    return socket->isOpen();
+    return output->isConnected();
 }
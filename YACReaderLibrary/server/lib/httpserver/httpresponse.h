@@ -12,6 +12,30 @@
 #include "httpglobal.h"
 #include "httpcookie.h"
 
+struct z_stream_s;
+
+/**
+  Destination of the bytes of a HttpResponse, usually the connection handler of the client.
+*/
+
+class DECLSPEC HttpResponseOutput {
+public:
+
+    virtual ~HttpResponseOutput() {}
+
+    /**
+      Write data to the client. This method blocks while too much data is waiting to be sent.
+      @return false if the connection has been lost
+    */
+    virtual bool write(const QByteArray& data)=0;
+
+    /** Send the buffered data as soon as possible */
+    virtual void flush()=0;
+
+    /** Returns false if the connection to the client has been lost */
+    virtual bool isConnected() const=0;
+};
+
 /**
   This object represents a HTTP response, used to return something to the web client.
   <p>
@@ -28,7 +52,12 @@
   </pre></code>
   <p>
   In case of large responses (e.g. file downloads), a Content-Length header should be set
-  before calling write(). Web Browsers use that information to display a progress bar.
+  before calling write(). Web Browsers use that information to display a progress bar,
+  and the body is not sent in chunked mode.
+  <p>
+  Text and JSON bodies are compressed with gzip or deflate if the client accepts it
+  (see enableCompression()). Responses written in several parts are compressed as a
+  stream and sent in chunked mode.
 */
 
 class DECLSPEC HttpResponse {
@@ -37,9 +66,20 @@ public:
 
     /**
       Constructor.
-      @param socket used to write the response
+      @param output used to write the response
     */
-    HttpResponse(QTcpSocket* socket);
+    HttpResponse(HttpResponseOutput* output);
+
+    /** Destructor */
+    ~HttpResponse();
+
+    /**
+      Compress the body if the client accepts it and the Content-Type is text or JSON.
+      You must call this method before the first write().
+      @param acceptEncoding value of the Accept-Encoding header of the request
+      @param threshold bodies written with a single write() smaller than this are not compressed
+    */
+    void enableCompression(const QByteArray& acceptEncoding, int threshold);
 
     /**
       Set a HTTP response header.
@@ -72,13 +112,17 @@ public:
     /** Return the status code. */
     int getStatusCode() const;
 
+    /** Returns false if the status code does not allow a body (1xx, 204 and 304). */
+    bool hasBody() const;
+
     /**
       Write body data to the socket.
       <p>
       The HTTP status line, headers and cookies are sent automatically before the body.
       <p>
       If the response contains only a single chunk (indicated by lastPart=true),
-      then a Content-Length header is automatically set.
+      then a Content-Length header is automatically set, unless the status code
+      does not allow a body.
       <p>
       Chunked mode is automatically selected if there is no Content-Length header
       and also no Connection:close header.
@@ -92,6 +136,9 @@ public:
     */
     bool hasSentLastPart() const;
 
+    /** Number of body bytes written so far, after compression and without the chunk framing */
+    qint64 getBodyBytes() const;
+
     /**
       Set a cookie.
       You must call this method before the first write().
@@ -123,8 +170,8 @@ private:
     /** Request headers */
     QMap<QByteArray,QByteArray> headers;
 
-    /** Socket for writing output */
-    QTcpSocket* socket;
+    /** Destination for writing output */
+    HttpResponseOutput* output;
 
     /** HTTP status code*/
     int statusCode;
@@ -141,11 +188,29 @@ private:
     /** Whether the response is sent in chunked mode */
     bool chunkedMode;
 
+    /** Body bytes written */
+    qint64 bodyBytes;
+
     /** Cookies */
     QMap<QByteArray,HttpCookie> cookies;
 
-    /** Write raw data to the socket. This method blocks until all bytes have been passed to the TCP buffer */
-    bool writeToSocket(QByteArray data);
+    /** Content encoding accepted by the client (gzip or deflate), empty if none */
+    QByteArray acceptedEncoding;
+
+    /** Minimum size of the body for compression */
+    int compressionThreshold;
+
+    /** Compression stream, only used while the body is compressed */
+    z_stream_s* compressor;
+
+    /** Decide whether the body will be compressed, before the headers are sent */
+    bool startCompression(const QByteArray& data, bool lastPart);
+
+    /** Compress the next part of the body, finish the stream for the last part */
+    QByteArray compress(const QByteArray& data, bool lastPart);
+
+    /** Write raw data to the output. This method blocks while the output buffer is full */
+    bool writeToOutput(QByteArray data);
 
     /**
       Write the response HTTP status and headers to the socket.
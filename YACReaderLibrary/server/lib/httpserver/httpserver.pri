@@ -31,3 +31,11 @@ SOURCES += $$PWD/httpglobal.cpp \
            $$PWD/httpsession.cpp \
            $$PWD/httpsessionstore.cpp \
            $$PWD/staticfilecontroller.cpp
+
+# zlib is used for the gzip/deflate compression of the responses,
+# on Windows it is the copy bundled with Qt
+win32 {
+    INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib
+} else {
+    LIBS += -lz
+}
@@ -68,10 +68,10 @@ void StaticFileController::service(HttpRequest& request, HttpResponse& response)
         QString fileName = paths.last();
         stringPath.remove(fileName);
         HttpSession session=Static::sessionStore->getSession(request,response,false);
-        YACReaderHttpSession *ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
+        QSharedPointer<YACReaderHttpSession> ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
         QString device = "ipad";
         QString display = "@2x";
-        if (ySession != nullptr) {
+        if (!ySession.isNull()) {
             device = ySession->getDeviceType();
             display = ySession->getDisplayType();
         }
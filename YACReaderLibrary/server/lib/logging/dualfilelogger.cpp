@@ -19,6 +19,11 @@ void DualFileLogger::log(const QtMsgType type, const QString& message, const QSt
     secondLogger->log(type,message,file,function,line);
 }
 
+bool DualFileLogger::isLogged(const QtMsgType type) const
+{
+    return firstLogger->isLogged(type) || secondLogger->isLogged(type);
+}
+
 void DualFileLogger::clear(const bool buffer, const bool variables)
 {
     firstLogger->clear(buffer,variables);
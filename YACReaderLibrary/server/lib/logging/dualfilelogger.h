@@ -49,6 +49,9 @@ public:
     */
     virtual void log(const QtMsgType type, const QString& message, const QString &file="", const QString &function="", const int line=0);
 
+    /** Returns false if both loggers would discard a message of this type */
+    virtual bool isLogged(const QtMsgType type) const;
+
     /**
       Clear the thread-local data of the current thread.
       This method is thread safe.
@@ -44,6 +44,13 @@ void Logger::msgHandler(const QtMsgType type, const QString &message, const QStr
     static QMutex recursiveMutex(QMutex::Recursive);
     static QMutex nonRecursiveMutex(QMutex::NonRecursive);
 
+    // Discard messages that won't be written before taking any lock, so disabled
+    // levels don't serialize the threads that produce them.
+    if (defaultLogger && !defaultLogger->isLogged(type))
+    {
+        return;
+    }
+
     // Prevent multiple threads from calling this method simultaneoulsy.
     // But allow recursive calls, which is required to prevent a deadlock
     // if the logger itself produces an error message.
@@ -148,8 +155,20 @@ void Logger::clear(const bool buffer, const bool variables)
 }
 
 
+bool Logger::isLogged(const QtMsgType type) const
+{
+    // Messages below minLevel are only kept if the backtrace buffer is enabled
+    return bufferSize>0 || type>=minLevel || type>=QtFatalMsg;
+}
+
+
 void Logger::log(const QtMsgType type, const QString& message, const QString &file, const QString &function, const int line)
 {
+    if (!isLogged(type))
+    {
+        return;
+    }
+
     mutex.lock();
 
     // If the buffer is enabled, write the message into it
@@ -84,6 +84,13 @@ public:
     */
     virtual void log(const QtMsgType type, const QString& message, const QString &file="", const QString &function="", const int line=0);
 
+    /**
+      Returns false if a message of this type would be discarded, so the caller
+      can skip decorating it. This method doesn't lock.
+      @param type Message type (level)
+    */
+    virtual bool isLogged(const QtMsgType type) const;
+
     /**
       Installs this logger as the default message handler, so it
       can be used through the global static logging functions (e.g. qDebug()).
@@ -0,0 +1,340 @@
+/**
+  @file
+*/
+
+#include "compiledtemplate.h"
+#include <QRegExp>
+
+static bool isName(const QString& text)
+{
+    if (text.isEmpty())
+    {
+        return false;
+    }
+    for (int i=0; i<text.length(); ++i)
+    {
+        QChar c=text.at(i);
+        if (c.isSpace() || c=='{' || c=='}')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+CompiledTemplate::CompiledTemplate(const QString& source, const QString& sourceName)
+    : sourceName(sourceName), sourceSize(source.size()), sizeHint(source.size())
+{
+    parse(source);
+}
+
+QString CompiledTemplate::getSourceName() const
+{
+    return sourceName;
+}
+
+int CompiledTemplate::getSourceSize() const
+{
+    return sourceSize;
+}
+
+void CompiledTemplate::appendText(const QString& text)
+{
+    if (text.isEmpty())
+    {
+        return;
+    }
+    if (!nodes.isEmpty() && nodes.last().type==Node::Text)
+    {
+        nodes.last().text.append(text);
+    }
+    else
+    {
+        Node node;
+        node.type=Node::Text;
+        node.text=text;
+        node.elseIndex=-1;
+        node.endIndex=-1;
+        nodes.append(node);
+    }
+}
+
+void CompiledTemplate::closeAsText(int index)
+{
+    // the block and its else marker are written as they are, the children are still rendered
+    Node& node=nodes[index];
+    if (node.elseIndex>=0)
+    {
+        nodes[node.elseIndex].type=Node::Text;
+    }
+    node.type=Node::Text;
+}
+
+void CompiledTemplate::parse(const QString& source)
+{
+    QVector<int> open;
+    int position=0;
+    while (position<source.length())
+    {
+        int start=source.indexOf('{',position);
+        if (start<0)
+        {
+            appendText(source.mid(position));
+            break;
+        }
+        appendText(source.mid(position,start-position));
+
+        int end=source.indexOf('}',start+1);
+        if (end<0)
+        {
+            appendText(source.mid(start));
+            break;
+        }
+
+        QString tag=source.mid(start,end-start+1);
+        QString content=tag.mid(1,tag.length()-2);
+        int space=content.indexOf(' ');
+        QString keyword=space>0 ? content.left(space) : QString();
+        QString name=space>0 ? content.mid(space+1) : QString();
+
+        Node node;
+        node.text=tag;
+        node.elseIndex=-1;
+        node.endIndex=-1;
+
+        if (isName(name) && (keyword=="if" || keyword=="ifnot" || keyword=="loop"))
+        {
+            node.type=keyword=="if" ? Node::If : keyword=="ifnot" ? Node::IfNot : Node::Loop;
+            node.name=name;
+            open.append(nodes.size());
+            nodes.append(node);
+            if (node.type==Node::Loop)
+            {
+                loopNames.insert(name);
+            }
+            else
+            {
+                conditionNames.insert(name);
+            }
+        }
+        else if (isName(name) && (keyword=="else" || keyword=="end"))
+        {
+            // the innermost open block with this name
+            int block=-1;
+            for (int i=open.size()-1; i>=0; --i)
+            {
+                const Node& candidate=nodes.at(open.at(i));
+                if (candidate.name==name && (keyword=="end" || candidate.elseIndex<0))
+                {
+                    block=i;
+                    break;
+                }
+            }
+
+            if (block<0)
+            {
+                appendText(tag);
+            }
+            else if (keyword=="else")
+            {
+                node.type=Node::Else;
+                nodes[open.at(block)].elseIndex=nodes.size();
+                nodes.append(node);
+            }
+            else
+            {
+                // blocks opened after this one are not closed
+                while (open.size()>block+1)
+                {
+                    closeAsText(open.takeLast());
+                }
+                node.type=Node::End;
+                nodes[open.takeLast()].endIndex=nodes.size();
+                nodes.append(node);
+            }
+        }
+        else if (isName(content))
+        {
+            node.type=Node::Variable;
+            node.name=content;
+            nodes.append(node);
+            variableNames.insert(content);
+        }
+        else
+        {
+            // not a tag, e.g. a brace of a script or a style sheet
+            appendText("{");
+            position=start+1;
+            continue;
+        }
+
+        position=end+1;
+    }
+
+    while (!open.isEmpty())
+    {
+        qWarning("Template: missing end of %s in %s",qPrintable(nodes.at(open.last()).text),qPrintable(sourceName));
+        closeAsText(open.takeLast());
+    }
+}
+
+QString CompiledTemplate::resolve(const QString& name, const QVector<Scope>& scopes)
+{
+    QString resolved=name;
+    for (int i=0; i<scopes.size(); ++i)
+    {
+        const Scope& scope=scopes.at(i);
+        if (resolved.startsWith(scope.from))
+        {
+            resolved=scope.to+resolved.mid(scope.from.length());
+        }
+    }
+    return resolved;
+}
+
+QString CompiledTemplate::unnumbered(const QString& name)
+{
+    // "row1.column2.value" is the variable "row.column.value" of the template
+    QString result=name;
+    result.replace(QRegExp("\\d+\\."),".");
+    return result;
+}
+
+bool CompiledTemplate::hasVariable(const QString& name) const
+{
+    return variableNames.contains(name) || variableNames.contains(unnumbered(name));
+}
+
+bool CompiledTemplate::hasCondition(const QString& name) const
+{
+    return conditionNames.contains(name) || conditionNames.contains(unnumbered(name));
+}
+
+bool CompiledTemplate::hasLoop(const QString& name) const
+{
+    return loopNames.contains(name) || loopNames.contains(unnumbered(name));
+}
+
+QString CompiledTemplate::render(const QHash<QString,QString>& variables, const QHash<QString,bool>& conditions, const QHash<QString,int>& loops) const
+{
+    QString output;
+    output.reserve(sizeHint.load());
+
+    QVector<Scope> scopes;
+    render(0,nodes.size(),output,scopes,variables,conditions,loops);
+
+    if (output.size()>sizeHint.load())
+    {
+        sizeHint.store(output.size());
+    }
+    return output;
+}
+
+void CompiledTemplate::render(int from, int to, QString& output, QVector<Scope>& scopes,
+                              const QHash<QString,QString>& variables, const QHash<QString,bool>& conditions, const QHash<QString,int>& loops) const
+{
+    int i=from;
+    while (i<to)
+    {
+        const Node& node=nodes.at(i);
+        switch (node.type)
+        {
+            case Node::Text:
+                output.append(node.text);
+                ++i;
+                break;
+
+            case Node::Variable:
+            {
+                QString name=scopes.isEmpty() ? node.name : resolve(node.name,scopes);
+                QHash<QString,QString>::const_iterator value=variables.constFind(name);
+                if (value!=variables.constEnd())
+                {
+                    output.append(value.value());
+                }
+                else
+                {
+                    output.append('{').append(name).append('}');
+                }
+                ++i;
+                break;
+            }
+
+            case Node::If:
+            case Node::IfNot:
+            {
+                QString name=scopes.isEmpty() ? node.name : resolve(node.name,scopes);
+                int thenEnd=node.elseIndex>=0 ? node.elseIndex : node.endIndex;
+                QHash<QString,bool>::const_iterator value=conditions.constFind(name);
+                if (value==conditions.constEnd())
+                {
+                    renderAsText(i,output,name,scopes,variables,conditions,loops);
+                }
+                else if (value.value()==(node.type==Node::If))
+                {
+                    render(i+1,thenEnd,output,scopes,variables,conditions,loops);
+                }
+                else if (node.elseIndex>=0)
+                {
+                    render(node.elseIndex+1,node.endIndex,output,scopes,variables,conditions,loops);
+                }
+                i=node.endIndex+1;
+                break;
+            }
+
+            case Node::Loop:
+            {
+                QString name=scopes.isEmpty() ? node.name : resolve(node.name,scopes);
+                int bodyEnd=node.elseIndex>=0 ? node.elseIndex : node.endIndex;
+                QHash<QString,int>::const_iterator value=loops.constFind(name);
+                if (value==loops.constEnd())
+                {
+                    renderAsText(i,output,name,scopes,variables,conditions,loops);
+                }
+                else if (value.value()>0)
+                {
+                    Scope scope;
+                    scope.from=name+".";
+                    scopes.append(scope);
+                    for (int repetition=0; repetition<value.value(); ++repetition)
+                    {
+                        scopes.last().to=name+QString::number(repetition)+".";
+                        render(i+1,bodyEnd,output,scopes,variables,conditions,loops);
+                    }
+                    scopes.removeLast();
+                }
+                else if (node.elseIndex>=0)
+                {
+                    render(node.elseIndex+1,node.endIndex,output,scopes,variables,conditions,loops);
+                }
+                i=node.endIndex+1;
+                break;
+            }
+
+            default:
+                // markers are skipped by their blocks
+                ++i;
+                break;
+        }
+    }
+}
+
+void CompiledTemplate::renderAsText(int index, QString& output, const QString& name, QVector<Scope>& scopes,
+                                    const QHash<QString,QString>& variables, const QHash<QString,bool>& conditions, const QHash<QString,int>& loops) const
+{
+    // a block without value is written with its tags, like the source
+    const Node& node=nodes.at(index);
+    const char* keyword=node.type==Node::If ? "if" : node.type==Node::IfNot ? "ifnot" : "loop";
+    output.append(QString("{%1 %2}").arg(keyword,name));
+    if (node.elseIndex>=0)
+    {
+        render(index+1,node.elseIndex,output,scopes,variables,conditions,loops);
+        output.append(QString("{else %1}").arg(name));
+        render(node.elseIndex+1,node.endIndex,output,scopes,variables,conditions,loops);
+    }
+    else
+    {
+        render(index+1,node.endIndex,output,scopes,variables,conditions,loops);
+    }
+    output.append(QString("{end %1}").arg(name));
+}
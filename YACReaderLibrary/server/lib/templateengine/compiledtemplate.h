@@ -0,0 +1,109 @@
+/**
+  @file
+*/
+
+#ifndef COMPILEDTEMPLATE_H
+#define COMPILEDTEMPLATE_H
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QAtomicInt>
+#include "templateglobal.h"
+
+/**
+  A template document parsed into a flat list of nodes (text, variable, condition, loop),
+  so it can be rendered in a single pass. Compiled templates are immutable and can be
+  shared by several threads, TemplateCache keeps them instead of the source text.
+  <p>
+  Blocks are stored in document order: the block node, its children, an else marker,
+  the children of the else part and an end marker. Each block knows the position of its
+  markers, so a part that isn't rendered is skipped at once.
+  <p>
+  Tags that are not closed, or closed out of order, are kept as plain text, and so are the
+  variables, conditions and loops without a value. This is what the former search and replace
+  engine did.
+  @see Template
+*/
+
+class DECLSPEC CompiledTemplate {
+public:
+
+    /**
+      Parses the template source.
+      @param source The template source text
+      @param sourceName Name of the source file, used for logging
+    */
+    CompiledTemplate(const QString& source, const QString& sourceName);
+
+    /** Name of the source file */
+    QString getSourceName() const;
+
+    /** Size of the source text, used as cost by TemplateCache */
+    int getSourceSize() const;
+
+    /**
+      Renders the template.
+      @param variables Values of the variables, the names of loop variables are numbered (e.g. "user0.name")
+      @param conditions Values of the conditions
+      @param loops Repetitions of the loops
+    */
+    QString render(const QHash<QString,QString>& variables, const QHash<QString,bool>& conditions, const QHash<QString,int>& loops) const;
+
+    /** True if the template has a variable with this name, numbered loop names are accepted */
+    bool hasVariable(const QString& name) const;
+
+    /** True if the template has a condition with this name, numbered loop names are accepted */
+    bool hasCondition(const QString& name) const;
+
+    /** True if the template has a loop with this name, numbered loop names are accepted */
+    bool hasLoop(const QString& name) const;
+
+private:
+
+    struct Node {
+        enum Type { Text, Variable, If, IfNot, Loop, Else, End };
+
+        Type type;
+        /** Text, or the tag as written in the source */
+        QString text;
+        /** Name of the variable, condition or loop */
+        QString name;
+        /** Position of the else marker of a block, -1 if there is none */
+        int elseIndex;
+        /** Position of the end marker of a block */
+        int endIndex;
+    };
+
+    /** Renaming of the names inside a loop repetition, e.g. "user." to "user0." */
+    struct Scope {
+        QString from;
+        QString to;
+    };
+
+    void parse(const QString& source);
+    void appendText(const QString& text);
+    void closeAsText(int index);
+
+    void render(int from, int to, QString& output, QVector<Scope>& scopes,
+                const QHash<QString,QString>& variables, const QHash<QString,bool>& conditions, const QHash<QString,int>& loops) const;
+    void renderAsText(int index, QString& output, const QString& name, QVector<Scope>& scopes,
+                      const QHash<QString,QString>& variables, const QHash<QString,bool>& conditions, const QHash<QString,int>& loops) const;
+
+    static QString resolve(const QString& name, const QVector<Scope>& scopes);
+    static QString unnumbered(const QString& name);
+
+    QString sourceName;
+    int sourceSize;
+    QVector<Node> nodes;
+
+    QSet<QString> variableNames;
+    QSet<QString> conditionNames;
+    QSet<QString> loopNames;
+
+    /** Largest output so far, used to allocate the output buffer at once */
+    mutable QAtomicInt sizeHint;
+};
+
+#endif // COMPILEDTEMPLATE_H
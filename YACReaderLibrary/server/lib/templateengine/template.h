@@ -7,17 +7,21 @@
 #define TEMPLATE_H
 
 #include <QString>
-#include <QRegExp>
+#include <QHash>
+#include <QSharedPointer>
 #include <QIODevice>
 #include <QTextCodec>
 #include <QFile>
-#include <QString>
 #include "templateglobal.h"
+#include "compiledtemplate.h"
 
 /**
- Enhanced version of QString for template processing. Templates
- are usually loaded from files, but may also be loaded from
- prepared Strings.
+ Template processing. Templates are usually loaded from files, but may
+ also be loaded from prepared Strings.
+ <p>
+ The source is parsed once into a CompiledTemplate (shared by all the copies
+ of a cached template). The set methods only record the values, the document
+ is rendered in a single pass by render() or toUtf8().
  Example template file:
  <p><code><pre>
  Hello {username}, how are you?
@@ -85,9 +89,10 @@
  </pre></code></p>
  @see TemplateLoader
  @see TemplateCache
+ @see CompiledTemplate
 */
 
-class DECLSPEC Template : public QString {
+class DECLSPEC Template {
 public:
 
     /**
@@ -108,18 +113,23 @@ public:
     */
     Template(QFile& file, QTextCodec* textCodec);
 
+    /**
+      Constructor that uses an already compiled template.
+      @param compiled The compiled template, usually shared with TemplateCache
+    */
+    Template(QSharedPointer<const CompiledTemplate> compiled);
+
     /**
       Replace a variable by the given value.
       Affects tags with the syntax
 
       - {name}
 
-      After settings the
-      value of a variable, the variable does not exist anymore,
-      it it cannot be changed multiple times.
+      Only the first value set for a variable is used,
+      it cannot be changed multiple times.
       @param name name of the variable
       @param value new value
-      @return The count of variables that have been processed
+      @return 1 if the template has the variable, 0 otherwise
     */
     int setVariable(QString name, QString value);
 
@@ -133,7 +143,7 @@ public:
 
      @param name Name of the condition
      @param value Value of the condition
-     @return The count of conditions that have been processed
+     @return 1 if the template has the condition, 0 otherwise
     */
     int setCondition(QString name, bool value);
 
@@ -146,7 +156,7 @@ public:
 
      @param name Name of the loop
      @param repetitions The number of repetitions
-     @return The number of loops that have been processed
+     @return 1 if the template has the loop, 0 otherwise
     */
     int loop(QString name, int repetitions);
 
@@ -156,10 +166,28 @@ public:
     */
     void enableWarnings(bool enable=true);
 
+    /**
+     Renders the template with the values that have been set.
+     Tags without value are kept as they are.
+    */
+    QString render() const;
+
+    /** Renders the template encoded as UTF-8 */
+    QByteArray toUtf8() const;
+
 private:
 
-    /** Name of the source file */
-    QString sourceName;
+    /** The parsed source */
+    QSharedPointer<const CompiledTemplate> compiled;
+
+    /** Values of the variables */
+    QHash<QString,QString> variables;
+
+    /** Values of the conditions */
+    QHash<QString,bool> conditions;
+
+    /** Repetitions of the loops */
+    QHash<QString,int> loops;
 
     /** Enables warnings, if true */
     bool warnings;
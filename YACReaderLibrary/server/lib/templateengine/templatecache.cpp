@@ -11,7 +11,7 @@ TemplateCache::TemplateCache(QSettings* settings, QObject* parent)
     qDebug("TemplateCache: timeout=%i, size=%i",cacheTimeout,cache.maxCost());
 }
 
-QString TemplateCache::tryFile(QString localizedName)
+QSharedPointer<const CompiledTemplate> TemplateCache::tryCompiledFile(QString localizedName)
 {
     qint64 now=QDateTime::currentMSecsSinceEpoch();
     // search in cache
@@ -19,14 +19,16 @@ QString TemplateCache::tryFile(QString localizedName)
     CacheEntry* entry=cache.object(localizedName);
     if (entry && (cacheTimeout==0 || entry->created>now-cacheTimeout))
     {
-        return entry->document;
+        return entry->compiled;
     }
     // search on filesystem
     entry=new CacheEntry();
     entry->created=now;
-    entry->document=TemplateLoader::tryFile(localizedName);
+    entry->compiled=TemplateLoader::tryCompiledFile(localizedName);
     // Store in cache even when the file did not exist, to remember that there is no such file
-    cache.insert(localizedName,entry,entry->document.size());
-    return entry->document;
+    // (the entry may be deleted by insert() if it is too large)
+    QSharedPointer<const CompiledTemplate> compiled=entry->compiled;
+    cache.insert(localizedName,entry,compiled.isNull() ? 0 : compiled->getSourceSize());
+    return compiled;
 }
 
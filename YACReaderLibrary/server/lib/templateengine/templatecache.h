@@ -54,16 +54,17 @@ public:
 protected:
 
     /**
-      Try to get a file from cache or filesystem.
+      Try to get a compiled template from cache or filesystem.
+      Templates are parsed only when they are loaded from the filesystem.
       @param localizedName Name of the template with locale to find
-      @return The template document, or empty string if not found
+      @return The compiled template, or a null pointer if not found
     */
-    virtual QString tryFile(QString localizedName);
+    virtual QSharedPointer<const CompiledTemplate> tryCompiledFile(QString localizedName);
 
 private:
 
     struct CacheEntry {
-        QString document;
+        QSharedPointer<const CompiledTemplate> compiled;
         qint64 created;
     };
 
@@ -3,9 +3,11 @@ DEPENDPATH += $$PWD
 
 HEADERS += $$PWD/templateglobal.h
 HEADERS += $$PWD/template.h 
+HEADERS += $$PWD/compiledtemplate.h
 HEADERS += $$PWD/templateloader.h 
 HEADERS += $$PWD/templatecache.h
 
 SOURCES += $$PWD/template.cpp 
+SOURCES += $$PWD/compiledtemplate.cpp
 SOURCES += $$PWD/templateloader.cpp 
 SOURCES += $$PWD/templatecache.cpp
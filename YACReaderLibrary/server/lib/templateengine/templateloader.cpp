@@ -62,6 +62,16 @@ QString TemplateLoader::tryFile(QString localizedName)
     return "";
 }
 
+QSharedPointer<const CompiledTemplate> TemplateLoader::tryCompiledFile(QString localizedName)
+{
+    QString document=tryFile(localizedName);
+    if (document.isEmpty())
+    {
+        return QSharedPointer<const CompiledTemplate>();
+    }
+    return QSharedPointer<const CompiledTemplate>(new CompiledTemplate(document,localizedName));
+}
+
 Template TemplateLoader::getTemplate(QString templateName, QString locales)
 {
     mutex.lock();
@@ -76,10 +86,10 @@ Template TemplateLoader::getTemplate(QString templateName, QString locales)
         QString localizedName=templateName+"-"+loc.trimmed();
         if (!tried.contains(localizedName))
         {
-            QString document=tryFile(localizedName);
-            if (!document.isEmpty()) {
+            QSharedPointer<const CompiledTemplate> compiled=tryCompiledFile(localizedName);
+            if (!compiled.isNull()) {
                 mutex.unlock();
-                return Template(document,localizedName);
+                return Template(compiled);
             }
             tried.insert(localizedName);
         }
@@ -92,22 +102,22 @@ Template TemplateLoader::getTemplate(QString templateName, QString locales)
         QString localizedName=templateName+"-"+loc.trimmed();
         if (!tried.contains(localizedName))
         {
-            QString document=tryFile(localizedName);
-            if (!document.isEmpty())
+            QSharedPointer<const CompiledTemplate> compiled=tryCompiledFile(localizedName);
+            if (!compiled.isNull())
             {
                 mutex.unlock();
-                return Template(document,localizedName);
+                return Template(compiled);
             }
             tried.insert(localizedName);
         }
     }
 
     // Search for default file
-    QString document=tryFile(templateName);
-    if (!document.isEmpty())
+    QSharedPointer<const CompiledTemplate> compiled=tryCompiledFile(templateName);
+    if (!compiled.isNull())
     {
         mutex.unlock();
-        return Template(document,templateName);
+        return Template(compiled);
     }
 
     qCritical("TemplateCache: cannot find template %s",qPrintable(templateName));
@@ -70,6 +70,14 @@ protected:
     */
     virtual QString tryFile(QString localizedName);
 
+    /**
+      Try to get a compiled template from cache or filesystem.
+      The default implementation compiles the document returned by tryFile().
+      @param localizedName Name of the template with locale to find
+      @return The compiled template, or a null pointer if not found
+    */
+    virtual QSharedPointer<const CompiledTemplate> tryCompiledFile(QString localizedName);
+
     /** Directory where the templates are searched */
     QString templatePath;
 
@@ -39,16 +39,31 @@
 #include "controllers/v2/readinglistcontentcontroller_v2.h"
 #include "controllers/v2/readinglistinfocontroller_v2.h"
 #include "controllers/v2/comicfullinfocontroller_v2.h"
+#include "controllers/v2/comicfilecontroller_v2.h"
+#include "controllers/v2/comicsfullinfocontroller_v2.h"
+#include "controllers/v2/coverscontroller_v2.h"
+#include "controllers/v2/metricscontroller_v2.h"
 
 #include "db_helper.h"
 #include "yacreader_libraries.h"
+#include "yacreader_global.h"
 
 #include "yacreader_http_session.h"
 
 #include "QsLog.h"
 
+#include <QElapsedTimer>
+
 QMutex RequestMapper::mutex;
 
+//percent decoded, without the trailing / (ignored by the route tables too)
+static QByteArray decodedPath(HttpRequest& request)
+{
+    QByteArray path = QUrl::fromPercentEncoding(request.getPath()).toUtf8();
+    while(path.size() > 1 && path.endsWith('/'))
+        path.chop(1);
+    return path;
+}
 
 RequestMapper::RequestMapper(QObject* parent)
 	:HttpRequestHandler(parent) {}
@@ -58,10 +73,11 @@ void RequestMapper::loadSessionV1(HttpRequest & request, HttpResponse& response)
     QMutexLocker locker(&mutex);
     
     HttpSession session=Static::sessionStore->getSession(request,response);
-    if(session.contains("ySession")) //session is already alive check if it is needed to update comics
+    QSharedPointer<YACReaderHttpSession> ySession;
+    if(session.contains("ySession"))
+        ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
+    if(!ySession.isNull()) //session is already alive check if it is needed to update comics
     {
-        YACReaderHttpSession *ySession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(session.getId());
-
         QString postData = QString::fromUtf8(request.getBody());
 
         if(postData.contains("currentPage"))
@@ -89,9 +105,10 @@ void RequestMapper::loadSessionV1(HttpRequest & request, HttpResponse& response)
             }
         }
     }
-    else
+    else //new session, or the YACReader session has expired
     {
-        YACReaderHttpSession *ySession = new YACReaderHttpSession(this);
+        //without parent, the session is deleted by the last request (or the store) releasing it
+        ySession = QSharedPointer<YACReaderHttpSession>(new YACReaderHttpSession());
 
         Static::yacreaderSessionStore->addYACReaderHttpSession(session.getId(), ySession);
 
@@ -131,11 +148,11 @@ void RequestMapper::loadSessionV2(HttpRequest & request, HttpResponse& response)
         return;
     }
     
-    YACReaderHttpSession *yRecoveredSession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(token);
+    QSharedPointer<YACReaderHttpSession> yRecoveredSession = Static::yacreaderSessionStore->getYACReaderSessionHttpSession(token);
     
-    if(yRecoveredSession == nullptr) //session is already alive check if it is needed to update comics
+    if(yRecoveredSession.isNull()) //session is already alive check if it is needed to update comics
     {
-        YACReaderHttpSession *ySession = new YACReaderHttpSession(this);
+        QSharedPointer<YACReaderHttpSession> ySession(new YACReaderHttpSession());
         
         Static::yacreaderSessionStore->addYACReaderHttpSession(token, ySession);
     }
@@ -147,222 +164,184 @@ void RequestMapper::service(HttpRequest& request, HttpResponse& response) {
     QLOG_TRACE() << "RequestMapper: path=" << path.data();
     QLOG_TRACE() << "X-Request-Id: " << request.getHeader("x-request-id");
 
+    QElapsedTimer timer;
+    timer.start();
+    Static::metrics->requestStarted();
+
+    QByteArray route;
     if (path.startsWith("/v2"))
     {
-        serviceV2(request, response);
+        route = serviceV2(request, response);
     }
     else
     {
-        serviceV1(request, response);
+        route = serviceV1(request, response);
     }
+
+    Static::metrics->requestFinished(route, response.getStatusCode(), timer.nsecsElapsed() / 1000, response.getBodyBytes());
 }
 
-void RequestMapper::serviceV1(HttpRequest& request, HttpResponse& response)
+bool RequestMapper::serviceImmediately(HttpRequest& request, HttpResponse& response)
 {
-    QByteArray path=request.getPath();
+    //only the covers in memory, the rest of the requests need the DB or the disk
+    if(request.getMethod() != "GET" || !request.getPath().startsWith("/v2/library/"))
+        return false;
 
-    QRegExp folder("/library/.+/folder/[0-9]+/?");//get comic content
-    QRegExp folderInfo("/library/.+/folder/[0-9]+/info/?"); //get folder info
-    QRegExp comicDownloadInfo("/library/.+/comic/[0-9]+/?"); //get comic info (basic/download info)
-    QRegExp comicFullInfo("/library/.+/comic/[0-9]+/info/?"); //get comic info (full info)
-    QRegExp comicOpen("/library/.+/comic/[0-9]+/remote/?"); //the server will open for reading the comic
-    QRegExp comicUpdate("/library/.+/comic/[0-9]+/update/?"); //get comic info
-    QRegExp comicClose("/library/.+/comic/[0-9]+/close/?"); //the server will close the comic and free memory
-    QRegExp cover("/library/.+/cover/[0-9a-f]+.jpg"); //get comic cover (navigation)
-    QRegExp comicPage("/library/.+/comic/[0-9]+/page/[0-9]+/?"); //get comic page
-    QRegExp comicPageRemote("/library/.+/comic/[0-9]+/page/[0-9]+/remote?"); //get comic page (remote reading)
+    QElapsedTimer timer;
+    timer.start();
 
-    QRegExp sync("/sync");
+    QByteArray path = decodedPath(request);
+    QByteArray route;
+    if(routesV2().match(path, request, &route) != &YACReaderRouteTable::serve<CoverControllerV2>)
+        return false;
 
-    QRegExp library("/library/([0-9]+)/.+"); //permite verificar que la biblioteca solicitada existe
+    if(!CoverControllerV2::serviceCached(request, response))
+        return false;
 
-    path = QUrl::fromPercentEncoding(path).toUtf8();
+    Static::metrics->requestStarted();
+    Static::metrics->requestFinished(route, response.getStatusCode(), timer.nsecsElapsed() / 1000, response.getBodyBytes());
+    return true;
+}
+
+HttpRequestBodySink* RequestMapper::createBodySink(HttpRequest& request)
+{
+    if(request.getMethod() == "POST" && decodedPath(request) == "/v2/sync")
+        return SyncControllerV2::createBodySink();
+
+    return nullptr;
+}
+
+QByteArray RequestMapper::serviceV1(HttpRequest& request, HttpResponse& response)
+{
+    QByteArray path = decodedPath(request);
 
-    if(!sync.exactMatch(path)) //no session is needed for syncback info, until security will be added
+    if(path != "/sync") //no session is needed for syncback info, until security will be added
         loadSessionV1(request, response);
 
     //primera petición, se ha hecho un post, se sirven las bibliotecas si la seguridad mediante login no está habilitada
     if(path == "/")  //Don't send data to the server using '/' !!!!
     {
         LibrariesController().service(request, response);
+        return path;
+    }
+    else if(path == "/sync")
+    {
+        SyncController().service(request, response);
+        return path;
     }
     else
     {
-        if(sync.exactMatch(path))
-            SyncController().service(request, response);
-        else
+        //se comprueba que la sesión sea la correcta con el fin de evitar accesos no autorizados
+        HttpSession session=Static::sessionStore->getSession(request,response,false);
+        if(!session.isNull() && session.contains("ySession"))
         {
-            //se comprueba que la sesión sea la correcta con el fin de evitar accesos no autorizados
-            HttpSession session=Static::sessionStore->getSession(request,response,false);
-            if(!session.isNull() && session.contains("ySession"))
-            {
-                if(library.indexIn(path)!=-1 && DBHelper::getLibraries().contains(library.cap(1).toInt()) )
-                {
-                    //listar el contenido del folder
-                    if(folder.exactMatch(path))
-                    {
-                        FolderController().service(request, response);
-                    }
-                    else if (folderInfo.exactMatch(path))
-                    {
-                        FolderInfoController().service(request, response);
-                    }
-                    else if(cover.exactMatch(path))
-                    {
-                        CoverController().service(request, response);
-                    }
-                    else if(comicDownloadInfo.exactMatch(path))
-                    {
-                        ComicDownloadInfoController().service(request, response);
-                    }
-                    else if(comicFullInfo.exactMatch(path) || comicOpen.exactMatch(path))//start download or start remote reading
-                    {
-                        ComicController().service(request, response);
-                    }
-                    else if(comicPage.exactMatch(path) || comicPageRemote.exactMatch(path))
-                    {
-                        PageController().service(request,response);
-                    }
-                    else if(comicUpdate.exactMatch(path))
-                    {
-                        UpdateComicController().service(request, response);
-                    }
-                }
-                else
-                {
-                    //response.writeText(library.cap(1));
-                    Static::staticFileController->service(request, response);
-                }
-            }
-            else //acceso no autorizado, redirección
+            QByteArray route;
+            YACReaderRouteTable::Service service = routesV1().match(path, request, &route);
+
+            //permite verificar que la biblioteca solicitada existe
+            if(service != 0 && libraryExists(request.getPathParameter("libraryId").toInt()))
             {
-                ErrorController(300).service(request,response);
+                service(request, response);
+                return route;
             }
+
+            Static::staticFileController->service(request, response);
+            return "static";
+        }
+        else //acceso no autorizado, redirección
+        {
+            ErrorController(300).service(request,response);
+            return "unauthorized";
         }
     }
 }
 
-void RequestMapper::serviceV2(HttpRequest& request, HttpResponse& response)
+QByteArray RequestMapper::serviceV2(HttpRequest& request, HttpResponse& response)
 {
-    QByteArray path=request.getPath();
+    QByteArray path = decodedPath(request);
 
-    QRegExp folderInfo("/v2/library/.+/folder/[0-9]+/info/?"); //get folder info
-    QRegExp comicDownloadInfo("/v2/library/.+/comic/[0-9]+/info/?"); //get comic info (full download info)
-    QRegExp comicOpenForDownloading("/v2/library/.+/comic/[0-9]+/?"); //get comic info (full info + opening)
-    QRegExp comicOpenForRemoteReading("/v2/library/.+/comic/[0-9]+/remote/?"); //the server will open for reading the comic
-    QRegExp comicFullInfo("/v2/library/.+/comic/[0-9]+/fullinfo/?"); //get comic info
-    QRegExp comicUpdate("/v2/library/.+/comic/[0-9]+/update/?"); //get comic info
-    QRegExp comicClose("/v2/library/.+/comic/[0-9]+/close/?"); //the server will close the comic and free memory
-    QRegExp cover("/v2/library/.+/cover/[0-9a-f]+.jpg"); //get comic cover (navigation)
-    QRegExp comicPage("/v2/library/.+/comic/[0-9]+/page/[0-9]+/?"); //get comic page
-    QRegExp comicPageRemote("/v2/library/.+/comic/[0-9]+/page/[0-9]+/remote?"); //get comic page (remote reading)
-    QRegExp serverVersion("/v2/version/?");
-    QRegExp folderContent("/v2/library/.+/folder/[0-9]+/content/?");
-    QRegExp favs("/v2/library/.+/favs/?");
-    QRegExp reading("/v2/library/.+/reading/?");
-    QRegExp tags("/v2/library/.+/tags/?");
-    QRegExp tagContent("/v2/library/.+/tag/[0-9]+/content/?");
-    QRegExp tagInfo("/v2/library/.+/tag/[0-9]+/info/?");
-    QRegExp readingLists("/v2/library/.+/reading_lists/?");
-    QRegExp readingListContent("/v2/library/.+/reading_list/[0-9]+/content/?");
-    QRegExp readingListInfo("/v2/library/.+/reading_list/[0-9]+/info/?");
-
-    QRegExp sync("/v2/sync");
-
-    QRegExp library("/v2/library/([0-9]+)/.+"); //permite verificar que la biblioteca solicitada existe
-
-    path = QUrl::fromPercentEncoding(path).toUtf8();
-
-    if(!sync.exactMatch(path)) //no session is needed for syncback info, until security will be added
+    if(path != "/v2/sync") //no session is needed for syncback info, until security will be added
         loadSessionV2(request, response);
 
-    //primera petición, se ha hecho un post, se sirven las bibliotecas si la seguridad mediante login no está habilitada
-    if(path == "/v2/libraries")  //Don't send data to the server using '/' !!!!
-    {
-        LibrariesControllerV2().service(request, response);
-    }
-    else
+    QByteArray route;
+    YACReaderRouteTable::Service service = routesV2().match(path, request, &route);
+
+    //permite verificar que la biblioteca solicitada existe
+    QVariant libraryId = request.getPathParameter("libraryId");
+    if(service != 0 && (!libraryId.isValid() || libraryExists(libraryId.toInt())))
     {
-        if(serverVersion.exactMatch(path))
-        {
-            VersionController().service(request, response);
-        }
-        else if(sync.exactMatch(path))
-        {
-            SyncControllerV2().service(request, response);
-        }
-        else
-        {
-                if(library.indexIn(path)!=-1 && DBHelper::getLibraries().contains(library.cap(1).toInt()) )
-                {
-                    if (folderInfo.exactMatch(path))
-                    {
-                        FolderInfoControllerV2().service(request, response);
-                    }
-                    else if(cover.exactMatch(path))
-                    {
-                        CoverControllerV2().service(request, response);
-                    }
-                    else if(comicDownloadInfo.exactMatch(path))
-                    {
-                        ComicDownloadInfoControllerV2().service(request, response);
-                    }
-                    else if(comicOpenForDownloading.exactMatch(path) || comicOpenForRemoteReading.exactMatch(path))//start download or start remote reading
-                    {
-                        ComicControllerV2().service(request, response);
-                    } else if(comicFullInfo.exactMatch(path)) {
-                        ComicFullinfoController_v2().service(request, response);
-                    }
-                    else if(comicPage.exactMatch(path) || comicPageRemote.exactMatch(path))
-                    {
-                        PageControllerV2().service(request,response);
-                    }
-                    else if(comicUpdate.exactMatch(path))
-                    {
-                        UpdateComicControllerV2().service(request, response);
-                    }
-                    else if(folderContent.exactMatch(path))
-                    {
-                        FolderContentControllerV2().service(request, response);
-                    }
-                    else if(tags.exactMatch(path))
-                    {
-                        TagsControllerV2().service(request, response);
-                    }
-                    else if(tagContent.exactMatch(path))
-                    {
-                        TagContentControllerV2().service(request, response);
-                    }
-                    else if(favs.exactMatch(path))
-                    {
-                        FavoritesControllerV2().service(request, response);
-                    }
-                    else if(reading.exactMatch(path))
-                    {
-                        ReadingComicsControllerV2().service(request, response);
-                    }
-                    else if(readingLists.exactMatch(path))
-                    {
-                        ReadingListsControllerV2().service(request, response);
-                    }
-                    else if(readingListContent.exactMatch(path))
-                    {
-                        ReadingListContentControllerV2().service(request, response);
-                    }
-                    else if(readingListInfo.exactMatch(path))
-                    {
-                        ReadingListInfoControllerV2().service(request, response);
-                    }
-                    else if(tagInfo.exactMatch(path))
-                    {
-                        TagInfoControllerV2().service(request, response);
-                    }
-                }
-                else
-                {
-                    //response.writeText(library.cap(1));
-                    Static::staticFileController->service(request, response);
-                }
-        }
+        service(request, response);
+        return route;
     }
+
+    Static::staticFileController->service(request, response);
+    return "static";
+}
+
+static YACReaderRouteTable * createRoutesV1()
+{
+    YACReaderRouteTable * routes = new YACReaderRouteTable;
+
+    routes->add("/library/:libraryId/folder/:folderId", &YACReaderRouteTable::serve<FolderController>); //get comic content
+    routes->add("/library/:libraryId/folder/:folderId/info", &YACReaderRouteTable::serve<FolderInfoController>); //get folder info
+    routes->add("/library/:libraryId/cover/*fileName", &YACReaderRouteTable::serve<CoverController>); //get comic cover (navigation)
+    routes->add("/library/:libraryId/comic/:comicId", &YACReaderRouteTable::serve<ComicDownloadInfoController>); //get comic info (basic/download info)
+    routes->add("/library/:libraryId/comic/:comicId/info", &YACReaderRouteTable::serve<ComicController>); //get comic info (full info)
+    routes->add("/library/:libraryId/comic/:comicId/remote", &YACReaderRouteTable::serve<ComicController>, "remote"); //the server will open for reading the comic
+    routes->add("/library/:libraryId/comic/:comicId/update", &YACReaderRouteTable::serve<UpdateComicController>); //get comic info
+    routes->add("/library/:libraryId/comic/:comicId/page/:page", &YACReaderRouteTable::serve<PageController>); //get comic page
+    routes->add("/library/:libraryId/comic/:comicId/page/:page/remote", &YACReaderRouteTable::serve<PageController>, "remote"); //get comic page (remote reading)
+
+    return routes;
+}
+
+static YACReaderRouteTable * createRoutesV2()
+{
+    YACReaderRouteTable * routes = new YACReaderRouteTable;
+
+    routes->add("/v2/libraries", &YACReaderRouteTable::serve<LibrariesControllerV2>);
+    routes->add("/v2/version", &YACReaderRouteTable::serve<VersionController>);
+    routes->add("/v2/sync", &YACReaderRouteTable::serve<SyncControllerV2>);
+    routes->add("/v2/metrics", &YACReaderRouteTable::serve<MetricsControllerV2>); //metrics in Prometheus format (opt-in)
+
+    routes->add("/v2/library/:libraryId/folder/:folderId/info", &YACReaderRouteTable::serve<FolderInfoControllerV2>); //get folder info
+    routes->add("/v2/library/:libraryId/folder/:folderId/content", &YACReaderRouteTable::serve<FolderContentControllerV2>);
+    routes->add("/v2/library/:libraryId/cover/*fileName", &YACReaderRouteTable::serve<CoverControllerV2>); //get comic cover (navigation)
+    routes->add("/v2/library/:libraryId/covers", &YACReaderRouteTable::serve<CoversControllerV2>); //get several covers (POST, file names in the body)
+    routes->add("/v2/library/:libraryId/comics/fullinfo", &YACReaderRouteTable::serve<ComicsFullInfoControllerV2>); //get the info of several comics (POST, ids in the body)
+    routes->add("/v2/library/:libraryId/comic/:comicId", &YACReaderRouteTable::serve<ComicControllerV2>); //get comic info (full info + opening)
+    routes->add("/v2/library/:libraryId/comic/:comicId/remote", &YACReaderRouteTable::serve<ComicControllerV2>, "remote"); //the server will open for reading the comic
+    routes->add("/v2/library/:libraryId/comic/:comicId/info", &YACReaderRouteTable::serve<ComicDownloadInfoControllerV2>); //get comic info (full download info)
+    routes->add("/v2/library/:libraryId/comic/:comicId/fullinfo", &YACReaderRouteTable::serve<ComicFullinfoController_v2>); //get comic info
+    routes->add("/v2/library/:libraryId/comic/:comicId/file", &YACReaderRouteTable::serve<ComicFileControllerV2>); //get the comic file (download)
+    routes->add("/v2/library/:libraryId/comic/:comicId/update", &YACReaderRouteTable::serve<UpdateComicControllerV2>); //get comic info
+    routes->add("/v2/library/:libraryId/comic/:comicId/page/:page", &YACReaderRouteTable::serve<PageControllerV2>); //get comic page
+    routes->add("/v2/library/:libraryId/comic/:comicId/page/:page/remote", &YACReaderRouteTable::serve<PageControllerV2>, "remote"); //get comic page (remote reading)
+    routes->add("/v2/library/:libraryId/favs", &YACReaderRouteTable::serve<FavoritesControllerV2>);
+    routes->add("/v2/library/:libraryId/reading", &YACReaderRouteTable::serve<ReadingComicsControllerV2>);
+    routes->add("/v2/library/:libraryId/tags", &YACReaderRouteTable::serve<TagsControllerV2>);
+    routes->add("/v2/library/:libraryId/tag/:tagId/content", &YACReaderRouteTable::serve<TagContentControllerV2>);
+    routes->add("/v2/library/:libraryId/tag/:tagId/info", &YACReaderRouteTable::serve<TagInfoControllerV2>);
+    routes->add("/v2/library/:libraryId/reading_lists", &YACReaderRouteTable::serve<ReadingListsControllerV2>);
+    routes->add("/v2/library/:libraryId/reading_list/:readingListId/content", &YACReaderRouteTable::serve<ReadingListContentControllerV2>);
+    routes->add("/v2/library/:libraryId/reading_list/:readingListId/info", &YACReaderRouteTable::serve<ReadingListInfoControllerV2>);
+
+    return routes;
+}
+
+const YACReaderRouteTable & RequestMapper::routesV1()
+{
+    static const YACReaderRouteTable * routes = createRoutesV1();
+    return *routes;
+}
+
+const YACReaderRouteTable & RequestMapper::routesV2()
+{
+    static const YACReaderRouteTable * routes = createRoutesV2();
+    return *routes;
+}
+
+bool RequestMapper::libraryExists(int libraryId)
+{
+    return DBHelper::getLibraries().contains(libraryId);
 }
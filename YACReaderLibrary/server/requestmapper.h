@@ -7,6 +7,7 @@
 #define REQUESTMAPPER_H
 
 #include "httprequesthandler.h"
+#include "yacreader_route_table.h"
 #include <QMutex>
 
 
@@ -18,12 +19,24 @@ public:
     RequestMapper(QObject* parent=0);
 
     void service(HttpRequest& request, HttpResponse& response);
+    /** Answers the requests of prefetched covers in the I/O thread */
+    bool serviceImmediately(HttpRequest& request, HttpResponse& response);
+    /** Sync batches are applied while they are received */
+    HttpRequestBodySink* createBodySink(HttpRequest& request);
     void loadSessionV1(HttpRequest & request, HttpResponse& response);
     void loadSessionV2(HttpRequest & request, HttpResponse& response);
 
 private:
-    void serviceV1(HttpRequest& request, HttpResponse& response);
-    void serviceV2(HttpRequest& request, HttpResponse& response);
+    /** They return the route served, used as the label of the metrics */
+    QByteArray serviceV1(HttpRequest& request, HttpResponse& response);
+    QByteArray serviceV2(HttpRequest& request, HttpResponse& response);
+
+    /** Precompiled routes of the library paths (v1) and of the v2 API */
+    static const YACReaderRouteTable & routesV1();
+    static const YACReaderRouteTable & routesV2();
+
+    /** The libraries are loaded again only when the settings file changes */
+    static bool libraryExists(int libraryId);
     
     static QMutex mutex;
 };
@@ -15,6 +15,13 @@ HEADERS += \
     $$PWD/yacreader_http_session.h \
     $$PWD/yacreader_http_session_store.h \
     $$PWD/yacreader_server_data_helper.h \
+    $$PWD/yacreader_cover_cache.h \
+    $$PWD/yacreader_cover_prefetcher.h \
+    $$PWD/yacreader_comic_pages.h \
+    $$PWD/yacreader_route_table.h \
+    $$PWD/yacreader_http_cache.h \
+    $$PWD/yacreader_page_variants.h \
+    $$PWD/yacreader_server_metrics.h \
     $$PWD/controllers/versioncontroller.h \
     #v1
     $$PWD/controllers/v1/comiccontroller.h \
@@ -46,7 +53,11 @@ HEADERS += \
     $$PWD/controllers/v2/readinglistcontentcontroller_v2.h \
     $$PWD/controllers/v2/comicfullinfocontroller_v2.h \
     $$PWD/controllers/v2/readinglistinfocontroller_v2.h \
-    $$PWD/controllers/v2/taginfocontroller_v2.h
+    $$PWD/controllers/v2/taginfocontroller_v2.h \
+    $$PWD/controllers/v2/comicfilecontroller_v2.h \
+    $$PWD/controllers/v2/comicsfullinfocontroller_v2.h \
+    $$PWD/controllers/v2/coverscontroller_v2.h \
+    $$PWD/controllers/v2/metricscontroller_v2.h
 
 
 SOURCES += \
@@ -56,6 +67,13 @@ SOURCES += \
     $$PWD/yacreader_http_session.cpp \
     $$PWD/yacreader_http_session_store.cpp \
     $$PWD/yacreader_server_data_helper.cpp \
+    $$PWD/yacreader_cover_cache.cpp \
+    $$PWD/yacreader_cover_prefetcher.cpp \
+    $$PWD/yacreader_comic_pages.cpp \
+    $$PWD/yacreader_route_table.cpp \
+    $$PWD/yacreader_http_cache.cpp \
+    $$PWD/yacreader_page_variants.cpp \
+    $$PWD/yacreader_server_metrics.cpp \
     $$PWD/controllers/versioncontroller.cpp \
     #v1
     $$PWD/controllers/v1/comiccontroller.cpp \
@@ -87,7 +105,11 @@ SOURCES += \
     $$PWD/controllers/v2/readinglistcontentcontroller_v2.cpp \
     $$PWD/controllers/v2/comicfullinfocontroller_v2.cpp \
     $$PWD/controllers/v2/readinglistinfocontroller_v2.cpp \
-    $$PWD/controllers/v2/taginfocontroller_v2.cpp
+    $$PWD/controllers/v2/taginfocontroller_v2.cpp \
+    $$PWD/controllers/v2/comicfilecontroller_v2.cpp \
+    $$PWD/controllers/v2/comicsfullinfocontroller_v2.cpp \
+    $$PWD/controllers/v2/coverscontroller_v2.cpp \
+    $$PWD/controllers/v2/metricscontroller_v2.cpp
 	
 
 include(lib/logging/logging.pri)
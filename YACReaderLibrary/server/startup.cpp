@@ -9,6 +9,7 @@
 #include "httplistener.h"
 #include "requestmapper.h"
 #include "staticfilecontroller.h"
+#include "controllers/v2/comicfilecontroller_v2.h"
 
 #include "yacreader_global.h"
 
@@ -76,12 +77,96 @@ void Startup::start() {
 	QSettings* sessionSettings=new QSettings(configFileName,QSettings::IniFormat,app);
 	sessionSettings->beginGroup("sessions");
 
-    if(sessionSettings->value("expirationTime").isNull())
-        sessionSettings->setValue("expirationTime",864000000);
+    //864000000 (10 days) was the old default
+    if(sessionSettings->value("expirationTime").isNull() || sessionSettings->value("expirationTime").toLongLong() == 864000000)
+        sessionSettings->setValue("expirationTime",3600000);
+    if(sessionSettings->value("idleTimeout").isNull())
+        sessionSettings->setValue("idleTimeout",3600000);
+    if(sessionSettings->value("maxSessions").isNull())
+        sessionSettings->setValue("maxSessions",100);
+    if(sessionSettings->value("maxComicsMemory").isNull())
+        sessionSettings->setValue("maxComicsMemory",268435456);
 
 	Static::sessionStore=new HttpSessionStore(sessionSettings,app);
 
-    Static::yacreaderSessionStore = new YACReaderHttpSessionStore(Static::sessionStore, app);
+    Static::yacreaderSessionStore = new YACReaderHttpSessionStore(Static::sessionStore, sessionSettings, app);
+
+    // Configure sized covers cache (v1)
+    QSettings* coverCacheSettings=new QSettings(configFileName,QSettings::IniFormat,app);
+    coverCacheSettings->beginGroup("coverCache");
+
+    if(coverCacheSettings->value("memoryCacheSize").isNull())
+        coverCacheSettings->setValue("memoryCacheSize",8388608);
+
+    Static::coverCache = new YACReaderCoverCache(coverCacheSettings, app);
+
+    // Configure covers prefetching
+    QSettings* coverPrefetchSettings=new QSettings(configFileName,QSettings::IniFormat,app);
+    coverPrefetchSettings->beginGroup("coverPrefetch");
+
+    if(coverPrefetchSettings->value("bundleTimeout").isNull())
+        coverPrefetchSettings->setValue("bundleTimeout",60000);
+    if(coverPrefetchSettings->value("maxBundleSize").isNull())
+        coverPrefetchSettings->setValue("maxBundleSize",500);
+    if(coverPrefetchSettings->value("memoryCacheSize").isNull())
+        coverPrefetchSettings->setValue("memoryCacheSize",33554432);
+
+    Static::coverPrefetcher = new YACReaderCoverPrefetcher(coverPrefetchSettings, app);
+
+    // Configure shared comic pages cache (v2)
+    QSettings* comicPagesSettings=new QSettings(configFileName,QSettings::IniFormat,app);
+    comicPagesSettings->beginGroup("comicPages");
+
+    if(comicPagesSettings->value("indexCacheSize").isNull())
+        comicPagesSettings->setValue("indexCacheSize",1000);
+    if(comicPagesSettings->value("cacheSize").isNull())
+        comicPagesSettings->setValue("cacheSize",67108864);
+
+    Static::comicPages = new YACReaderComicPages(comicPagesSettings, app);
+
+    // Configure listings cache (v2)
+    QSettings* httpCacheSettings=new QSettings(configFileName,QSettings::IniFormat,app);
+    httpCacheSettings->beginGroup("httpCache");
+
+    if(httpCacheSettings->value("cacheSize").isNull())
+        httpCacheSettings->setValue("cacheSize",16777216);
+
+    Static::httpCache = new YACReaderHttpCache(httpCacheSettings, app);
+
+    // Configure sized pages cache (v2)
+    QSettings* pageVariantsSettings=new QSettings(configFileName,QSettings::IniFormat,app);
+    pageVariantsSettings->beginGroup("pageVariants");
+
+    if(pageVariantsSettings->value("cacheDir").isNull())
+        pageVariantsSettings->setValue("cacheDir","");
+    if(pageVariantsSettings->value("diskCacheSize").isNull())
+        pageVariantsSettings->setValue("diskCacheSize",268435456);
+    if(pageVariantsSettings->value("resizeThreads").isNull())
+        pageVariantsSettings->setValue("resizeThreads",2);
+    if(pageVariantsSettings->value("resizeWait").isNull())
+        pageVariantsSettings->setValue("resizeWait",1000);
+    if(pageVariantsSettings->value("quality").isNull())
+        pageVariantsSettings->setValue("quality",80);
+
+    Static::pageVariants = new YACReaderPageVariants(pageVariantsSettings, app);
+
+    // Configure metrics (v2), /v2/metrics is disabled by default
+    QSettings* metricsSettings=new QSettings(configFileName,QSettings::IniFormat,app);
+    metricsSettings->beginGroup("metrics");
+
+    if(metricsSettings->value("enabled").isNull())
+        metricsSettings->setValue("enabled",false);
+
+    Static::metrics = new YACReaderServerMetrics(metricsSettings, app);
+
+    // Configure comic downloads (v2), they must leave worker threads for the rest of the requests
+    QSettings downloadSettings(configFileName,QSettings::IniFormat);
+    downloadSettings.beginGroup("downloads");
+
+    if(downloadSettings.value("maxDownloads").isNull())
+        downloadSettings.setValue("maxDownloads",4);
+
+    ComicFileControllerV2::setMaxDownloads(downloadSettings.value("maxDownloads").toInt());
 
 	// Configure static file controller
 	QSettings* fileSettings=new QSettings(configFileName,QSettings::IniFormat,app);
@@ -114,14 +199,14 @@ void Startup::start() {
     if(listenerSettings->value("maxMultiPartSize").isNull())
         listenerSettings->setValue("maxMultiPartSize","32000000");
 
-    if(listenerSettings->value("cleanupInterval").isNull())
-        listenerSettings->setValue("cleanupInterval",10000);
+    if(listenerSettings->value("ioThreads").isNull())
+        listenerSettings->setValue("ioThreads",2);
 
-    if(listenerSettings->value("minThreads").isNull())
-        listenerSettings->setValue("maxThreads",1000);
+    if(listenerSettings->value("workerThreads").isNull())
+        listenerSettings->setValue("workerThreads",16);
 
-    if(listenerSettings->value("minThreads").isNull())
-        listenerSettings->setValue("minThreads",50);
+    if(listenerSettings->value("maxConnections").isNull())
+        listenerSettings->setValue("maxConnections",1000);
 
 	listener = new HttpListener(listenerSettings,new RequestMapper(app),app);
 
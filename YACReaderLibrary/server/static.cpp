@@ -19,6 +19,18 @@ StaticFileController* Static::staticFileController=0;
 
 YACReaderHttpSessionStore* Static::yacreaderSessionStore=0;
 
+YACReaderCoverCache* Static::coverCache=0;
+
+YACReaderCoverPrefetcher* Static::coverPrefetcher=0;
+
+YACReaderComicPages* Static::comicPages=0;
+
+YACReaderHttpCache* Static::httpCache=0;
+
+YACReaderPageVariants* Static::pageVariants=0;
+
+YACReaderServerMetrics* Static::metrics=0;
+
 QString Static::getConfigFileName() {
     return QString("%1/%2.ini").arg(getConfigDir()).arg(QCoreApplication::applicationName());
 }
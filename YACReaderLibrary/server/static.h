@@ -12,6 +12,12 @@
 #include "staticfilecontroller.h"
 
 #include "yacreader_http_session_store.h"
+#include "yacreader_cover_cache.h"
+#include "yacreader_cover_prefetcher.h"
+#include "yacreader_comic_pages.h"
+#include "yacreader_http_cache.h"
+#include "yacreader_page_variants.h"
+#include "yacreader_server_metrics.h"
 
 /**
   This class contains some static resources that are used by the application.
@@ -55,6 +61,24 @@ public:
 
     static YACReaderHttpSessionStore* yacreaderSessionStore;
 
+    /** Sized covers for the v1 API */
+    static YACReaderCoverCache* coverCache;
+
+    /** Covers loaded before the clients request them */
+    static YACReaderCoverPrefetcher* coverPrefetcher;
+
+    /** Random access to the pages of the comics */
+    static YACReaderComicPages* comicPages;
+
+    /** Listings of the v2 API */
+    static YACReaderHttpCache* httpCache;
+
+    /** Pages sized for the display of the clients */
+    static YACReaderPageVariants* pageVariants;
+
+    /** Request counters and timings */
+    static YACReaderServerMetrics* metrics;
+
     /** Controller for static files */
     static StaticFileController* staticFileController;
 
@@ -0,0 +1,342 @@
+#include "yacreader_comic_pages.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <QVector>
+
+#include "comic.h"
+#include "comic_db.h"
+#include "compressed_archive.h"
+#include "db_helper.h"
+#include "yacreader_libraries.h"
+
+#include "QsLog.h"
+
+struct YACReaderComicPages::CachedComic
+{
+    CachedComic() : size(0), modified(0), bytes(0), lastUsed(0), archive(nullptr) {}
+    ~CachedComic() { delete archive; }
+
+    QString path;
+    qint64 size;
+    qint64 modified;
+    QVector<int> entries; //archive index of each page
+
+    QHash<int,QByteArray> pages;
+    qint64 bytes;
+    quint64 lastUsed;
+
+    //only one request at a time can extract from the archive
+    CompressedArchive * archive;
+    QMutex archiveMutex;
+};
+
+YACReaderComicPages::YACReaderComicPages(QSettings* settings, QObject* parent)
+    :QObject(parent), clock(0), totalBytes(0), hits(0), misses(0), evictions(0)
+{
+    maxComics = settings->value("indexCacheSize","1000").toInt();
+    maxBytes = settings->value("cacheSize","67108864").toLongLong();
+}
+
+YACReaderComicPages::Result YACReaderComicPages::getPage(qulonglong libraryId, qulonglong comicId, int page, QByteArray &data)
+{
+    QString key = QString("%1/%2").arg(libraryId).arg(comicId);
+    QSharedPointer<CachedComic> comic;
+    bool keepArchive;
+
+    {
+        QMutexLocker locker(&mutex);
+        comic = comics.value(key);
+        keepArchive = references.value(key) > 0;
+        if(!comic.isNull())
+        {
+            comic->lastUsed = ++clock;
+            if(comic->pages.contains(page))
+            {
+                hits++;
+                data = comic->pages.value(page);
+                return Ok;
+            }
+        }
+        misses++;
+    }
+
+    //the comic is valid while the file doesn't change
+    if(!comic.isNull())
+    {
+        QFileInfo info(comic->path);
+        if(!info.isFile() || info.size() != comic->size || info.lastModified().toMSecsSinceEpoch() != comic->modified)
+        {
+            QMutexLocker locker(&mutex);
+            if(comics.value(key) == comic)
+            {
+                totalBytes -= comic->bytes;
+                comics.remove(key);
+            }
+            comic.clear();
+        }
+    }
+
+    QString path;
+    if(comic.isNull())
+    {
+        QString libraryPath = DBHelper::getLibraries().getPath(libraryId);
+        ComicDB comicInfo = DBHelper::getComicInfo(libraryId, comicId);
+        if(libraryPath.isEmpty() || comicInfo.path.isEmpty())
+            return NotFound;
+
+        path = libraryPath + comicInfo.path;
+    }
+    else
+        path = comic->path;
+
+    QFileInfo info(path);
+    if(!info.isFile())
+        return NotFound;
+
+    if(!isRandomAccess(path))
+        return Unsupported;
+
+    if(comic.isNull())
+    {
+        comic = QSharedPointer<CachedComic>(new CachedComic);
+        comic->path = path;
+        comic->size = info.size();
+        comic->modified = info.lastModified().toMSecsSinceEpoch();
+    }
+
+    {
+        QMutexLocker archiveLocker(&comic->archiveMutex);
+
+        CompressedArchive * archive = comic->archive;
+        if(archive == nullptr)
+        {
+            archive = new CompressedArchive(path);
+            if(!archive->toolsLoaded() || !archive->isValid())
+            {
+                QLOG_ERROR() << "Unable to open " << path;
+                delete archive;
+                return Unsupported;
+            }
+        }
+
+        if(comic->entries.isEmpty())
+        {
+            QList<QString> fileNames = archive->getFileNames();
+            QHash<QString,int> archiveIndexes;
+            for(int i=0;i<fileNames.size();i++)
+                archiveIndexes.insert(fileNames.at(i), i);
+
+            foreach(QString pageName, FileComic::sortedPages(fileNames))
+                comic->entries.append(archiveIndexes.value(pageName));
+        }
+
+        if(page >= 0 && page < comic->entries.size())
+            data = archive->getRawDataAtIndex(comic->entries.at(page));
+
+        //the archive is kept open while a session is reading the comic
+        if(keepArchive)
+            comic->archive = archive;
+        else
+        {
+            if(comic->archive == archive)
+                comic->archive = nullptr;
+            delete archive;
+        }
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        QSharedPointer<CachedComic> current = comics.value(key);
+        if(current.isNull())
+        {
+            comics.insert(key, comic);
+            totalBytes += comic->bytes;
+            current = comic;
+        }
+
+        if(current == comic)
+        {
+            comic->lastUsed = ++clock;
+            if(!data.isEmpty() && !comic->pages.contains(page))
+            {
+                comic->pages.insert(page, data);
+                comic->bytes += data.size();
+                totalBytes += data.size();
+            }
+            evict();
+        }
+    }
+
+    return data.isEmpty()?NotFound:Ok;
+}
+
+YACReaderComicHandle YACReaderComicPages::handle(qulonglong libraryId, qulonglong comicId)
+{
+    return YACReaderComicHandle(this, QString("%1/%2").arg(libraryId).arg(comicId));
+}
+
+YACReaderComicPages::Stats YACReaderComicPages::stats()
+{
+    Stats stats;
+    QList<QSharedPointer<CachedComic> > cachedComics;
+
+    {
+        QMutexLocker locker(&mutex);
+
+        stats.hits = hits;
+        stats.misses = misses;
+        stats.evictions = evictions;
+        stats.bytes = totalBytes;
+        stats.comics = comics.size();
+        stats.handles = 0;
+
+        foreach(int count, references)
+            stats.handles += count;
+
+        cachedComics = comics.values();
+    }
+
+    //the archives are opened and closed under the lock of each comic, the cache isn't locked meanwhile
+    stats.openArchives = 0;
+    foreach(const QSharedPointer<CachedComic> & comic, cachedComics)
+    {
+        QMutexLocker archiveLocker(&comic->archiveMutex);
+        if(comic->archive != nullptr)
+            stats.openArchives++;
+    }
+
+    return stats;
+}
+
+bool YACReaderComicPages::isRandomAccess(const QString &comicPath)
+{
+    QFileInfo info(comicPath);
+    return info.isFile() && info.suffix().compare("pdf",Qt::CaseInsensitive) != 0;
+}
+
+void YACReaderComicPages::retain(const QString &key)
+{
+    QMutexLocker locker(&mutex);
+    references[key]++;
+}
+
+void YACReaderComicPages::release(const QString &key)
+{
+    QSharedPointer<CachedComic> comic;
+
+    {
+        QMutexLocker locker(&mutex);
+        if(--references[key] > 0)
+            return;
+
+        references.remove(key);
+        comic = comics.value(key);
+        evict();
+    }
+
+    //nobody is reading the comic, close the archive
+    if(!comic.isNull())
+    {
+        QMutexLocker archiveLocker(&comic->archiveMutex);
+        delete comic->archive;
+        comic->archive = nullptr;
+    }
+}
+
+void YACReaderComicPages::evict()
+{
+    forever
+    {
+        bool tooManyComics = comics.size() > maxComics;
+        if(!tooManyComics && totalBytes <= maxBytes)
+            break;
+
+        //least recently used comic, comics with handles are evicted last
+        QString victim;
+        quint64 victimLastUsed = 0;
+        bool victimReferenced = true;
+
+        QHash<QString,QSharedPointer<CachedComic> >::const_iterator itr;
+        for(itr = comics.constBegin(); itr != comics.constEnd(); ++itr)
+        {
+            if(!tooManyComics && itr.value()->bytes == 0)
+                continue;
+
+            bool referenced = references.contains(itr.key());
+            if(victim.isNull() || (victimReferenced && !referenced) ||
+                    (victimReferenced == referenced && itr.value()->lastUsed < victimLastUsed))
+            {
+                victim = itr.key();
+                victimLastUsed = itr.value()->lastUsed;
+                victimReferenced = referenced;
+            }
+        }
+
+        if(victim.isNull())
+            break;
+
+        QSharedPointer<CachedComic> comic = comics.value(victim);
+        totalBytes -= comic->bytes;
+        evictions++;
+
+        if(victimReferenced && !tooManyComics)
+        {
+            //a session is reading it, keep the page index and the open archive
+            comic->pages.clear();
+            comic->bytes = 0;
+        }
+        else
+            comics.remove(victim);
+    }
+}
+
+YACReaderComicHandle::YACReaderComicHandle()
+{
+
+}
+
+YACReaderComicHandle::YACReaderComicHandle(YACReaderComicPages *pages, const QString &key)
+    :pages(pages), key(key)
+{
+    if(pages != nullptr)
+        pages->retain(key);
+}
+
+YACReaderComicHandle::YACReaderComicHandle(const YACReaderComicHandle &other)
+    :pages(other.pages), key(other.key)
+{
+    if(!pages.isNull())
+        pages->retain(key);
+}
+
+YACReaderComicHandle::~YACReaderComicHandle()
+{
+    reset();
+}
+
+YACReaderComicHandle &YACReaderComicHandle::operator=(const YACReaderComicHandle &other)
+{
+    if(this != &other)
+    {
+        if(!other.pages.isNull())
+            other.pages->retain(other.key);
+        reset();
+        pages = other.pages;
+        key = other.key;
+    }
+    return *this;
+}
+
+bool YACReaderComicHandle::isNull() const
+{
+    return pages.isNull();
+}
+
+void YACReaderComicHandle::reset()
+{
+    if(!pages.isNull())
+        pages->release(key);
+    pages.clear();
+    key.clear();
+}
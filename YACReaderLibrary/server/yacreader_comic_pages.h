@@ -0,0 +1,117 @@
+#ifndef YACREADERCOMICPAGES_H
+#define YACREADERCOMICPAGES_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QSettings>
+
+class YACReaderComicHandle;
+
+/**
+  Serves single pages of the comics in the libraries without loading the whole comic.
+  <p>
+  The comic is found in the DB and only the requested entry of the archive is extracted.
+  This cache is shared by all the sessions: the position of each page in the archive
+  (the page index) and the extracted pages are kept in memory while the comic file
+  doesn't change, so devices reading the same comic don't extract it again.
+  <p>
+  Sessions reading a comic hold a YACReaderComicHandle, the archive of a comic with
+  handles is kept open and its pages are the last ones to be evicted. When the
+  extracted pages use more than cacheSize bytes, or there are more than
+  indexCacheSize comics, the least recently used comics are evicted.
+  <p>
+  Settings:
+  <code><pre>
+  indexCacheSize=1000
+  cacheSize=67108864
+  </pre></code>
+*/
+
+class YACReaderComicPages : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(YACReaderComicPages)
+public:
+    enum Result {
+        Ok,
+        NotFound,
+        Unsupported //the comic can't be read page by page (PDF), it has to be opened with Comic
+    };
+
+    struct Stats {
+        quint64 hits;
+        quint64 misses;
+        quint64 evictions;
+        qint64 bytes; //extracted pages in memory
+        int comics;
+        int openArchives;
+        int handles;
+    };
+
+    YACReaderComicPages(QSettings* settings, QObject* parent=0);
+
+    /** Raw data of the page, as it is stored in the comic file */
+    Result getPage(qulonglong libraryId, qulonglong comicId, int page, QByteArray & data);
+
+    /** Handle for a session reading the comic, the comic stays in the cache while it is held */
+    YACReaderComicHandle handle(qulonglong libraryId, qulonglong comicId);
+
+    Stats stats();
+
+    /** True if pages of this file can be read with getPage() */
+    static bool isRandomAccess(const QString & comicPath);
+
+private:
+    friend class YACReaderComicHandle;
+
+    struct CachedComic;
+
+    void retain(const QString & key);
+    void release(const QString & key);
+
+    /** Removes stale comics, the caller owns the lock */
+    void evict();
+
+    QHash<QString,QSharedPointer<CachedComic> > comics;
+    QHash<QString,int> references;
+    quint64 clock;
+    qint64 totalBytes;
+    qint64 maxBytes;
+    int maxComics;
+
+    quint64 hits;
+    quint64 misses;
+    quint64 evictions;
+
+    QMutex mutex;
+};
+
+/**
+  Reference to a comic in YACReaderComicPages, released when the last copy is destroyed.
+*/
+
+class YACReaderComicHandle
+{
+public:
+    YACReaderComicHandle();
+    YACReaderComicHandle(const YACReaderComicHandle & other);
+    ~YACReaderComicHandle();
+
+    YACReaderComicHandle & operator=(const YACReaderComicHandle & other);
+
+    bool isNull() const;
+    void reset();
+
+private:
+    friend class YACReaderComicPages;
+
+    YACReaderComicHandle(YACReaderComicPages * pages, const QString & key);
+
+    QPointer<YACReaderComicPages> pages;
+    QString key;
+};
+
+#endif // YACREADERCOMICPAGES_H
@@ -0,0 +1,219 @@
+#include "yacreader_cover_cache.h"
+
+#include "data_base_management.h"
+#include "QsLog.h"
+
+#include <QRunnable>
+#include <QSqlQuery>
+#include <QSet>
+#include <QFileInfo>
+#include <QFile>
+#include <QSaveFile>
+#include <QDir>
+#include <QDateTime>
+#include <QPainter>
+#include <QBuffer>
+
+YACReaderCoverCache::YACReaderCoverCache(QSettings* settings, QObject* parent)
+    :QObject(parent)
+{
+    cache.setMaxCost(settings->value("memoryCacheSize","8388608").toInt());
+
+    //loaded once, they were read from the resources on each request
+    folderOverlayImage = QImage(":/images/f_overlayed.png");
+    folderOverlayRetinaImage = QImage(":/images/f_overlayed_retina.png");
+
+    pruneInterval = settings->value("pruneInterval","86400000").toLongLong();
+    clock.start();
+    pool.setMaxThreadCount(1);
+}
+
+YACReaderCoverCache::~YACReaderCoverCache()
+{
+    pool.clear();
+    pool.waitForDone();
+}
+
+class YACReaderCoverCache::PruneTask : public QRunnable
+{
+public:
+    PruneTask(YACReaderCoverCache* cache, const QString & libraryPath)
+        : cache(cache), libraryPath(libraryPath) {}
+
+    void run()
+    {
+        cache->prune(libraryPath);
+    }
+
+private:
+    YACReaderCoverCache* cache;
+    QString libraryPath;
+};
+
+QStringList YACReaderCoverCache::variants()
+{
+    return QStringList() << "80x120" << "80x120_folder" << "160x240" << "160x240_folder";
+}
+
+QByteArray YACReaderCoverCache::getCover(const QString &libraryPath, const QString &fileName, bool retina, bool folderOverlay)
+{
+    schedulePrune(libraryPath);
+
+    QFileInfo source(libraryPath+"/.yacreaderlibrary/covers/"+fileName);
+    if(!source.isFile())
+    {
+        removeVariants(libraryPath, fileName);
+        return QByteArray();
+    }
+
+    qint64 sourceModified = source.lastModified().toMSecsSinceEpoch();
+    QString variant = QString(retina?"160x240":"80x120") + (folderOverlay?"_folder":"");
+    QString key = libraryPath+"/"+variant+"/"+fileName;
+
+    {
+        QMutexLocker locker(&mutex);
+        CacheEntry* entry = cache.object(key);
+        if(entry && entry->sourceModified == sourceModified)
+            return entry->data;
+    }
+
+    QString variantDir = libraryPath+"/.yacreaderlibrary/covers_sized/"+variant;
+    QFileInfo stored(variantDir+"/"+fileName);
+    QByteArray data;
+
+    //strictly newer, a cover regenerated in the same second must not be mistaken for the rendered one
+    if(stored.isFile() && stored.lastModified() > source.lastModified())
+    {
+        QFile file(stored.absoluteFilePath());
+        if(file.open(QIODevice::ReadOnly))
+            data = file.readAll();
+    }
+
+    if(data.isEmpty())
+    {
+        data = render(source.absoluteFilePath(), retina, folderOverlay);
+        if(data.isEmpty())
+            return data;
+
+        //QSaveFile, other threads may be reading the same variant
+        QDir().mkpath(variantDir);
+        QSaveFile file(stored.absoluteFilePath());
+        if(file.open(QIODevice::WriteOnly))
+        {
+            file.write(data);
+            file.commit();
+        }
+    }
+
+    QMutexLocker locker(&mutex);
+    CacheEntry* entry = new CacheEntry();
+    entry->data = data;
+    entry->sourceModified = sourceModified;
+    cache.insert(key,entry,data.size());
+
+    return data;
+}
+
+void YACReaderCoverCache::removeVariants(const QString &libraryPath, const QString &fileName)
+{
+    foreach(const QString & variant, variants())
+    {
+        QFile::remove(libraryPath+"/.yacreaderlibrary/covers_sized/"+variant+"/"+fileName);
+
+        QMutexLocker locker(&mutex);
+        cache.remove(libraryPath+"/"+variant+"/"+fileName);
+    }
+}
+
+void YACReaderCoverCache::schedulePrune(const QString &libraryPath)
+{
+    {
+        QMutexLocker locker(&mutex);
+        QHash<QString,qint64>::const_iterator last = lastPrune.constFind(libraryPath);
+        if(last != lastPrune.constEnd() && clock.elapsed() - last.value() < pruneInterval)
+            return;
+        lastPrune.insert(libraryPath, clock.elapsed());
+    }
+
+    pool.start(new PruneTask(this, libraryPath));
+}
+
+void YACReaderCoverCache::prune(const QString &libraryPath)
+{
+    //the covers in use, if the library can't be read only the outdated variants are removed
+    QSet<QString> inUse;
+    bool libraryRead = false;
+    {
+        QSqlDatabase db = DataBaseManagement::loadDatabase(libraryPath+"/.yacreaderlibrary");
+        {
+            QSqlQuery selectQuery(db);
+            selectQuery.setForwardOnly(true);
+            if(selectQuery.exec("SELECT DISTINCT ci.hash FROM comic c INNER JOIN comic_info ci ON (c.comicInfoId = ci.id)"))
+            {
+                while(selectQuery.next())
+                    inUse.insert(selectQuery.value(0).toString() + ".jpg");
+                libraryRead = true;
+            }
+        }
+        db.close();
+        QSqlDatabase::removeDatabase(db.connectionName());
+    }
+
+    int removed = 0;
+    foreach(const QString & variant, variants())
+    {
+        QDir dir(libraryPath+"/.yacreaderlibrary/covers_sized/"+variant);
+        foreach(QFileInfo stored, dir.entryInfoList(QDir::Files))
+        {
+            QFileInfo source(libraryPath+"/.yacreaderlibrary/covers/"+stored.fileName());
+            if((libraryRead && !inUse.contains(stored.fileName())) || !source.isFile() || source.lastModified() >= stored.lastModified())
+            {
+                if(QFile::remove(stored.absoluteFilePath()))
+                    removed++;
+
+                QMutexLocker locker(&mutex);
+                cache.remove(libraryPath+"/"+variant+"/"+stored.fileName());
+            }
+        }
+    }
+
+    if(removed > 0)
+        QLOG_INFO() << "Removed" << removed << "sized covers from" << libraryPath;
+}
+
+QByteArray YACReaderCoverCache::render(const QString &coverPath, bool retina, bool folderOverlay)
+{
+    QImage img(coverPath);
+    if(img.isNull())
+        return QByteArray();
+
+    int width = 80, height = 120;
+    if(retina)
+    {
+        width = 160;
+        height = 240;
+    }
+
+    if(float(img.width())/img.height() < 0.66666)
+        img = img.scaledToWidth(width,Qt::SmoothTransformation);
+    else
+        img = img.scaledToHeight(height,Qt::SmoothTransformation);
+
+    QImage destImg(width,height,QImage::Format_RGB32);
+    destImg.fill(Qt::black);
+    {
+        QPainter p(&destImg);
+
+        p.drawImage((width-img.width())/2,(height-img.height())/2,img);
+
+        if(folderOverlay)
+            p.drawImage(0,0,retina?folderOverlayRetinaImage:folderOverlayImage);
+    }
+
+    QByteArray ba;
+    QBuffer buffer(&ba);
+    buffer.open(QIODevice::WriteOnly);
+    destImg.save(&buffer, "JPG");
+
+    return ba;
+}
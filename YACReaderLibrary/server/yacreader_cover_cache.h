@@ -0,0 +1,79 @@
+#ifndef YACREADERCOVERCACHE_H
+#define YACREADERCOVERCACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QMutex>
+#include <QImage>
+#include <QSettings>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QThreadPool>
+
+/**
+  Sized versions of the library covers used by the v1 API (80x120 and 160x240 for
+  retina displays, with or without the folder overlay).
+  <p>
+  Each variant is rendered once and stored in .yacreaderlibrary/covers_sized/<variant>/,
+  it is rendered again if the original cover is newer. The encoded bytes of the last
+  used variants are kept in memory.
+  <p>
+  The variants of a missing cover are removed when it is requested. Every pruneInterval
+  milliseconds a background task removes the variants of the comics that are no longer
+  in the library and the outdated ones, so the directory doesn't grow without bound.
+  <p>
+  Settings:
+  <code><pre>
+  memoryCacheSize=8388608
+  pruneInterval=86400000
+  </pre></code>
+*/
+
+class YACReaderCoverCache : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(YACReaderCoverCache)
+public:
+    YACReaderCoverCache(QSettings* settings, QObject* parent=0);
+    ~YACReaderCoverCache();
+
+    /**
+      JPEG data of the sized cover, empty if the cover doesn't exist.
+      @param libraryPath root path of the library
+      @param fileName name of the cover in .yacreaderlibrary/covers
+    */
+    QByteArray getCover(const QString & libraryPath, const QString & fileName, bool retina, bool folderOverlay);
+
+private:
+    class PruneTask;
+
+    QByteArray render(const QString & coverPath, bool retina, bool folderOverlay);
+
+    /** Removes every variant of the cover, from the disk and from memory */
+    void removeVariants(const QString & libraryPath, const QString & fileName);
+
+    /** Starts prune() if the library hasn't been pruned for pruneInterval */
+    void schedulePrune(const QString & libraryPath);
+    void prune(const QString & libraryPath);
+
+    static QStringList variants();
+
+    struct CacheEntry {
+        QByteArray data;
+        qint64 sourceModified;
+    };
+
+    QCache<QString,CacheEntry> cache;
+    QMutex mutex;
+
+    QImage folderOverlayImage;
+    QImage folderOverlayRetinaImage;
+
+    qint64 pruneInterval;
+    QElapsedTimer clock;
+    //elapsed time of the last prune of each library
+    QHash<QString,qint64> lastPrune;
+    QThreadPool pool;
+};
+
+#endif // YACREADERCOVERCACHE_H
@@ -0,0 +1,201 @@
+#include "yacreader_cover_prefetcher.h"
+
+#include "db_helper.h"
+#include "yacreader_libraries.h"
+#include "yacreader_route_table.h"
+#include "static.h"
+
+#include <QRunnable>
+#include <QFileInfo>
+#include <QFile>
+#include <QDateTime>
+#include <QUuid>
+
+class YACReaderCoverPrefetcher::BundleTask : public QRunnable
+{
+public:
+    BundleTask(YACReaderCoverPrefetcher* prefetcher, qulonglong libraryId, const QStringList & fileNames)
+        : prefetcher(prefetcher), libraryId(libraryId), fileNames(fileNames) {}
+
+    void run()
+    {
+        prefetcher->loadBundle(libraryId, fileNames);
+    }
+
+private:
+    YACReaderCoverPrefetcher* prefetcher;
+    qulonglong libraryId;
+    QStringList fileNames;
+};
+
+class YACReaderCoverPrefetcher::SizedTask : public QRunnable
+{
+public:
+    SizedTask(const QString & libraryPath, const QStringList & comicCovers, const QStringList & folderCovers, bool retina)
+        : libraryPath(libraryPath), comicCovers(comicCovers), folderCovers(folderCovers), retina(retina) {}
+
+    void run()
+    {
+        foreach(const QString & fileName, comicCovers)
+            Static::coverCache->getCover(libraryPath, fileName, retina, false);
+        foreach(const QString & fileName, folderCovers)
+            Static::coverCache->getCover(libraryPath, fileName, retina, true);
+    }
+
+private:
+    QString libraryPath;
+    QStringList comicCovers;
+    QStringList folderCovers;
+    bool retina;
+};
+
+YACReaderCoverPrefetcher::YACReaderCoverPrefetcher(QSettings* settings, QObject* parent)
+    :QObject(parent), bundlesCreated(0), hits(0), misses(0)
+{
+    bundleTimeout = settings->value("bundleTimeout","60000").toLongLong();
+    maxBundleSize = settings->value("maxBundleSize","500").toInt();
+    covers.setMaxCost(settings->value("memoryCacheSize","33554432").toInt());
+
+    clock.start();
+    bundlePool.setMaxThreadCount(1);
+    sizedPool.setMaxThreadCount(1);
+}
+
+YACReaderCoverPrefetcher::~YACReaderCoverPrefetcher()
+{
+    bundlePool.clear();
+    sizedPool.clear();
+    bundlePool.waitForDone();
+    sizedPool.waitForDone();
+}
+
+QByteArray YACReaderCoverPrefetcher::createBundle(qulonglong libraryId, const QStringList &fileNames)
+{
+    QByteArray token = QUuid::createUuid().toRfc4122().toHex();
+    QStringList bundleCovers = fileNames.mid(0, maxBundleSize);
+
+    {
+        QMutexLocker locker(&mutex);
+        removeExpiredBundles();
+
+        Bundle bundle;
+        bundle.libraryId = libraryId;
+        bundle.fileNames = bundleCovers;
+        bundle.expires = clock.elapsed() + bundleTimeout;
+        bundles.insert(token, bundle);
+
+        bundlesCreated++;
+    }
+
+    bundlePool.start(new BundleTask(this, libraryId, bundleCovers));
+
+    return token;
+}
+
+bool YACReaderCoverPrefetcher::getBundle(qulonglong libraryId, const QByteArray &token, QStringList &fileNames)
+{
+    QMutexLocker locker(&mutex);
+
+    QHash<QByteArray,Bundle>::const_iterator bundle = bundles.constFind(token);
+    if(bundle == bundles.constEnd() || bundle->libraryId != libraryId || bundle->expires < clock.elapsed())
+        return false;
+
+    fileNames = bundle->fileNames;
+    return true;
+}
+
+void YACReaderCoverPrefetcher::prefetchSized(const QString &libraryPath, const QStringList &comicCovers, const QStringList &folderCovers, bool retina)
+{
+    sizedPool.start(new SizedTask(libraryPath, comicCovers, folderCovers, retina));
+}
+
+bool YACReaderCoverPrefetcher::getCover(qulonglong libraryId, const QString &fileName, QByteArray &data, QByteArray &etag)
+{
+    QMutexLocker locker(&mutex);
+
+    Cover* cover = covers.object(QString::number(libraryId)+"/"+fileName);
+    if(cover == 0 || cover->expires < clock.elapsed())
+    {
+        misses++;
+        return false;
+    }
+
+    data = cover->data;
+    etag = cover->etag;
+    hits++;
+    return true;
+}
+
+YACReaderCoverPrefetcher::Stats YACReaderCoverPrefetcher::stats()
+{
+    QMutexLocker locker(&mutex);
+
+    Stats stats;
+    stats.bundles = bundlesCreated;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.bytes = covers.totalCost();
+    stats.covers = covers.count();
+    return stats;
+}
+
+bool YACReaderCoverPrefetcher::isBundleRequested(const HttpRequest &request)
+{
+    return QString::compare(request.getHeader("X-Cover-Prefetch"),"true",Qt::CaseInsensitive)==0;
+}
+
+QByteArray YACReaderCoverPrefetcher::coverETag(const QFileInfo &file)
+{
+    return "\"" + file.completeBaseName().toLatin1() + "-" + QByteArray::number(file.lastModified().toMSecsSinceEpoch(), 16) + "\"";
+}
+
+void YACReaderCoverPrefetcher::loadBundle(qulonglong libraryId, const QStringList &fileNames)
+{
+    QString libraryPath = DBHelper::getLibraries().getPath(libraryId);
+
+    foreach(const QString & fileName, fileNames)
+    {
+        if(!YACReaderRouteTable::isCoverFileName(fileName.toLatin1()))
+            continue;
+
+        QString key = QString::number(libraryId)+"/"+fileName;
+        qint64 expires = clock.elapsed() + bundleTimeout;
+
+        {
+            //already loaded by another bundle, it lives as long as the newest one
+            QMutexLocker locker(&mutex);
+            Cover* cover = covers.object(key);
+            if(cover != 0 && cover->expires >= clock.elapsed())
+            {
+                cover->expires = expires;
+                continue;
+            }
+        }
+
+        QFile file(libraryPath+"/.yacreaderlibrary/covers/"+fileName);
+        if(!file.open(QIODevice::ReadOnly))
+            continue;
+
+        Cover* cover = new Cover();
+        cover->data = file.readAll();
+        cover->etag = coverETag(QFileInfo(file));
+        cover->expires = expires;
+
+        QMutexLocker locker(&mutex);
+        covers.insert(key, cover, qMax(cover->data.size(), 1));
+    }
+}
+
+void YACReaderCoverPrefetcher::removeExpiredBundles()
+{
+    qint64 now = clock.elapsed();
+
+    QHash<QByteArray,Bundle>::iterator bundle = bundles.begin();
+    while(bundle != bundles.end())
+    {
+        if(bundle->expires < now)
+            bundle = bundles.erase(bundle);
+        else
+            ++bundle;
+    }
+}
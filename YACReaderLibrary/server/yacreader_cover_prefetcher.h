@@ -0,0 +1,128 @@
+#ifndef YACREADERCOVERPREFETCHER_H
+#define YACREADERCOVERPREFETCHER_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QStringList>
+#include <QSettings>
+
+#include "httprequest.h"
+
+class QFileInfo;
+
+/**
+  Covers of the listings being browsed, loaded in memory before the clients request them.
+  <p>
+  A v2 listing requested with the header X-Cover-Prefetch: true gets a cover bundle token in
+  the X-Cover-Bundle header of the response when the listing is built (listings served from
+  the listings cache or with 304 have no bundle, the client already has them). The covers of
+  the listing are read in the background by their own thread, in the order of the listing,
+  and they are kept in memory for bundleTimeout ms.
+  While they are there, the cover requests don't touch the disk and pipelined cover requests
+  are answered by the I/O thread of the connection. The whole bundle can also be requested
+  at once with /v2/library/:libraryId/covers?bundle=token.
+  <p>
+  The v1 folder pages warm the sized covers of the page for the display of the client.
+  <p>
+  Settings:
+  <code><pre>
+  bundleTimeout=60000
+  maxBundleSize=500
+  memoryCacheSize=33554432
+  </pre></code>
+*/
+
+class YACReaderCoverPrefetcher : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(YACReaderCoverPrefetcher)
+public:
+    struct Stats {
+        quint64 bundles;
+        quint64 hits;
+        quint64 misses;
+        int bytes;
+        int covers;
+    };
+
+    YACReaderCoverPrefetcher(QSettings* settings, QObject* parent=0);
+    ~YACReaderCoverPrefetcher();
+
+    /**
+      Registers a bundle and starts loading its covers in the background.
+      @param fileNames file names of the covers (in .yacreaderlibrary/covers) in the order
+      they will be requested
+      @return the token of the bundle
+    */
+    QByteArray createBundle(qulonglong libraryId, const QStringList & fileNames);
+
+    /**
+      File names of the covers of a bundle, the covers not loaded yet are read by the caller.
+      @return false if the token doesn't exist or it has expired
+    */
+    bool getBundle(qulonglong libraryId, const QByteArray & token, QStringList & fileNames);
+
+    /** Renders the sized covers (v1) in the background */
+    void prefetchSized(const QString & libraryPath, const QStringList & comicCovers, const QStringList & folderCovers, bool retina);
+
+    /**
+      Cover loaded by a bundle that hasn't expired, the disk is never read.
+      @return false if the cover isn't in memory
+    */
+    bool getCover(qulonglong libraryId, const QString & fileName, QByteArray & data, QByteArray & etag);
+
+    Stats stats();
+
+    /** True if the client wants a cover bundle for the listing requested */
+    static bool isBundleRequested(const HttpRequest & request);
+
+    /** ETag of a cover file, the same hash can get a new cover (cover page changed) so the file date is part of it */
+    static QByteArray coverETag(const QFileInfo & file);
+
+private:
+    class BundleTask;
+    class SizedTask;
+
+    void loadBundle(qulonglong libraryId, const QStringList & fileNames);
+
+    /** Removes the expired bundles, the caller owns the lock */
+    void removeExpiredBundles();
+
+    struct Bundle {
+        qulonglong libraryId;
+        QStringList fileNames;
+        qint64 expires;
+    };
+
+    struct Cover {
+        QByteArray data;
+        QByteArray etag;
+        qint64 expires;
+    };
+
+    qint64 bundleTimeout;
+    int maxBundleSize;
+
+    QHash<QByteArray,Bundle> bundles;
+    QCache<QString,Cover> covers;
+    QMutex mutex;
+
+    /** Monotonic clock for the expiration times */
+    QElapsedTimer clock;
+
+    /** The covers are read by a single thread, they are small and the requests go first */
+    QThreadPool bundlePool;
+
+    /** Sized covers (v1), they are rendered and can't delay the bundles */
+    QThreadPool sizedPool;
+
+    quint64 bundlesCreated;
+    quint64 hits;
+    quint64 misses;
+};
+
+#endif // YACREADERCOVERPREFETCHER_H
@@ -0,0 +1,127 @@
+#include "yacreader_http_cache.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+
+#include "db_helper.h"
+#include "yacreader_libraries.h"
+
+YACReaderHttpCache::YACReaderHttpCache(QSettings* settings, QObject* parent)
+    :QObject(parent), allRevisions(0), hits(0), misses(0), notModified(0)
+{
+    cache.setMaxCost(settings->value("cacheSize","16777216").toInt());
+}
+
+QByteArray YACReaderHttpCache::getRevision(qulonglong libraryId)
+{
+    quint64 revision;
+    {
+        QMutexLocker locker(&mutex);
+        revision = allRevisions + revisions.value(libraryId);
+    }
+
+    //changes made by other processes, with WAL journaling the writes go to the -wal file until it is checkpointed
+    QString dbPath = DBHelper::getLibraries().getPath(libraryId)+"/.yacreaderlibrary/library.ydb";
+    QFileInfo db(dbPath);
+    QFileInfo wal(dbPath+"-wal");
+
+    return QByteArray::number(revision,36) + "-" +
+           QByteArray::number(db.lastModified().toMSecsSinceEpoch(),36) + "-" + QByteArray::number(db.size(),36) + "-" +
+           QByteArray::number(wal.lastModified().toMSecsSinceEpoch(),36) + "-" + QByteArray::number(wal.size(),36);
+}
+
+void YACReaderHttpCache::libraryUpdated(qulonglong libraryId)
+{
+    QMutexLocker locker(&mutex);
+    revisions[libraryId]++;
+}
+
+void YACReaderHttpCache::librariesUpdated()
+{
+    QMutexLocker locker(&mutex);
+    allRevisions++;
+}
+
+void YACReaderHttpCache::serviceListing(HttpRequest &request, HttpResponse &response, qulonglong libraryId,
+                                        const QString &listing, std::function<QByteArray()> build)
+{
+    QByteArray revision = getRevision(libraryId);
+    QByteArray etag = "\"" + QByteArray::number(libraryId) + "-" + revision + "\"";
+
+    //the listings don't change between revisions, but clients must check it every time
+    response.setHeader("ETag", "W/" + etag);
+    response.setHeader("Cache-Control", "no-cache");
+
+    if(matchesETag(request.getHeader("If-None-Match"), etag))
+    {
+        {
+            QMutexLocker locker(&mutex);
+            notModified++;
+        }
+        response.setStatus(304,"Not Modified");
+        response.write(QByteArray(),true);
+        return;
+    }
+
+    QString key = QString::number(libraryId) + "/" + listing + "/" + revision;
+    QByteArray body;
+    bool cached = false;
+
+    {
+        QMutexLocker locker(&mutex);
+        QByteArray* entry = cache.object(key);
+        if(entry)
+        {
+            body = *entry;
+            cached = true;
+            hits++;
+        }
+        else
+            misses++;
+    }
+
+    if(!cached)
+    {
+        body = build();
+
+        //the old revisions of the listing are never requested again, QCache evicts them
+        QMutexLocker locker(&mutex);
+        cache.insert(key, new QByteArray(body), qMax(body.size(),1));
+    }
+
+    response.write(body,true);
+}
+
+YACReaderHttpCache::Stats YACReaderHttpCache::stats()
+{
+    QMutexLocker locker(&mutex);
+
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.notModified = notModified;
+    stats.bytes = cache.totalCost();
+    stats.listings = cache.count();
+    return stats;
+}
+
+bool YACReaderHttpCache::matchesETag(const QByteArray &ifNoneMatch, const QByteArray &etag)
+{
+    if (ifNoneMatch.isEmpty())
+        return false;
+
+    QByteArray opaqueTag = etag.startsWith("W/") ? etag.mid(2) : etag;
+
+    foreach (QByteArray tag, ifNoneMatch.split(',')) {
+        tag = tag.trimmed();
+        if (tag == "*")
+            return true;
+        //If-None-Match uses the weak comparison
+        if (tag.startsWith("W/"))
+            tag = tag.mid(2);
+        if (tag == opaqueTag)
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,82 @@
+#ifndef YACREADERHTTPCACHE_H
+#define YACREADERHTTPCACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QSettings>
+
+#include <functional>
+
+#include "httprequest.h"
+#include "httpresponse.h"
+
+/**
+  Cache for the JSON listings of the v2 API (folder content, tags, favorites, reading
+  lists...).
+  <p>
+  Each library has a revision, it changes when the server writes to the library (reading
+  progress, sync) and when the DB files are modified by any other process (the library
+  window, updates). The listings are stored with the revision they were built for, so
+  they are never served stale and there is no need to invalidate them explicitly.
+  <p>
+  The revision is also sent as a weak ETag, clients sending it back in If-None-Match
+  get a 304 response without the listing being read from the DB.
+  <p>
+  Settings:
+  <code><pre>
+  cacheSize=16777216
+  </pre></code>
+*/
+
+class YACReaderHttpCache : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(YACReaderHttpCache)
+public:
+    struct Stats {
+        quint64 hits;
+        quint64 misses;
+        quint64 notModified;
+        int bytes;
+        int listings;
+    };
+
+    YACReaderHttpCache(QSettings* settings, QObject* parent=0);
+
+    /** Current revision of the library, it changes every time the library is modified */
+    QByteArray getRevision(qulonglong libraryId);
+
+    /** Must be called after the server writes to the DB of a library */
+    void libraryUpdated(qulonglong libraryId);
+
+    /** Must be called after the server writes to the DB of all the libraries */
+    void librariesUpdated();
+
+    /**
+      Writes the listing to the response, build is only called if the listing isn't
+      cached for the current revision of the library. The Content-Type header has to
+      be set by the caller.
+      @param listing identifies the listing in the library, e.g. "folder/1"
+    */
+    void serviceListing(HttpRequest& request, HttpResponse& response, qulonglong libraryId,
+                        const QString& listing, std::function<QByteArray()> build);
+
+    Stats stats();
+
+    /** True if any of the entity tags in an If-None-Match header matches etag (weak comparison) */
+    static bool matchesETag(const QByteArray& ifNoneMatch, const QByteArray& etag);
+
+private:
+    QCache<QString,QByteArray> cache;
+    QHash<qulonglong,quint64> revisions; //writes done by the server
+    quint64 allRevisions;
+    QMutex mutex;
+
+    quint64 hits;
+    quint64 misses;
+    quint64 notModified;
+};
+
+#endif // YACREADERHTTPCACHE_H
@@ -1,126 +1,217 @@
 #include "yacreader_http_session.h"
 
+#include <QCoreApplication>
+#include <QThread>
+
 YACReaderHttpSession::YACReaderHttpSession(QObject *parent)
-    : QObject(parent), comic(nullptr), remoteComic(nullptr), comicId(0), remoteComicId(0)
+    : QObject(parent), comicId(0), remoteComicId(0), mutex(QMutex::Recursive)
 {
 
 }
 
+//the last request using the session deletes it, the comics still loading are deleted by their threads
 YACReaderHttpSession::~YACReaderHttpSession()
 {
-    if(comic != nullptr)
-        delete comic;
-
-    if(remoteComic != nullptr)
-        delete remoteComic;
+    dismissCurrentComic();
+    dismissCurrentRemoteComic();
 }
 
 bool YACReaderHttpSession::isComicOnDevice(const QString & hash)
 {
+    QMutexLocker locker(&mutex);
     return comicsOnDevice.contains(hash);
 }
 
 bool YACReaderHttpSession::isComicDownloaded(const QString & hash)
 {
+    QMutexLocker locker(&mutex);
     return downloadedComics.contains(hash);
 }
 
 void YACReaderHttpSession::setComicOnDevice(const QString & hash)
 {
+    QMutexLocker locker(&mutex);
     comicsOnDevice.insert(hash);
 }
 
 void YACReaderHttpSession::setComicsOnDevice(const QSet<QString> & set)
 {
+    QMutexLocker locker(&mutex);
     comicsOnDevice = set;
 }
 
 void YACReaderHttpSession::setDownloadedComic(const QString & hash)
 {
+    QMutexLocker locker(&mutex);
     downloadedComics.insert(hash);
 }
 
 QSet<QString> YACReaderHttpSession::getComicsOnDevice()
 {
+    QMutexLocker locker(&mutex);
     return comicsOnDevice ;
 }
 
 QSet<QString> YACReaderHttpSession::getDownloadedComics()
 {
+    QMutexLocker locker(&mutex);
     return downloadedComics ;
 }
 
 void YACReaderHttpSession::clearComics()
 {
+    QMutexLocker locker(&mutex);
     comicsOnDevice.clear();
     downloadedComics.clear();
 }
 //current comic (import)
 qulonglong YACReaderHttpSession::getCurrentComicId()
 {
+    QMutexLocker locker(&mutex);
     return comicId;
 }
 
-Comic* YACReaderHttpSession::getCurrentComic()
+QSharedPointer<Comic> YACReaderHttpSession::getCurrentComic()
 {
+    QMutexLocker locker(&mutex);
     return comic;
 }
 
 void YACReaderHttpSession::dismissCurrentComic()
 {
-    if(comic != nullptr)
+    QMutexLocker locker(&mutex);
+    if(!comic.isNull())
     {
-        comic->deleteLater();
-        comic = nullptr;
+        //stops loading it, the requests still using it keep the pages already loaded
+        comic->invalidate();
+        comic.clear();
     }
+    comicHandle.reset();
 }
 
-void YACReaderHttpSession::setCurrentComic(qulonglong id, Comic * comic)
+void YACReaderHttpSession::setCurrentComic(qulonglong id, QSharedPointer<Comic> comic)
 {
+    QMutexLocker locker(&mutex);
     dismissCurrentComic();
     comicId = id;
     this->comic = comic;
 }
 
+void YACReaderHttpSession::setCurrentComic(qulonglong id, const YACReaderComicHandle &handle)
+{
+    QMutexLocker locker(&mutex);
+    dismissCurrentComic();
+    comicId = id;
+    comicHandle = handle;
+}
+
 //current comic (read)
 qulonglong YACReaderHttpSession::getCurrentRemoteComicId()
 {
+    QMutexLocker locker(&mutex);
     return remoteComicId ;
 }
 
-Comic* YACReaderHttpSession::getCurrentRemoteComic()
+QSharedPointer<Comic> YACReaderHttpSession::getCurrentRemoteComic()
 {
+    QMutexLocker locker(&mutex);
     return remoteComic ;
 }
 
 void YACReaderHttpSession::dismissCurrentRemoteComic()
 {
-    if(remoteComic != nullptr)
+    QMutexLocker locker(&mutex);
+    if(!remoteComic.isNull())
     {
-        remoteComic->deleteLater();
-        remoteComic = nullptr;
+        //stops loading it, the requests still using it keep the pages already loaded
+        remoteComic->invalidate();
+        remoteComic.clear();
     }
+    remoteComicHandle.reset();
 }
 
-void YACReaderHttpSession::setCurrentRemoteComic(qulonglong id, Comic * comic)
+void YACReaderHttpSession::setCurrentRemoteComic(qulonglong id, QSharedPointer<Comic> comic)
 {
+    QMutexLocker locker(&mutex);
     dismissCurrentRemoteComic();
     remoteComicId = id;
     remoteComic = comic;
 }
 
+void YACReaderHttpSession::setCurrentRemoteComic(qulonglong id, const YACReaderComicHandle &handle)
+{
+    QMutexLocker locker(&mutex);
+    dismissCurrentRemoteComic();
+    remoteComicId = id;
+    remoteComicHandle = handle;
+}
+
+qint64 YACReaderHttpSession::getLoadedBytes()
+{
+    QMutexLocker locker(&mutex);
+    qint64 bytes = 0;
+
+    if(!comic.isNull())
+        bytes += comic->loadedBytes();
+
+    if(!remoteComic.isNull())
+        bytes += remoteComic->loadedBytes();
+
+    return bytes;
+}
+
+qint64 YACReaderHttpSession::dismissLoadedComics()
+{
+    QMutexLocker locker(&mutex);
+
+    qint64 bytes = getLoadedBytes();
+    dismissCurrentComic();
+    dismissCurrentRemoteComic();
+
+    return bytes;
+}
+
+QSharedPointer<Comic> YACReaderHttpSession::loadComic(Comic * comic, const QString & path)
+{
+    QSharedPointer<Comic> comicFile(comic);
+
+    QThread * thread = new QThread();
+    //the request threads don't run an event loop, the main thread deletes the thread when it finishes
+    thread->moveToThread(QCoreApplication::instance()->thread());
+    comic->moveToThread(thread);
+
+    //the thread ends as soon as the comic is loaded, has failed or has been invalidated
+    QObject::connect(thread, &QThread::started, [comic, thread]() {
+        QMetaObject::invokeMethod(comic, "process", Qt::DirectConnection);
+        thread->quit();
+    });
+
+    //if the comic has been dismissed while loading, the last reference is released here
+    QSharedPointer<Comic> * loading = new QSharedPointer<Comic>(comicFile);
+    QObject::connect(thread, &QThread::finished, [loading]() { delete loading; });
+    QObject::connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
+
+    comic->load(path);
+    thread->start();
+
+    return comicFile;
+}
+
 QString YACReaderHttpSession::getDeviceType()
 {
+    QMutexLocker locker(&mutex);
     return device;
 }
 
 QString YACReaderHttpSession::getDisplayType()
 {
+    QMutexLocker locker(&mutex);
     return display;
 }
 
 void YACReaderHttpSession::setDeviceType(const QString & device)
 {
+    QMutexLocker locker(&mutex);
     //comicsOnDevice.clear(); //TODO crear un m�todo clear que limpie la sesi�n completamente
     //downloadedComics.clear();
     this->device = device;
@@ -128,16 +219,31 @@ void YACReaderHttpSession::setDeviceType(const QString & device)
 
 void YACReaderHttpSession::setDisplayType(const QString & display)
 {
+    QMutexLocker locker(&mutex);
     this->display = display;
 }
 
+YACReaderPageVariants::Profile YACReaderHttpSession::getPageProfile()
+{
+    QMutexLocker locker(&mutex);
+    return pageProfile;
+}
+
+void YACReaderHttpSession::setPageProfile(const YACReaderPageVariants::Profile & profile)
+{
+    QMutexLocker locker(&mutex);
+    pageProfile = profile;
+}
+
 void YACReaderHttpSession::clearNavigationPath()
 {
+    QMutexLocker locker(&mutex);
     navigationPath.clear();
 }
 
 QPair<qulonglong, quint32> YACReaderHttpSession::popNavigationItem()
 {
+    QMutexLocker locker(&mutex);
     if(navigationPath.isEmpty() == false)
         return navigationPath.pop();
     return QPair<qulonglong, quint32>();
@@ -145,6 +251,7 @@ QPair<qulonglong, quint32> YACReaderHttpSession::popNavigationItem()
 
 QPair<qulonglong, quint32> YACReaderHttpSession::topNavigationItem()
 {
+    QMutexLocker locker(&mutex);
     if(navigationPath.isEmpty() == false)
         return navigationPath.top();
     return QPair<qulonglong, quint32>();
@@ -152,11 +259,13 @@ QPair<qulonglong, quint32> YACReaderHttpSession::topNavigationItem()
 
 void YACReaderHttpSession::pushNavigationItem(const QPair<qulonglong, quint32> &item)
 {
+    QMutexLocker locker(&mutex);
     navigationPath.push(item);
 }
 
 void YACReaderHttpSession::updateTopItem(const QPair<qulonglong, quint32> &item)
 {
+    QMutexLocker locker(&mutex);
      if(navigationPath.isEmpty() == false)
      {
         navigationPath.pop();
@@ -170,5 +279,6 @@ void YACReaderHttpSession::updateTopItem(const QPair<qulonglong, quint32> &item)
 
 QStack<QPair<qulonglong, quint32> > YACReaderHttpSession::getNavigationPath()
 {
+    QMutexLocker locker(&mutex);
     return navigationPath;
 }
@@ -2,11 +2,16 @@
 #define YACREADERHTTPSESSION_H
 
 #include <QObject>
+#include <QMutex>
 
 #include "comic.h"
+#include "yacreader_comic_pages.h"
+#include "yacreader_page_variants.h"
 
 
 
+//sessions are shared by the requests of a client (served in different threads) and the session store,
+//every method locks the session
 class YACReaderHttpSession : public QObject
 {
     Q_OBJECT
@@ -25,15 +30,25 @@ public:
 
     //current comic (import)
     qulonglong getCurrentComicId();
-    Comic * getCurrentComic();
+    QSharedPointer<Comic> getCurrentComic();
     void dismissCurrentComic();
-    void setCurrentComic(qulonglong id, Comic * comic);
+    void setCurrentComic(qulonglong id, QSharedPointer<Comic> comic);
+    void setCurrentComic(qulonglong id, const YACReaderComicHandle & handle);
 
     //current comic (read)
     qulonglong getCurrentRemoteComicId();
-    Comic * getCurrentRemoteComic();
+    QSharedPointer<Comic> getCurrentRemoteComic();
     void dismissCurrentRemoteComic();
-    void setCurrentRemoteComic(qulonglong id, Comic * comic);
+    void setCurrentRemoteComic(qulonglong id, QSharedPointer<Comic> comic);
+    void setCurrentRemoteComic(qulonglong id, const YACReaderComicHandle & handle);
+
+    //memory held by the comics loaded in this session
+    qint64 getLoadedBytes();
+    //dismisses both comics, returns the memory they were holding
+    qint64 dismissLoadedComics();
+
+    //starts loading the comic in its own thread, the thread holds a reference until the comic is loaded
+    static QSharedPointer<Comic> loadComic(Comic * comic, const QString & path);
 
     //device identification
     QString getDeviceType();
@@ -41,6 +56,10 @@ public:
     void setDeviceType(const QString & device);
     void setDisplayType(const QString & display);
 
+    //size and format of the pages served to the device
+    YACReaderPageVariants::Profile getPageProfile();
+    void setPageProfile(const YACReaderPageVariants::Profile & profile);
+
     void clearNavigationPath();
     QPair<qulonglong, quint32> popNavigationItem();
     QPair<qulonglong, quint32> topNavigationItem();
@@ -60,13 +79,21 @@ private:
 
     QString device;
     QString display;
+    YACReaderPageVariants::Profile pageProfile;
 
     qulonglong comicId;
     qulonglong remoteComicId;
-    Comic * comic;
-    Comic * remoteComic;
+    //the requests using a comic hold a reference too, the last one deletes it
+    QSharedPointer<Comic> comic;
+    QSharedPointer<Comic> remoteComic;
+
+    //comics read page by page are shared by all the sessions in Static::comicPages
+    YACReaderComicHandle comicHandle;
+    YACReaderComicHandle remoteComicHandle;
 
     QStack<QPair<qulonglong, quint32> > navigationPath; /* folder_id, page_number */
+
+    QMutex mutex;
 };
 
 #endif // YACREADERHTTPSESSION_H
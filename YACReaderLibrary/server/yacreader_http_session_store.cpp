@@ -4,44 +4,121 @@
 
 #include "httpsessionstore.h"
 
+#include "QsLog.h"
 
+YACReaderHttpSessionStore::YACReaderHttpSessionStore(HttpSessionStore *sessionStore, QSettings *settings, QObject *parent)
+    : QObject(parent), sessionStore(sessionStore), expired(0), evicted(0), dismissedComics(0)
+{
+    idleTimeout = settings->value("idleTimeout","3600000").toLongLong();
+    maxSessions = settings->value("maxSessions","100").toInt();
+    maxComicsMemory = settings->value("maxComicsMemory","268435456").toLongLong();
 
-YACReaderHttpSessionStore::YACReaderHttpSessionStore(HttpSessionStore *sessionStore, QObject *parent)
-    : QObject(parent), sessionStore(sessionStore)
-{
-    //sessions are no longer http sessions in v2, we need another mechanism for cleaning
-
-    //connect(&cleanupTimer,SIGNAL(timeout()),this,SLOT(sessionTimerEvent()));
-    //cleanupTimer.start(60000);
+    //sessions are no longer http sessions in v2, they expire when they are not used
+    connect(&cleanupTimer,SIGNAL(timeout()),this,SLOT(sessionTimerEvent()));
+    cleanupTimer.start(60000);
 }
 
-void YACReaderHttpSessionStore::addYACReaderHttpSession(const QByteArray &httpSessionId, YACReaderHttpSession *yacreaderHttpSession)
+void YACReaderHttpSessionStore::addYACReaderHttpSession(const QByteArray &httpSessionId, QSharedPointer<YACReaderHttpSession> yacreaderHttpSession)
 {
     QMutexLocker locker(&mutex);
 
     sessions.insert(httpSessionId, yacreaderHttpSession);
+    lastAccess.insert(httpSessionId, QDateTime::currentMSecsSinceEpoch());
+
+    while(sessions.size() > maxSessions)
+    {
+        QByteArray oldest;
+        qint64 oldestAccess = 0;
+        QHash<QByteArray, qint64>::const_iterator itr;
+        for(itr = lastAccess.constBegin(); itr != lastAccess.constEnd(); ++itr)
+        {
+            if(itr.key() != httpSessionId && (oldest.isNull() || itr.value() < oldestAccess))
+            {
+                oldest = itr.key();
+                oldestAccess = itr.value();
+            }
+        }
+
+        if(oldest.isNull())
+            break;
+
+        QLOG_DEBUG() << "Too many sessions, removing session " << oldest;
+        removeSession(oldest);
+        evicted++;
+    }
+}
+
+QSharedPointer<YACReaderHttpSession> YACReaderHttpSessionStore::getYACReaderSessionHttpSession(const QByteArray &httpSessionId)
+{
+    QMutexLocker locker(&mutex);
+
+    QSharedPointer<YACReaderHttpSession> session = sessions.value(httpSessionId);
+    if(!session.isNull())
+        lastAccess.insert(httpSessionId, QDateTime::currentMSecsSinceEpoch());
+
+    return session;
 }
 
-YACReaderHttpSession *YACReaderHttpSessionStore::getYACReaderSessionHttpSession(const QByteArray &httpSessionId)
+YACReaderHttpSessionStore::Stats YACReaderHttpSessionStore::stats()
 {
     QMutexLocker locker(&mutex);
 
-    return sessions.value(httpSessionId, nullptr);
+    Stats stats;
+    stats.sessions = sessions.size();
+    stats.bytes = 0;
+    stats.expired = expired;
+    stats.evicted = evicted;
+    stats.dismissedComics = dismissedComics;
+
+    foreach(QSharedPointer<YACReaderHttpSession> session, sessions)
+        stats.bytes += session->getLoadedBytes();
+
+    return stats;
+}
+
+void YACReaderHttpSessionStore::removeSession(const QByteArray &httpSessionId)
+{
+    //the requests still using the session keep it alive, it is deleted when they finish
+    sessions.remove(httpSessionId);
+    lastAccess.remove(httpSessionId);
 }
 
 void YACReaderHttpSessionStore::sessionTimerEvent()
-{
-    //sessions are no longer http sessions in v2, we are using a token, so sessionStore->getSession(id).isNull() is always true.
-    /*QMutexLocker locker(&mutex);
-    for(const QByteArray &id : sessions.keys())
+{
+    QMutexLocker locker(&mutex);
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    foreach(const QByteArray &id, sessions.keys())
     {
-        if(sessionStore->getSession(id).isNull())
+        if(now - lastAccess.value(id) > idleTimeout)
         {
-            YACReaderHttpSession *session = sessions.value(id, nullptr);
-            if(session != nullptr)
-                delete session;
+            QLOG_DEBUG() << "Session expired " << id;
+            removeSession(id);
+            expired++;
+        }
+    }
 
-            sessions.remove(id);
+    //memory pressure, the comics of the least recently used sessions are dismissed
+    QMultiMap<qint64, QByteArray> byAccess;
+    qint64 bytes = 0;
+    QMap<QByteArray, QSharedPointer<YACReaderHttpSession> >::const_iterator itr;
+    for(itr = sessions.constBegin(); itr != sessions.constEnd(); ++itr)
+    {
+        qint64 sessionBytes = itr.value()->getLoadedBytes();
+        if(sessionBytes > 0)
+        {
+            bytes += sessionBytes;
+            byAccess.insert(lastAccess.value(itr.key()), itr.key());
         }
-    }*/
+    }
+
+    QMultiMap<qint64, QByteArray>::const_iterator oldest = byAccess.constBegin();
+    while(bytes > maxComicsMemory && oldest != byAccess.constEnd())
+    {
+        QSharedPointer<YACReaderHttpSession> session = sessions.value(oldest.value());
+        bytes -= session->dismissLoadedComics();
+        dismissedComics++;
+        ++oldest;
+    }
 }
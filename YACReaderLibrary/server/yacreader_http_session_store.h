@@ -9,26 +9,64 @@
 class HttpSessionStore;
 class YACReaderHttpSession;
 
-
+/**
+  Stores the YACReader sessions (v1 http sessions and v2 x-request-id tokens).
+  <p>
+  Sessions not used for idleTimeout milliseconds are deleted, when there are more
+  than maxSessions the least recently used is deleted. If the comics loaded by the
+  sessions use more than maxComicsMemory bytes, the comics of the least recently
+  used sessions are dismissed.
+  <p>
+  The sessions are shared with the requests using them, a removed session is deleted
+  when the last request releases it.
+  <p>
+  Settings:
+  <code><pre>
+  idleTimeout=3600000
+  maxSessions=100
+  maxComicsMemory=268435456
+  </pre></code>
+*/
 
 class YACReaderHttpSessionStore : public QObject
 {
     Q_OBJECT
 public:
-    explicit YACReaderHttpSessionStore(HttpSessionStore *sessionStore, QObject *parent = 0);
+    struct Stats {
+        int sessions;
+        qint64 bytes; //held by the comics loaded in the sessions
+        quint64 expired;
+        quint64 evicted;
+        quint64 dismissedComics;
+    };
+
+    explicit YACReaderHttpSessionStore(HttpSessionStore *sessionStore, QSettings *settings, QObject *parent = 0);
+
+    void addYACReaderHttpSession(const QByteArray & httpSessionId, QSharedPointer<YACReaderHttpSession> yacreaderHttpSession);
+    QSharedPointer<YACReaderHttpSession> getYACReaderSessionHttpSession(const QByteArray & httpSessionId);
 
-    void addYACReaderHttpSession(const QByteArray & httpSessionId, YACReaderHttpSession *yacreaderHttpSession);
-    YACReaderHttpSession *getYACReaderSessionHttpSession(const QByteArray & httpSessionId);
+    Stats stats();
 
 signals:
 
 public slots:
 
 private:
-    QMap<QByteArray, YACReaderHttpSession*> sessions;
+    void removeSession(const QByteArray & httpSessionId);
+
+    QMap<QByteArray, QSharedPointer<YACReaderHttpSession> > sessions;
+    QHash<QByteArray, qint64> lastAccess;
     HttpSessionStore *sessionStore;
     QTimer cleanupTimer;
 
+    qint64 idleTimeout;
+    int maxSessions;
+    qint64 maxComicsMemory;
+
+    quint64 expired;
+    quint64 evicted;
+    quint64 dismissedComics;
+
     QMutex mutex;
 
 private slots:
@@ -0,0 +1,242 @@
+#include "yacreader_page_variants.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QBuffer>
+#include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QPainter>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+
+#include "QsLog.h"
+
+YACReaderPageVariants::YACReaderPageVariants(QSettings* settings, QObject* parent)
+    :QObject(parent), diskBytes(-1), renderSlots(qMax(settings->value("resizeThreads","2").toInt(),1)),
+      hits(0), misses(0), untouched(0), fallbacks(0)
+{
+    cacheDir = settings->value("cacheDir").toString();
+    if(cacheDir.isEmpty())
+        cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)+"/page_variants";
+    maxDiskBytes = settings->value("diskCacheSize","268435456").toLongLong();
+    defaultQuality = settings->value("quality","80").toInt();
+    resizeWait = settings->value("resizeWait","1000").toInt();
+    webpSupported = QImageWriter::supportedImageFormats().contains("webp");
+}
+
+QByteArray YACReaderPageVariants::getPage(const QByteArray &pageData, const Profile &profile, QByteArray &contentType)
+{
+    contentType = "image/jpeg";
+    if(profile.isNull() || pageData.isEmpty())
+        return pageData;
+
+    QByteArray format = (profile.format == "webp" && webpSupported) ? "webp" : "jpg";
+    int quality = profile.quality > 0 ? qMin(profile.quality,100) : defaultQuality;
+
+    //only the header is read to know if the page has to be changed
+    QBuffer buffer;
+    buffer.setData(pageData);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    QSize size = reader.size();
+    QByteArray sourceFormat = reader.format();
+    if(sourceFormat == "jpeg")
+        sourceFormat = "jpg";
+
+    bool fits = size.isValid() &&
+            (profile.maxWidth <= 0 || size.width() <= profile.maxWidth) &&
+            (profile.maxHeight <= 0 || size.height() <= profile.maxHeight);
+    if(!size.isValid() || (fits && (profile.format.isEmpty() || sourceFormat == format)))
+    {
+        QMutexLocker locker(&mutex);
+        untouched++;
+        return pageData;
+    }
+
+    QString fileName = QString("%1_%2x%3_q%4.%5")
+            .arg(QString(QCryptographicHash::hash(pageData, QCryptographicHash::Sha1).toHex()))
+            .arg(qMax(profile.maxWidth,0)).arg(qMax(profile.maxHeight,0)).arg(quality).arg(QString(format));
+
+    contentType = format == "webp" ? "image/webp" : "image/jpeg";
+
+    QFile file(cacheDir+"/"+fileName);
+    if(file.open(QIODevice::ReadOnly))
+    {
+        QByteArray data = file.readAll();
+        if(!data.isEmpty())
+        {
+            QMutexLocker locker(&mutex);
+            hits++;
+            return data;
+        }
+    }
+
+    //the workers can't wait for the resize slots, the original page is better than a stalled server
+    bool resize = false;
+    {
+        QMutexLocker locker(&mutex);
+        if(!rendering.contains(fileName))
+        {
+            rendering.insert(fileName);
+            resize = true;
+        }
+    }
+
+    if(!resize || !renderSlots.tryAcquire(1, resizeWait))
+    {
+        QMutexLocker locker(&mutex);
+        if(resize)
+            rendering.remove(fileName);
+        fallbacks++;
+        contentType = "image/jpeg";
+        return pageData;
+    }
+
+    {
+        QMutexLocker locker(&mutex);
+        misses++;
+    }
+
+    Profile variant = profile;
+    variant.quality = quality;
+
+    QByteArray data = render(pageData, variant, format);
+    renderSlots.release();
+
+    if(!data.isEmpty())
+        store(fileName, data);
+
+    {
+        QMutexLocker locker(&mutex);
+        rendering.remove(fileName);
+    }
+
+    if(data.isEmpty())
+    {
+        contentType = "image/jpeg";
+        return pageData;
+    }
+
+    return data;
+}
+
+YACReaderPageVariants::Stats YACReaderPageVariants::stats()
+{
+    Stats stats;
+
+    {
+        QMutexLocker locker(&mutex);
+        stats.hits = hits;
+        stats.misses = misses;
+        stats.untouched = untouched;
+        stats.fallbacks = fallbacks;
+    }
+
+    QMutexLocker locker(&diskMutex);
+    stats.diskBytes = qMax(diskBytes,qint64(0));
+    return stats;
+}
+
+YACReaderPageVariants::Profile YACReaderPageVariants::profileFromRequest(const HttpRequest &request)
+{
+    Profile profile;
+    profile.maxWidth = request.getParameter("width").toInt();
+    profile.maxHeight = request.getParameter("height").toInt();
+    profile.quality = request.getParameter("quality").toInt();
+
+    QByteArray format = request.getParameter("format").toLower();
+    if(format == "jpeg")
+        format = "jpg";
+    if(format == "jpg" || format == "webp")
+        profile.format = format;
+
+    return profile;
+}
+
+QByteArray YACReaderPageVariants::render(const QByteArray &pageData, const Profile &profile, const QByteArray &format)
+{
+    QImage image;
+    if(!image.loadFromData(pageData))
+        return QByteArray();
+
+    int width = profile.maxWidth > 0 ? profile.maxWidth : image.width();
+    int height = profile.maxHeight > 0 ? profile.maxHeight : image.height();
+
+    //never upscaled, smooth transformation averages the source pixels when downscaling
+    if(image.width() > width || image.height() > height)
+        image = image.scaled(width, height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    //jpg has no alpha channel, transparent areas are white like the pages
+    if(format == "jpg" && image.hasAlphaChannel())
+    {
+        QImage opaque(image.size(), QImage::Format_RGB32);
+        opaque.fill(Qt::white);
+        QPainter painter(&opaque);
+        painter.drawImage(0, 0, image);
+        painter.end();
+        image = opaque;
+    }
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if(!image.save(&buffer, format.constData(), profile.quality))
+    {
+        QLOG_ERROR() << "Unable to encode page as" << format;
+        return QByteArray();
+    }
+
+    return data;
+}
+
+void YACReaderPageVariants::store(const QString &fileName, const QByteArray &data)
+{
+    //getPage only takes mutex, the requests are not blocked by the disk
+    QMutexLocker locker(&diskMutex);
+
+    //a variant already stored is replaced, its size is only counted once
+    QFileInfo previous(cacheDir+"/"+fileName);
+    qint64 previousSize = previous.exists() ? previous.size() : 0;
+
+    //QSaveFile, other threads may be reading the same variant
+    QDir().mkpath(cacheDir);
+    QSaveFile file(cacheDir+"/"+fileName);
+    if(!file.open(QIODevice::WriteOnly))
+        return;
+    file.write(data);
+    if(!file.commit())
+        return;
+
+    if(diskBytes >= 0)
+        diskBytes += data.size() - previousSize;
+    trim();
+}
+
+void YACReaderPageVariants::trim()
+{
+    QDir dir(cacheDir);
+
+    if(diskBytes < 0)
+    {
+        diskBytes = 0;
+        foreach(QFileInfo info, dir.entryInfoList(QDir::Files))
+            diskBytes += info.size();
+    }
+
+    if(diskBytes <= maxDiskBytes)
+        return;
+
+    //oldest first, some room is left so the cache isn't trimmed on every new variant
+    QFileInfoList files = dir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 target = maxDiskBytes - maxDiskBytes / 10;
+    foreach(QFileInfo info, files)
+    {
+        if(diskBytes <= target)
+            break;
+        if(QFile::remove(info.absoluteFilePath()))
+            diskBytes -= info.size();
+    }
+}
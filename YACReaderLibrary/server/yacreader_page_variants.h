@@ -0,0 +1,100 @@
+#ifndef YACREADERPAGEVARIANTS_H
+#define YACREADERPAGEVARIANTS_H
+
+#include <QObject>
+#include <QMutex>
+#include <QSemaphore>
+#include <QSettings>
+#include <QSet>
+
+#include "httprequest.h"
+
+/**
+  Downscaled and re-encoded versions of the comic pages, sized for the display of the client.
+  <p>
+  A page profile limits the size of the pages and sets the format (jpg or webp, jpg is used
+  if Qt can't write webp) and the quality. Pages that already fit and use the requested
+  format are served untouched.
+  <p>
+  The variants are identified by the content of the original page, so they are valid forever
+  and the same page is only resized once for each profile. They are stored in cacheDir, when
+  they use more than diskCacheSize bytes the oldest ones are removed. At most resizeThreads
+  pages are resized at the same time, a request waits up to resizeWait ms for a free slot and
+  then gets the original page. A variant being resized for another request isn't resized
+  again, the original page is sent meanwhile.
+  <p>
+  Settings:
+  <code><pre>
+  cacheDir=
+  diskCacheSize=268435456
+  resizeThreads=2
+  resizeWait=1000
+  quality=80
+  </pre></code>
+  An empty cacheDir uses the cache location of the application.
+*/
+
+class YACReaderPageVariants : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(YACReaderPageVariants)
+public:
+    struct Profile {
+        Profile() : maxWidth(0), maxHeight(0), quality(0) {}
+
+        int maxWidth; //0 = no limit
+        int maxHeight;
+        QByteArray format; //"jpg", "webp" or empty (jpg if the page has to be re-encoded)
+        int quality; //0 = default
+
+        bool isNull() const { return maxWidth <= 0 && maxHeight <= 0 && format.isEmpty(); }
+    };
+
+    struct Stats {
+        quint64 hits;
+        quint64 misses;
+        quint64 untouched;
+        quint64 fallbacks; //original pages sent because the variant couldn't be resized in time
+        qint64 diskBytes;
+    };
+
+    YACReaderPageVariants(QSettings* settings, QObject* parent=0);
+
+    /**
+      Page data for the profile.
+      @param pageData original page, it is returned if the profile doesn't change it
+      @param contentType is set to the MIME type of the returned data
+    */
+    QByteArray getPage(const QByteArray & pageData, const Profile & profile, QByteArray & contentType);
+
+    Stats stats();
+
+    /** Profile in the query parameters: width, height, format and quality */
+    static Profile profileFromRequest(const HttpRequest & request);
+
+private:
+    QByteArray render(const QByteArray & pageData, const Profile & profile, const QByteArray & format);
+    void store(const QString & fileName, const QByteArray & data);
+
+    /** Removes the oldest variants until the cache fits in the budget, the caller owns diskMutex */
+    void trim();
+
+    QString cacheDir;
+    qint64 maxDiskBytes;
+    qint64 diskBytes; //-1 until the cache dir is scanned
+    int defaultQuality;
+    bool webpSupported;
+    int resizeWait;
+
+    QSemaphore renderSlots;
+    QSet<QString> rendering; //variants being resized
+    QMutex mutex; //counters and rendering
+    QMutex diskMutex; //writes to the cache dir and diskBytes
+
+    quint64 hits;
+    quint64 misses;
+    quint64 untouched;
+    quint64 fallbacks;
+};
+
+#endif // YACREADERPAGEVARIANTS_H
@@ -0,0 +1,151 @@
+#include "yacreader_route_table.h"
+
+#include <QList>
+#include <QPair>
+
+static bool isNumber(const QByteArray& segment)
+{
+    if(segment.isEmpty())
+        return false;
+
+    for(int i=0;i<segment.size();i++)
+        if(segment.at(i) < '0' || segment.at(i) > '9')
+            return false;
+
+    return true;
+}
+
+bool YACReaderRouteTable::isCoverFileName(const QByteArray& segment)
+{
+    if(segment.size() <= 4 || !segment.endsWith(".jpg"))
+        return false;
+
+    for(int i=0;i<segment.size()-4;i++)
+    {
+        char c = segment.at(i);
+        if(!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+            return false;
+    }
+
+    return true;
+}
+
+YACReaderRouteTable::Node::~Node()
+{
+    qDeleteAll(literals);
+    delete number;
+    delete file;
+}
+
+YACReaderRouteTable::YACReaderRouteTable()
+{
+
+}
+
+YACReaderRouteTable::~YACReaderRouteTable()
+{
+
+}
+
+void YACReaderRouteTable::add(const QByteArray &pattern, Service service, const QByteArray &flag)
+{
+    Node* node = &root;
+    foreach(const QByteArray& segment, pattern.split('/'))
+    {
+        if(segment.isEmpty())
+            continue;
+
+        if(segment.startsWith(':'))
+        {
+            if(node->number == 0)
+            {
+                node->number = new Node;
+                node->numberName = segment.mid(1);
+            }
+            Q_ASSERT(node->numberName == segment.mid(1));
+            node = node->number;
+        }
+        else if(segment.startsWith('*'))
+        {
+            if(node->file == 0)
+            {
+                node->file = new Node;
+                node->fileName = segment.mid(1);
+            }
+            Q_ASSERT(node->fileName == segment.mid(1));
+            node = node->file;
+        }
+        else
+        {
+            Node* next = node->literals.value(segment);
+            if(next == 0)
+            {
+                next = new Node;
+                node->literals.insert(segment, next);
+            }
+            node = next;
+        }
+    }
+
+    node->service = service;
+    node->flag = flag;
+    node->pattern = pattern;
+}
+
+YACReaderRouteTable::Service YACReaderRouteTable::match(const QByteArray &path, HttpRequest &request, QByteArray *pattern) const
+{
+    const Node* node = &root;
+    QList<QPair<QByteArray,QVariant> > parameters;
+
+    int start = 0;
+    int size = path.size();
+    if(size > 1 && path.endsWith('/'))
+        size--;
+
+    while(start < size)
+    {
+        if(path.at(start) == '/')
+        {
+            start++;
+            continue;
+        }
+
+        int end = path.indexOf('/', start);
+        if(end < 0 || end > size)
+            end = size;
+        QByteArray segment = path.mid(start, end - start);
+        start = end;
+
+        //literal segments take precedence over parameters
+        const Node* next = node->literals.value(segment);
+        if(next == 0 && node->number != 0 && isNumber(segment))
+        {
+            parameters.append(qMakePair(node->numberName, QVariant(segment.toULongLong())));
+            next = node->number;
+        }
+        if(next == 0 && node->file != 0 && isCoverFileName(segment))
+        {
+            parameters.append(qMakePair(node->fileName, QVariant(QString::fromLatin1(segment))));
+            next = node->file;
+        }
+
+        if(next == 0)
+            return 0;
+
+        node = next;
+    }
+
+    if(node->service == 0)
+        return 0;
+
+    for(int i=0;i<parameters.size();i++)
+        request.setPathParameter(parameters.at(i).first, parameters.at(i).second);
+
+    if(!node->flag.isEmpty())
+        request.setPathParameter(node->flag, true);
+
+    if(pattern != 0)
+        *pattern = node->pattern;
+
+    return node->service;
+}
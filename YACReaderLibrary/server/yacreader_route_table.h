@@ -0,0 +1,76 @@
+#ifndef YACREADERROUTETABLE_H
+#define YACREADERROUTETABLE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QVariant>
+
+#include "httprequest.h"
+#include "httpresponse.h"
+
+/**
+  Maps request paths to controllers, the routes are compiled once into a tree of path segments.
+  <p>
+  Route patterns are made of literal segments and parameters:
+  <code><pre>
+  /v2/library/:libraryId/comic/:comicId/page/:page
+  /v2/library/:libraryId/cover/*fileName
+  </pre></code>
+  :name matches a number, *name matches a cover file name (hexadecimal hash + .jpg). The
+  values are set as path parameters of the request, numbers as qulonglong. A trailing /
+  in the path is ignored.
+*/
+
+class YACReaderRouteTable
+{
+public:
+    typedef void (*Service)(HttpRequest& request, HttpResponse& response);
+
+    YACReaderRouteTable();
+    ~YACReaderRouteTable();
+
+    /**
+      Add a route.
+      @param flag if not empty, this path parameter is set to true for this route (e.g. "remote")
+    */
+    void add(const QByteArray& pattern, Service service, const QByteArray& flag = QByteArray());
+
+    /**
+      Find the controller of a (percent decoded) path, the parameters of the route are set in the request.
+      @param pattern if not null, it is set to the pattern of the route found
+      @return 0 if no route matches
+    */
+    Service match(const QByteArray& path, HttpRequest& request, QByteArray* pattern = 0) const;
+
+    /** Service for the routes handled by a stack-constructed controller */
+    template<class Controller>
+    static void serve(HttpRequest& request, HttpResponse& response)
+    {
+        Controller().service(request, response);
+    }
+
+    /** True if the name is a cover file name (hexadecimal hash + .jpg) */
+    static bool isCoverFileName(const QByteArray& segment);
+
+private:
+    Q_DISABLE_COPY(YACReaderRouteTable)
+
+    struct Node {
+        Node() : number(0), file(0), service(0) {}
+        ~Node();
+
+        QHash<QByteArray,Node*> literals;
+        Node* number;
+        QByteArray numberName;
+        Node* file;
+        QByteArray fileName;
+
+        Service service;
+        QByteArray flag;
+        QByteArray pattern;
+    };
+
+    Node root;
+};
+
+#endif // YACREADERROUTETABLE_H
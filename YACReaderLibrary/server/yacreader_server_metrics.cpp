@@ -0,0 +1,163 @@
+#include "yacreader_server_metrics.h"
+
+#include "httpconnectionhandler.h"
+#include "static.h"
+
+#include "data_base_management.h"
+
+const double YACReaderServerMetrics::bucketBounds[NumBuckets] = {0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+
+static void writeHeader(QByteArray & output, const char * name, const char * type, const char * help)
+{
+    output += QByteArray("# HELP ") + name + " " + help + "\n";
+    output += QByteArray("# TYPE ") + name + " " + type + "\n";
+}
+
+static void writeValue(QByteArray & output, const char * name, const char * type, const char * help, double value)
+{
+    writeHeader(output, name, type, help);
+    output += QByteArray(name) + " " + QByteArray::number(value, 'g', 15) + "\n";
+}
+
+static QByteArray label(const QByteArray & value)
+{
+    QByteArray escaped = value;
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return "\"" + escaped + "\"";
+}
+
+YACReaderServerMetrics::YACReaderServerMetrics(QSettings* settings, QObject* parent)
+    :QObject(parent), inFlight(0)
+{
+    enabled = settings->value("enabled",false).toBool();
+}
+
+bool YACReaderServerMetrics::isEnabled() const
+{
+    return enabled;
+}
+
+void YACReaderServerMetrics::requestStarted()
+{
+    QMutexLocker locker(&mutex);
+    inFlight++;
+}
+
+void YACReaderServerMetrics::requestFinished(const QByteArray &route, int status, qint64 microseconds, qint64 bytes)
+{
+    double seconds = microseconds / 1000000.0;
+
+    QMutexLocker locker(&mutex);
+    inFlight--;
+
+    Route & stats = routes[route];
+    stats.count++;
+    stats.seconds += seconds;
+    stats.bytes += bytes;
+    stats.statuses[status]++;
+
+    for(int i=0;i<NumBuckets;i++)
+    {
+        if(seconds <= bucketBounds[i])
+        {
+            stats.buckets[i]++;
+            break;
+        }
+    }
+}
+
+QByteArray YACReaderServerMetrics::toPrometheus()
+{
+    QByteArray output;
+
+    {
+        QMutexLocker locker(&mutex);
+
+        writeHeader(output, "yacreader_http_requests_total", "counter", "Requests served by route and status.");
+        for(QMap<QByteArray,Route>::const_iterator itr = routes.constBegin(); itr != routes.constEnd(); itr++)
+            for(QMap<int,quint64>::const_iterator status = itr->statuses.constBegin(); status != itr->statuses.constEnd(); status++)
+                output += "yacreader_http_requests_total{route=" + label(itr.key()) + ",status=\"" + QByteArray::number(status.key()) + "\"} " + QByteArray::number(status.value()) + "\n";
+
+        writeHeader(output, "yacreader_http_request_duration_seconds", "histogram", "Time spent serving the requests by route.");
+        for(QMap<QByteArray,Route>::const_iterator itr = routes.constBegin(); itr != routes.constEnd(); itr++)
+        {
+            QByteArray route = label(itr.key());
+            quint64 cumulative = 0;
+            for(int i=0;i<NumBuckets;i++)
+            {
+                cumulative += itr->buckets[i];
+                output += "yacreader_http_request_duration_seconds_bucket{route=" + route + ",le=\"" + QByteArray::number(bucketBounds[i]) + "\"} " + QByteArray::number(cumulative) + "\n";
+            }
+            output += "yacreader_http_request_duration_seconds_bucket{route=" + route + ",le=\"+Inf\"} " + QByteArray::number(itr->count) + "\n";
+            output += "yacreader_http_request_duration_seconds_sum{route=" + route + "} " + QByteArray::number(itr->seconds, 'g', 15) + "\n";
+            output += "yacreader_http_request_duration_seconds_count{route=" + route + "} " + QByteArray::number(itr->count) + "\n";
+        }
+
+        writeHeader(output, "yacreader_http_response_bytes_total", "counter", "Body bytes sent by route (covers, pages, listings...).");
+        for(QMap<QByteArray,Route>::const_iterator itr = routes.constBegin(); itr != routes.constEnd(); itr++)
+            output += "yacreader_http_response_bytes_total{route=" + label(itr.key()) + "} " + QByteArray::number(itr->bytes) + "\n";
+
+        writeValue(output, "yacreader_http_requests_in_flight", "gauge", "Requests being served.", inFlight);
+    }
+
+    writeValue(output, "yacreader_http_connections", "gauge", "Open client connections.", HttpConnectionHandler::getConnectionCount());
+
+    if(Static::yacreaderSessionStore != 0)
+    {
+        YACReaderHttpSessionStore::Stats stats = Static::yacreaderSessionStore->stats();
+        writeValue(output, "yacreader_sessions", "gauge", "Sessions of the clients.", stats.sessions);
+        writeValue(output, "yacreader_session_comic_bytes", "gauge", "Memory held by the comics loaded in the sessions.", stats.bytes);
+        writeValue(output, "yacreader_sessions_expired_total", "counter", "Sessions removed after being idle.", stats.expired);
+        writeValue(output, "yacreader_sessions_evicted_total", "counter", "Sessions removed because there were too many.", stats.evicted);
+        writeValue(output, "yacreader_session_comics_dismissed_total", "counter", "Comics unloaded from the sessions to save memory.", stats.dismissedComics);
+    }
+
+    if(Static::comicPages != 0)
+    {
+        YACReaderComicPages::Stats stats = Static::comicPages->stats();
+        writeValue(output, "yacreader_comic_pages_hits_total", "counter", "Pages served from the shared pages cache.", stats.hits);
+        writeValue(output, "yacreader_comic_pages_misses_total", "counter", "Pages extracted from the comic files.", stats.misses);
+        writeValue(output, "yacreader_comic_pages_evictions_total", "counter", "Comics evicted from the shared pages cache.", stats.evictions);
+        writeValue(output, "yacreader_comic_pages_bytes", "gauge", "Memory used by the extracted pages.", stats.bytes);
+        writeValue(output, "yacreader_comic_pages_comics", "gauge", "Comics in the shared pages cache.", stats.comics);
+        writeValue(output, "yacreader_comic_pages_open_archives", "gauge", "Comic files kept open.", stats.openArchives);
+        writeValue(output, "yacreader_comic_pages_handles", "gauge", "Comics being read by the sessions.", stats.handles);
+    }
+
+    if(Static::httpCache != 0)
+    {
+        YACReaderHttpCache::Stats stats = Static::httpCache->stats();
+        writeValue(output, "yacreader_listing_cache_hits_total", "counter", "Listings served from the cache.", stats.hits);
+        writeValue(output, "yacreader_listing_cache_misses_total", "counter", "Listings read from the DB.", stats.misses);
+        writeValue(output, "yacreader_listing_cache_not_modified_total", "counter", "Listings answered with 304 Not Modified.", stats.notModified);
+        writeValue(output, "yacreader_listing_cache_bytes", "gauge", "Memory used by the cached listings.", stats.bytes);
+        writeValue(output, "yacreader_listing_cache_listings", "gauge", "Cached listings.", stats.listings);
+    }
+
+    if(Static::pageVariants != 0)
+    {
+        YACReaderPageVariants::Stats stats = Static::pageVariants->stats();
+        writeValue(output, "yacreader_page_variants_hits_total", "counter", "Sized pages read from the disk cache.", stats.hits);
+        writeValue(output, "yacreader_page_variants_misses_total", "counter", "Pages resized and encoded.", stats.misses);
+        writeValue(output, "yacreader_page_variants_untouched_total", "counter", "Pages that already fitted the profile of the client.", stats.untouched);
+        writeValue(output, "yacreader_page_variants_fallbacks_total", "counter", "Original pages sent because the page couldn't be resized in time.", stats.fallbacks);
+        writeValue(output, "yacreader_page_variants_disk_bytes", "gauge", "Disk used by the sized pages.", stats.diskBytes);
+    }
+
+    if(Static::coverPrefetcher != 0)
+    {
+        YACReaderCoverPrefetcher::Stats stats = Static::coverPrefetcher->stats();
+        writeValue(output, "yacreader_cover_bundles_total", "counter", "Cover bundles requested with the listings.", stats.bundles);
+        writeValue(output, "yacreader_cover_prefetch_hits_total", "counter", "Covers served from memory.", stats.hits);
+        writeValue(output, "yacreader_cover_prefetch_misses_total", "counter", "Covers that weren't prefetched.", stats.misses);
+        writeValue(output, "yacreader_cover_prefetch_bytes", "gauge", "Memory used by the prefetched covers.", stats.bytes);
+        writeValue(output, "yacreader_cover_prefetch_covers", "gauge", "Prefetched covers.", stats.covers);
+    }
+
+    DataBaseManagement::OpenStats db = DataBaseManagement::openStats();
+    writeValue(output, "yacreader_db_opens_total", "counter", "Library DB connections opened.", db.opens);
+    writeValue(output, "yacreader_db_open_failures_total", "counter", "Library DB connections that couldn't be opened.", db.failures);
+    writeValue(output, "yacreader_db_open_seconds_total", "counter", "Time spent opening library DB connections.", db.microseconds / 1000000.0);
+
+    return output;
+}
@@ -0,0 +1,62 @@
+#ifndef YACREADERSERVERMETRICS_H
+#define YACREADERSERVERMETRICS_H
+
+#include <QObject>
+#include <QMap>
+#include <QMutex>
+#include <QSettings>
+
+/**
+  Counters of the server, exported in the Prometheus text format by /v2/metrics.
+  <p>
+  Each request is counted by route (the pattern in the route table) and status, with a
+  histogram of its latency and the body bytes sent. The export also includes the in-flight
+  requests, the open connections, the sessions, the caches of the server and the time spent
+  opening the library DBs.
+  <p>
+  The metrics are always collected, the endpoint is only served if it is enabled.
+  <p>
+  Settings:
+  <code><pre>
+  enabled=false
+  </pre></code>
+*/
+
+class YACReaderServerMetrics : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(YACReaderServerMetrics)
+public:
+    YACReaderServerMetrics(QSettings* settings, QObject* parent=0);
+
+    /** True if /v2/metrics can be requested */
+    bool isEnabled() const;
+
+    void requestStarted();
+    void requestFinished(const QByteArray & route, int status, qint64 microseconds, qint64 bytes);
+
+    /** All the metrics in the Prometheus text exposition format */
+    QByteArray toPrometheus();
+
+private:
+    enum { NumBuckets = 11 };
+    static const double bucketBounds[NumBuckets]; //seconds
+
+    struct Route {
+        Route() : count(0), seconds(0), bytes(0) { for(int i=0;i<NumBuckets;i++) buckets[i] = 0; }
+
+        quint64 buckets[NumBuckets]; //not cumulative
+        quint64 count;
+        double seconds;
+        quint64 bytes;
+        QMap<int,quint64> statuses;
+    };
+
+    bool enabled;
+
+    QMap<QByteArray,Route> routes;
+    int inFlight;
+    QMutex mutex;
+};
+
+#endif // YACREADERSERVERMETRICS_H
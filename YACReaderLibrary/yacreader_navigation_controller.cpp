@@ -264,6 +264,10 @@ void YACReaderNavigationController::loadIndexFromHistory(const YACReaderLibraryS
 
 void YACReaderNavigationController::selectSubfolder(const QModelIndex &sourceMIParent, int child)
 {
+    //the children of the folder are loaded lazily
+    if(libraryWindow->foldersModel->canFetchMore(sourceMIParent))
+        libraryWindow->foldersModel->fetchMore(sourceMIParent);
+
     QModelIndex dest = libraryWindow->foldersModel->index(child,0,sourceMIParent);
     libraryWindow->foldersView->setCurrentIndex(libraryWindow->foldersModelProxy->mapFromSource(dest));
     libraryWindow->historyController->updateHistory(YACReaderLibrarySourceContainer(dest,YACReaderLibrarySourceContainer::Folder));
@@ -34,6 +34,10 @@ void LibrariesUpdater::updateIfNeeded()
                 }
 
             }
+            else if(comparation == 0)
+            {
+                DataBaseManagement::addSortKeys(path);
+            }
         }
     }
 }
@@ -3,6 +3,9 @@
 #include <QSysInfo>
 #include <QDir>
 #include <QCommandLineParser>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QEventLoop>
 
 #include "comic_db.h"
 #include "db_helper.h"
@@ -69,7 +72,7 @@ int main( int argc, char ** argv )
     parser.setApplicationDescription(QCoreApplication::tr("\nYACReaderLibraryServer is the headless (no gui) version of YACReaderLibrary"));
     parser.addHelpOption();
     const QCommandLineOption versionOption = parser.addVersionOption();
-    parser.addPositionalArgument("command", "The command to execute. [start, create-library, update-library, add-library, remove-library, list-libraries]");
+    parser.addPositionalArgument("command", "The command to execute. [start, create-library, update-library, add-library, remove-library, list-libraries, metrics]");
     parser.parse(app.arguments());
 
     const QStringList args = parser.positionalArguments();
@@ -248,6 +251,52 @@ int main( int argc, char ** argv )
 
         return 0;
     }
+    else if(command == "metrics")
+    {
+        parser.clearPositionalArguments();
+        parser.addPositionalArgument("metrics", "Prints the metrics of the running server (metrics/enabled=true is needed)");
+        parser.addPositionalArgument("port", "Port of the server, by default listener/port from the settings", "[port]");
+        parser.process(app);
+
+        const QStringList args = parser.positionalArguments();
+        QString port;
+        if(args.length() > 1)
+            port = args.at(1);
+        else
+        {
+            QSettings settings(YACReader::getSettingsPath()+"/"+QCoreApplication::applicationName()+".ini",QSettings::IniFormat);
+            port = settings.value("listener/port").toString();
+        }
+
+        if(port.toInt() <= 0)
+        {
+            parser.showHelp();
+            return 0;
+        }
+
+        QNetworkAccessManager manager;
+        QEventLoop loop;
+        QNetworkReply * reply = manager.get(QNetworkRequest(QUrl(QString("http://127.0.0.1:%1/v2/metrics").arg(port))));
+        QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+        loop.exec();
+
+        int ret = 0;
+        if(reply->error() == QNetworkReply::NoError)
+            qout << reply->readAll();
+        else if(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 404)
+        {
+            std::cerr << "metrics are disabled, set metrics/enabled=true in the settings and restart the server" << std::endl;
+            ret = 1;
+        }
+        else
+        {
+            std::cerr << "unable to reach the server on port " << port.toStdString() << " : " << reply->errorString().toStdString() << std::endl;
+            ret = 1;
+        }
+
+        reply->deleteLater();
+        return ret;
+    }
     else //error
     {
         parser.process(app);
@@ -213,6 +213,8 @@ void Comic::updateBookmarkImage(int index)
 //-----------------------------------------------------------------------------
 void Comic::setPageLoaded(int page)
 {
+    if(!_loadedPages[page])
+        _loadedBytes.fetchAndAddOrdered(_pages[page].size());
     _loadedPages[page] = true;
 }
 
@@ -239,6 +241,11 @@ bool Comic::pageIsLoaded(int page)
 	}
 	return _loadedPages[page];
 }
+//-----------------------------------------------------------------------------
+qint64 Comic::loadedBytes()
+{
+	return _loadedBytes.load();
+}
 
 bool Comic::hasBeenAnErrorOpening()
 {
@@ -554,6 +561,16 @@ QList<QVector<quint32> > FileComic::getSections(int & sectionIndex)
 	return sections;
 }
 
+QList<QString> FileComic::sortedPages(const QList<QString> & src)
+{
+	QList<QString> pages = filter(src);
+
+	//TODO, add a setting for choosing the type of page sorting used.
+	comic_pages_sort(pages, YACReaderHeuristicSorting);
+
+	return pages;
+}
+
 void FileComic::process()
 {
 	CompressedArchive archive(_path);
@@ -573,7 +590,7 @@ void FileComic::process()
 
 	//se filtran para obtener s�lo los formatos soportados
 	_order = archive.getFileNames();
-	_fileNames = filter(_order);
+	_fileNames = sortedPages(_order);
 
 	if(_fileNames.size()==0)
 	{
@@ -588,6 +605,7 @@ void FileComic::process()
 
 	_pages.resize(_fileNames.size());
 	_loadedPages = QVector<bool>(_fileNames.size(),false);
+	_loadedBytes.store(0);
 
 	emit pageChanged(0); // this indicates new comic, index=0
 	emit numPages(_pages.size());
@@ -595,9 +613,6 @@ void FileComic::process()
 
 	_cfi=0;
 
-	//TODO, add a setting for choosing the type of page sorting used.
-	comic_pages_sort(_fileNames, YACReaderHeuristicSorting);
-
 	if(_firstPage == -1)
 	{
 		_firstPage = bm->getLastPage();
@@ -697,6 +712,7 @@ void FolderComic::process()
 	_pages.clear();
 	_pages.resize(nPages);
 	_loadedPages = QVector<bool>(nPages,false);
+	_loadedBytes.store(0);
 
 	if(nPages==0)
 	{
@@ -872,6 +888,7 @@ void PDFComic::process()
 	_pages.clear();
 	_pages.resize(nPages);
 	_loadedPages = QVector<bool>(nPages,false);
+	_loadedBytes.store(0);
 
 	if(_firstPage == -1)
 	{
@@ -23,6 +23,8 @@ class Comic : public QObject
 		//Comic pages, one QPixmap for each file.
 		QVector<QByteArray> _pages;
 		QVector<bool> _loadedPages;
+		//size of the pages loaded, it can be read from other threads while the comic is loading
+		QAtomicInteger<qint64> _loadedBytes;
 		//QVector<uint> _sizes;
 		QStringList _fileNames;
 		QMap<QString,int> _newOrder;
@@ -74,6 +76,8 @@ class Comic : public QObject
 		QVector<QByteArray> * getRawData(){return &_pages;}
 		QByteArray getRawPage(int page);
 		bool pageIsLoaded(int page);
+		//memory used by the pages already loaded
+		qint64 loadedBytes();
 
         //check if the comic has failed loading
         bool hasBeenAnErrorOpening();
@@ -129,6 +133,8 @@ class FileComic : public Comic, public ExtractDelegate
 		virtual bool load(const QString & path, int atPage = -1);
 		virtual bool load(const QString & path, const ComicDB & comic);
         static QList<QString> filter(const QList<QString> & src);
+        //image files of the archive in reading order
+        static QList<QString> sortedPages(const QList<QString> & src);
 
         //ExtractDelegate
         void fileExtracted(int index, const QByteArray & rawData);
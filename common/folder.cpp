@@ -31,6 +31,9 @@ Folder &Folder::operator =(const Folder &other)
     this->knownId = other.knownId;
     this->finished = other.finished;
     this->completed = other.completed;
+    this->numChildren = other.numChildren;
+    this->firstChildHash = other.firstChildHash;
+    this->customImage = other.customImage;
 
     return *this;
 }
@@ -2,6 +2,8 @@
 
 #include <QCollator>
 
+#include <algorithm>
+
 
 
 int naturalCompare(const QString &s1, const QString &s2,  Qt::CaseSensitivity caseSensitivity)
@@ -30,3 +32,60 @@ bool naturalSortLessThanCILibraryItem(LibraryItem * left, LibraryItem * right)
 {
 	return naturalSortLessThanCI(left->name,right->name);
 }
+
+QString naturalSortKey(const QString & name)
+{
+    //numbers are zero padded to this width, so "9" < "10" comparing the keys char by char
+    const int numberWidth = 20;
+
+    //accents and case are ignored, like the collator does at primary strength
+    QString decomposed = name.normalized(QString::NormalizationForm_KD);
+    QString key;
+    key.reserve(decomposed.size() + numberWidth);
+
+    int i = 0;
+    while(i < decomposed.size())
+    {
+        QChar c = decomposed.at(i);
+        if(c.isDigit())
+        {
+            QString number;
+            while(i < decomposed.size() && decomposed.at(i).isDigit())
+            {
+                int digit = decomposed.at(i).digitValue();
+                if(!number.isEmpty() || digit != 0)
+                    number.append(QChar('0' + digit));
+                i++;
+            }
+            key.append(QString(qMax(0,numberWidth - number.size()),QChar('0')));
+            key.append(number);
+        }
+        else
+        {
+            if(c.category() != QChar::Mark_NonSpacing)
+                key.append(c.toCaseFolded());
+            i++;
+        }
+    }
+
+    return key;
+}
+
+void naturalSortByKey(QList<LibraryItem *> & items)
+{
+    //the keys are computed once per item, and compared as UTF-8 bytes like SQLite does
+    QList<QPair<QByteArray, LibraryItem *> > keys;
+    keys.reserve(items.size());
+    foreach(LibraryItem * item, items)
+        keys.append(qMakePair(naturalSortKey(item->name).toUtf8(), item));
+
+    std::sort(keys.begin(), keys.end(), [](const QPair<QByteArray, LibraryItem *> & left, const QPair<QByteArray, LibraryItem *> & right)
+    {
+        if(left.first != right.first)
+            return left.first < right.first;
+        return left.second->id < right.second->id;
+    });
+
+    for(int i = 0; i < keys.size(); i++)
+        items[i] = keys.at(i).second;
+}
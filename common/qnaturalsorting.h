@@ -12,5 +12,9 @@ bool naturalSortLessThanCS( const QString &left, const QString &right );
 bool naturalSortLessThanCI( const QString &left, const QString &right );
 bool naturalSortLessThanCIFileInfo(const QFileInfo & left,const QFileInfo & right);
 bool naturalSortLessThanCILibraryItem(LibraryItem * left, LibraryItem * right);
+//key of the order of the folder listings (binary comparison), it is stored in the DB so listings can be sorted by SQL
+QString naturalSortKey(const QString & name);
+//sorts the items like the listings sorted by SQL: by the sort keys of their names, by id if the keys are equal
+void naturalSortByKey(QList<LibraryItem *> & items);
 
 #endif
@@ -12,7 +12,7 @@
 
 #include "QsLog.h"
 
-#include "comic_item.h"
+#include "comic_model.h"
 
 YACReaderTableView::YACReaderTableView(QWidget *parent) :
 	QTableView(parent),showDelete(false),editing(false),myeditor(0)
@@ -253,7 +253,7 @@ void YACReaderTableView::resizeEvent(QResizeEvent * event)
 void YACReaderRatingDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
 									const QModelIndex &index) const
 {
-    int rating = ((ComicItem *)index.internalPointer())->data(11).toInt();
+    int rating = index.data(ComicModel::RatingRole).toInt();
 
 	StarRating starRating(rating);
 
@@ -274,7 +274,7 @@ QSize YACReaderRatingDelegate::sizeHint(const QStyleOptionViewItem &option,
 							 const QModelIndex &index) const
 {
 	Q_UNUSED(option)
-    int rating = ((ComicItem *)index.internalPointer())->data(11).toInt();
+    int rating = index.data(ComicModel::RatingRole).toInt();
 	StarRating starRating(rating);
 	return starRating.sizeHint();
 }
@@ -296,7 +296,7 @@ QWidget *YACReaderRatingDelegate::createEditor(QWidget *parent,
 void YACReaderRatingDelegate::setEditorData(QWidget *editor,
 								 const QModelIndex &index) const
 {
-    int rating = ((ComicItem *)index.internalPointer())->data(11).toInt();
+    int rating = index.data(ComicModel::RatingRole).toInt();
 
 	StarRating starRating(rating);
 
@@ -0,0 +1,47 @@
+TEMPLATE = app
+TARGET = db_import_benchmark
+CONFIG += console
+
+INCLUDEPATH += ../../YACReaderLibrary \
+                ../../common \
+                ../../YACReaderLibrary/db
+
+DEFINES += QT_NO_DEBUG_OUTPUT
+
+win32 {
+  QMAKE_CXXFLAGS_RELEASE += /MP /Ob2 /Oi /Ot /GT
+  QMAKE_LFLAGS_RELEASE += /LTCG
+  CONFIG -= embed_manifest_exe
+}
+
+unix {
+  CONFIG += c++11
+}
+
+CONFIG -= flat
+# gui is needed by the covers info of ComicDB and the cover ratios of the DB updates
+QT += core gui sql
+
+# only DBHelper, DataBaseManagement and the classes they store
+HEADERS += ../../YACReaderLibrary/db_helper.h \
+           ../../YACReaderLibrary/db/data_base_management.h \
+           ../../YACReaderLibrary/db/reading_list.h \
+           ../../YACReaderLibrary/yacreader_libraries.h \
+           ../../common/comic_db.h \
+           ../../common/folder.h \
+           ../../common/library_item.h \
+           ../../common/qnaturalsorting.h \
+           ../../common/yacreader_global.h
+
+SOURCES += ../../YACReaderLibrary/db_helper.cpp \
+           ../../YACReaderLibrary/db/data_base_management.cpp \
+           ../../YACReaderLibrary/db/reading_list.cpp \
+           ../../YACReaderLibrary/yacreader_libraries.cpp \
+           ../../common/comic_db.cpp \
+           ../../common/folder.cpp \
+           ../../common/library_item.cpp \
+           ../../common/qnaturalsorting.cpp \
+           ../../common/yacreader_global.cpp \
+           main.cpp
+
+include(../../QsLog/QsLog.pri)
@@ -0,0 +1,204 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QCryptographicHash>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+
+#include "data_base_management.h"
+#include "db_helper.h"
+#include "comic_db.h"
+#include "folder.h"
+#include "qnaturalsorting.h"
+
+#include <iostream>
+
+using namespace std;
+
+//This program measures the database code used when a library is created and when comics info is imported:
+//
+//- a library with --comics comics is created in a temporary folder, the comics are inserted with DBHelper::insert
+//  (the statements are prepared once per connection, see DBHelper::cachedQuery). The same inserts are timed preparing
+//  the statements for each row, the way it was done before the cache, to compare both.
+//- the info of every comic is marked as edited and exported (DataBaseManagement::exportComicsInfo).
+//- the info is imported (DataBaseManagement::importComicsInfo) into a second library that shares the hashes of half of
+//  the comics, so both the updated and the inserted rows are timed.
+//
+//The rows of the second library are checked after the import, the program returns 1 if they are not the expected ones.
+//
+
+#define COMICS_PER_FOLDER 100
+
+static QString comicHash(int index)
+{
+    return QCryptographicHash::hash(QByteArray::number(index), QCryptographicHash::Sha1).toHex() + QString::number(1000000 + index);
+}
+
+static double rowsPerSecond(int rows, qint64 ms)
+{
+    return ms > 0 ? rows * 1000.0 / ms : rows * 1000.0;
+}
+
+//the folders are inserted first, then the comics (the hashes go from firstHash to firstHash + count - 1) in a single transaction
+static qint64 insertComics(QSqlDatabase & db, int firstHash, int count, bool cached)
+{
+    QList<qulonglong> folderIds;
+    for(int i = 0; i < (count + COMICS_PER_FOLDER - 1) / COMICS_PER_FOLDER; i++)
+    {
+        Folder folder(QString("Folder %1").arg(i), QString("/Folder %1").arg(i));
+        folder.parentId = 1;
+        folderIds.append(DBHelper::insert(&folder, db));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    db.transaction();
+    for(int i = 0; i < count; i++)
+    {
+        ComicDB comic;
+        comic.name = QString("Comic %1.cbz").arg(firstHash + i);
+        comic.parentId = folderIds.at(i / COMICS_PER_FOLDER);
+        comic.path = QString("/Folder %1/%2").arg(i / COMICS_PER_FOLDER).arg(comic.name);
+        comic.info.hash = comicHash(firstHash + i);
+        comic.info.numPages = 24;
+
+        if(cached)
+            DBHelper::insert(&comic, db);
+        else
+        {
+            QSqlQuery comicInfoInsert(db);
+            comicInfoInsert.prepare("INSERT INTO comic_info (hash,numPages,coverSizeRatio,originalCoverSize) "
+                                    "VALUES (:hash,:numPages,:coverSizeRatio,:originalCoverSize)");
+            comicInfoInsert.bindValue(":hash", comic.info.hash);
+            comicInfoInsert.bindValue(":numPages", comic.info.numPages);
+            comicInfoInsert.bindValue(":coverSizeRatio", comic.info.coverSizeRatio);
+            comicInfoInsert.bindValue(":originalCoverSize", comic.info.originalCoverSize);
+            comicInfoInsert.exec();
+
+            QSqlQuery query(db);
+            query.prepare("INSERT INTO comic (parentId, comicInfoId, fileName, path, sortKey) "
+                          "VALUES (:parentId,:comicInfoId,:name, :path, :sortKey)");
+            query.bindValue(":parentId", comic.parentId);
+            query.bindValue(":comicInfoId", comicInfoInsert.lastInsertId());
+            query.bindValue(":name", comic.name);
+            query.bindValue(":path", comic.path);
+            query.bindValue(":sortKey", naturalSortKey(comic.name));
+            query.exec();
+        }
+    }
+    db.commit();
+
+    return timer.elapsed();
+}
+
+static qint64 createLibrary(const QString & path, int firstHash, int count, bool cached)
+{
+    QDir().mkpath(path + "/.yacreaderlibrary");
+
+    qint64 elapsed;
+    QString connectionName;
+    {
+        QSqlDatabase db = DataBaseManagement::createDatabase("library", path + "/.yacreaderlibrary");
+        elapsed = insertComics(db, firstHash, count, cached);
+        connectionName = db.connectionName();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    return elapsed;
+}
+
+static qulonglong countRows(const QString & path, const QString & sql)
+{
+    qulonglong count = 0;
+    QString connectionName;
+    {
+        QSqlDatabase db = DataBaseManagement::loadDatabase(path + "/.yacreaderlibrary");
+        {
+            QSqlQuery query(sql, db);
+            if(query.next())
+                count = query.value(0).toULongLong();
+        }
+        connectionName = db.connectionName();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+
+    return count;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("YACReader");
+    app.setApplicationName("YACReaderLibraryDBImportBenchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Times the comics inserts and the comics info import of YACReaderLibrary");
+    parser.addHelpOption();
+    QCommandLineOption comicsOption("comics", "Comics in each library (default 100000)", "N", "100000");
+    parser.addOption(comicsOption);
+    parser.process(app);
+
+    int comics = qMax(2, parser.value(comicsOption).toInt());
+
+    QTemporaryDir temporaryDir;
+    if(!temporaryDir.isValid())
+    {
+        cout << "Unable to create a temporary folder" << endl;
+        return 1;
+    }
+    QString basePath = temporaryDir.path();
+
+    qint64 elapsed = createLibrary(basePath + "/uncached", 0, comics, false);
+    cout << "Insert " << comics << " comics, statements prepared per row: " << elapsed / 1000.0 << "s ("
+         << rowsPerSecond(comics, elapsed) << " comics/s)" << endl;
+
+    elapsed = createLibrary(basePath + "/source", 0, comics, true);
+    cout << "Insert " << comics << " comics, cached statements: " << elapsed / 1000.0 << "s ("
+         << rowsPerSecond(comics, elapsed) << " comics/s)" << endl;
+
+    //every comic in the source library has edited info
+    {
+        QString connectionName;
+        {
+            QSqlDatabase db = DataBaseManagement::loadDatabase(basePath + "/source/.yacreaderlibrary");
+            QSqlQuery("UPDATE comic_info SET title = 'Title ' || id, writer = 'Writer', edited = 1", db);
+            connectionName = db.connectionName();
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+
+    QString infoPath = basePath + "/info.ydb";
+    QElapsedTimer timer;
+    timer.start();
+    DataBaseManagement::exportComicsInfo(basePath + "/source/.yacreaderlibrary/library.ydb", infoPath);
+    elapsed = timer.elapsed();
+    cout << "Export " << comics << " comics info: " << elapsed / 1000.0 << "s" << endl;
+
+    //half of the hashes are already in the destination library
+    createLibrary(basePath + "/dest", comics / 2, comics, true);
+
+    timer.restart();
+    bool imported = DataBaseManagement::importComicsInfo(infoPath, basePath + "/dest/.yacreaderlibrary/library.ydb");
+    elapsed = timer.elapsed();
+    cout << "Import " << comics << " comics info (" << comics - comics / 2 << " updated, " << comics / 2 << " inserted): "
+         << elapsed / 1000.0 << "s (" << rowsPerSecond(comics, elapsed) << " rows/s)" << endl;
+
+    qulonglong infoRows = countRows(basePath + "/dest", "SELECT COUNT(*) FROM comic_info");
+    qulonglong editedRows = countRows(basePath + "/dest", "SELECT COUNT(*) FROM comic_info WHERE edited = 1 AND title LIKE 'Title %'");
+    qulonglong expectedInfoRows = comics + comics / 2;
+
+    if(!imported || infoRows != expectedInfoRows || editedRows != qulonglong(comics))
+    {
+        cout << "Unexpected result: " << infoRows << " comics info (expected " << expectedInfoRows << "), "
+             << editedRows << " edited (expected " << comics << ")" << endl;
+        return 1;
+    }
+
+    return 0;
+}
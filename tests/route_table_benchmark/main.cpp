@@ -0,0 +1,155 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QRegExp>
+#include <QSettings>
+
+#include "yacreader_route_table.h"
+
+#include <iostream>
+
+using namespace std;
+
+//This program measures the dispatching of the requests done by RequestMapper:
+//
+//- the v2 routes are compiled into a YACReaderRouteTable once, and --requests paths are matched against it.
+//- the same paths are matched against the list of QRegExp built for every request, the way it was done before the
+//  route table, to compare both.
+//
+//The routes are the ones added in RequestMapper (createRoutesV2), each one with its own dummy service. The route found
+//for every path is checked, the program returns 1 if it is not the expected one.
+//
+
+template<int N>
+static void service(HttpRequest& request, HttpResponse& response)
+{
+    Q_UNUSED(request);
+    Q_UNUSED(response);
+}
+
+struct Route {
+    const char* pattern;
+    const char* regExp;
+    YACReaderRouteTable::Service service;
+    const char* samplePath;
+};
+
+//the regular expressions are in the order they were checked
+static const Route routes[] = {
+    {"/v2/libraries", "/v2/libraries/?", &service<0>, "/v2/libraries"},
+    {"/v2/version", "/v2/version/?", &service<1>, "/v2/version"},
+    {"/v2/sync", "/v2/sync/?", &service<2>, "/v2/sync/"},
+    {"/v2/metrics", "/v2/metrics/?", &service<3>, "/v2/metrics"},
+    {"/v2/library/:libraryId/folder/:folderId/info", "/v2/library/.+/folder/[0-9]+/info/?", &service<4>, "/v2/library/2/folder/1031/info"},
+    {"/v2/library/:libraryId/folder/:folderId/content", "/v2/library/.+/folder/[0-9]+/content/?", &service<5>, "/v2/library/2/folder/1031/content"},
+    {"/v2/library/:libraryId/cover/*fileName", "/v2/library/.+/cover/[0-9a-f]+.jpg", &service<6>, "/v2/library/2/cover/3f786850e387550fdab836ed7e6dc881de23001b12345678.jpg"},
+    {"/v2/library/:libraryId/covers", "/v2/library/.+/covers/?", &service<7>, "/v2/library/2/covers"},
+    {"/v2/library/:libraryId/comics/fullinfo", "/v2/library/.+/comics/fullinfo/?", &service<8>, "/v2/library/2/comics/fullinfo"},
+    {"/v2/library/:libraryId/comic/:comicId/remote", "/v2/library/.+/comic/[0-9]+/remote/?", &service<9>, "/v2/library/2/comic/20518/remote"},
+    {"/v2/library/:libraryId/comic/:comicId/info", "/v2/library/.+/comic/[0-9]+/info/?", &service<10>, "/v2/library/2/comic/20518/info"},
+    {"/v2/library/:libraryId/comic/:comicId/fullinfo", "/v2/library/.+/comic/[0-9]+/fullinfo/?", &service<11>, "/v2/library/2/comic/20518/fullinfo"},
+    {"/v2/library/:libraryId/comic/:comicId/file", "/v2/library/.+/comic/[0-9]+/file/?", &service<12>, "/v2/library/2/comic/20518/file"},
+    {"/v2/library/:libraryId/comic/:comicId/update", "/v2/library/.+/comic/[0-9]+/update/?", &service<13>, "/v2/library/2/comic/20518/update"},
+    {"/v2/library/:libraryId/comic/:comicId/page/:page", "/v2/library/.+/comic/[0-9]+/page/[0-9]+/?", &service<14>, "/v2/library/2/comic/20518/page/12"},
+    {"/v2/library/:libraryId/comic/:comicId/page/:page/remote", "/v2/library/.+/comic/[0-9]+/page/[0-9]+/remote/?", &service<15>, "/v2/library/2/comic/20518/page/12/remote"},
+    {"/v2/library/:libraryId/comic/:comicId", "/v2/library/.+/comic/[0-9]+/?", &service<16>, "/v2/library/2/comic/20518"},
+    {"/v2/library/:libraryId/favs", "/v2/library/.+/favs/?", &service<17>, "/v2/library/2/favs"},
+    {"/v2/library/:libraryId/reading", "/v2/library/.+/reading/?", &service<18>, "/v2/library/2/reading"},
+    {"/v2/library/:libraryId/tags", "/v2/library/.+/tags/?", &service<19>, "/v2/library/2/tags"},
+    {"/v2/library/:libraryId/tag/:tagId/content", "/v2/library/.+/tag/[0-9]+/content/?", &service<20>, "/v2/library/2/tag/7/content"},
+    {"/v2/library/:libraryId/tag/:tagId/info", "/v2/library/.+/tag/[0-9]+/info/?", &service<21>, "/v2/library/2/tag/7/info"},
+    {"/v2/library/:libraryId/reading_lists", "/v2/library/.+/reading_lists/?", &service<22>, "/v2/library/2/reading_lists"},
+    {"/v2/library/:libraryId/reading_list/:readingListId/content", "/v2/library/.+/reading_list/[0-9]+/content/?", &service<23>, "/v2/library/2/reading_list/4/content"},
+    {"/v2/library/:libraryId/reading_list/:readingListId/info", "/v2/library/.+/reading_list/[0-9]+/info/?", &service<24>, "/v2/library/2/reading_list/4/info"}
+};
+
+static const int routeCount = sizeof(routes) / sizeof(routes[0]);
+
+//the paths are weighted like the traffic of a client reading comics: mostly pages and covers
+static QList<QByteArray> requestPaths(int requests)
+{
+    QList<QByteArray> paths;
+    for(int i = 0; paths.size() < requests; i++)
+    {
+        if(i % 4 < 2)
+            paths.append(QByteArray("/v2/library/2/comic/20518/page/") + QByteArray::number(i % 300) + (i % 8 == 0 ? "/remote" : ""));
+        else if(i % 4 == 2)
+            paths.append(routes[6].samplePath);
+        else
+            paths.append(routes[(i / 4) % routeCount].samplePath);
+    }
+    return paths;
+}
+
+static YACReaderRouteTable::Service expectedService(const QByteArray& path)
+{
+    if(path.startsWith("/v2/library/2/comic/20518/page/"))
+        return path.endsWith("/remote") ? routes[15].service : routes[14].service;
+
+    for(int i = 0; i < routeCount; i++)
+        if(path == routes[i].samplePath)
+            return routes[i].service;
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures the matching of the server routes");
+    parser.addHelpOption();
+    QCommandLineOption requestsOption("requests", "Paths matched (default 1000000)", "N", "1000000");
+    parser.addOption(requestsOption);
+    parser.process(app);
+
+    int requests = qMax(1, parser.value(requestsOption).toInt());
+    QList<QByteArray> paths = requestPaths(requests);
+
+    QSettings settings(QDir::temp().filePath("route_table_benchmark.ini"), QSettings::IniFormat);
+    HttpRequest request(&settings);
+
+    YACReaderRouteTable table;
+    for(int i = 0; i < routeCount; i++)
+        table.add(routes[i].pattern, routes[i].service);
+
+    int errors = 0;
+    QElapsedTimer timer;
+    timer.start();
+    foreach(const QByteArray& path, paths)
+        if(table.match(path, request) != expectedService(path))
+            errors++;
+    qint64 tableElapsed = timer.nsecsElapsed();
+
+    timer.restart();
+    foreach(const QByteArray& path, paths)
+    {
+        QList<QRegExp> regExps;
+        for(int i = 0; i < routeCount; i++)
+            regExps.append(QRegExp(routes[i].regExp));
+
+        YACReaderRouteTable::Service service = 0;
+        for(int i = 0; i < routeCount && service == 0; i++)
+            if(regExps.at(i).exactMatch(path))
+                service = routes[i].service;
+
+        if(service != expectedService(path))
+            errors++;
+    }
+    qint64 regExpElapsed = timer.nsecsElapsed();
+
+    cout << "Route table: " << requests << " paths in " << tableElapsed / 1000000.0 << "ms ("
+         << tableElapsed / requests << "ns per path)" << endl;
+    cout << "QRegExp per request: " << requests << " paths in " << regExpElapsed / 1000000.0 << "ms ("
+         << regExpElapsed / requests << "ns per path)" << endl;
+
+    if(errors > 0)
+    {
+        cout << "Unexpected routes: " << errors << endl;
+        return 1;
+    }
+
+    return 0;
+}
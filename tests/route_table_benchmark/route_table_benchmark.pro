@@ -0,0 +1,39 @@
+TEMPLATE = app
+TARGET = route_table_benchmark
+CONFIG += console
+
+INCLUDEPATH += ../../YACReaderLibrary/server \
+                ../../YACReaderLibrary/server/lib/httpserver
+
+DEFINES += QT_NO_DEBUG_OUTPUT
+
+unix {
+  CONFIG += c++11
+}
+
+CONFIG -= flat
+QT += core network
+QT -= gui
+
+# only the route table and the request/response classes it is built on
+HEADERS += ../../YACReaderLibrary/server/yacreader_route_table.h \
+           ../../YACReaderLibrary/server/lib/httpserver/httpglobal.h \
+           ../../YACReaderLibrary/server/lib/httpserver/httprequest.h \
+           ../../YACReaderLibrary/server/lib/httpserver/httpresponse.h \
+           ../../YACReaderLibrary/server/lib/httpserver/httpcookie.h \
+           ../../YACReaderLibrary/server/lib/httpserver/httprequesthandler.h
+
+SOURCES += ../../YACReaderLibrary/server/yacreader_route_table.cpp \
+           ../../YACReaderLibrary/server/lib/httpserver/httpglobal.cpp \
+           ../../YACReaderLibrary/server/lib/httpserver/httprequest.cpp \
+           ../../YACReaderLibrary/server/lib/httpserver/httpresponse.cpp \
+           ../../YACReaderLibrary/server/lib/httpserver/httpcookie.cpp \
+           ../../YACReaderLibrary/server/lib/httpserver/httprequesthandler.cpp \
+           main.cpp
+
+# zlib is used by HttpResponse for the compression of the responses
+win32 {
+    INCLUDEPATH += $$[QT_INSTALL_HEADERS]/QtZlib
+} else {
+    LIBS += -lz
+}
@@ -0,0 +1,125 @@
+#include "load_client.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QDateTime>
+
+//maximum number of covers requested after listing a folder, the apps load the visible ones
+#define COVERS_PER_FOLDER 12
+
+LoadClient::LoadClient(const LoadTestCatalogue &catalogue, const QString &baseUrl, int version, int pagesPerComic, qint64 duration, quint32 seed, QObject *parent)
+    :QObject(parent), catalogue(catalogue), baseUrl(baseUrl), version(version), pagesPerComic(pagesPerComic), duration(duration), random(seed), manager(0), loggedIn(false)
+{
+    token = QString("load-test-%1").arg(seed).toUtf8();
+}
+
+const QMap<QByteArray, LoadTestRouteStats> &LoadClient::getStats() const
+{
+    return stats;
+}
+
+void LoadClient::start()
+{
+    //created here so it lives in the thread of the client
+    manager = new QNetworkAccessManager(this);
+    running.start();
+    nextStep();
+}
+
+void LoadClient::planCycle()
+{
+    QString library = QString::number(catalogue.libraryId);
+    QList<Step> cycle;
+
+    if(!loggedIn)
+    {
+        if(version == 1)
+            cycle.append(Step("/", "/", "deviceType:ipad\ndisplayType:@2x\ncomics:"));
+        else
+            cycle.append(Step("/v2/libraries", "/v2/libraries"));
+        loggedIn = true;
+    }
+
+    const LoadTestCatalogue::Folder & folder = catalogue.folders.at(random() % catalogue.folders.size());
+    if(version == 1)
+        cycle.append(Step("/library/:libraryId/folder/:folderId", QString("/library/%1/folder/%2").arg(library).arg(folder.id)));
+    else
+        cycle.append(Step("/v2/library/:libraryId/folder/:folderId/content", QString("/v2/library/%1/folder/%2/content").arg(library).arg(folder.id)));
+
+    for(int i = 0; i < folder.comics.size() && i < COVERS_PER_FOLDER; i++)
+    {
+        if(version == 1)
+            cycle.append(Step("/library/:libraryId/cover/*fileName", QString("/library/%1/cover/%2.jpg").arg(library).arg(folder.comics.at(i).hash)));
+        else
+            cycle.append(Step("/v2/library/:libraryId/cover/*fileName", QString("/v2/library/%1/cover/%2.jpg").arg(library).arg(folder.comics.at(i).hash)));
+    }
+
+    if(!folder.comics.isEmpty())
+    {
+        const LoadTestCatalogue::Comic & comic = folder.comics.at(random() % folder.comics.size());
+        QString prefix = QString(version == 1 ? "/library/%1/comic/%2" : "/v2/library/%1/comic/%2").arg(library).arg(comic.id);
+        QByteArray routePrefix = version == 1 ? "/library/:libraryId/comic/:comicId" : "/v2/library/:libraryId/comic/:comicId";
+
+        cycle.append(Step(routePrefix + "/remote", prefix + "/remote"));
+
+        int pages = qMin(comic.numPages, pagesPerComic);
+        for(int page = 0; page < pages; page++)
+            cycle.append(Step(routePrefix + "/page/:page/remote", prefix + QString("/page/%1/remote").arg(page)));
+
+        QByteArray progress = QString("%1\t%2\t%3\t%4").arg(library).arg(comic.id).arg(comic.hash).arg(qMax(1,pages)).toUtf8();
+        if(version == 1)
+            cycle.append(Step("/sync", "/sync", progress + "\t0"));
+        else
+            cycle.append(Step("/v2/sync", "/v2/sync", progress + "\t0\t" + QByteArray::number(QDateTime::currentMSecsSinceEpoch() / 1000)));
+    }
+
+    steps = cycle;
+}
+
+void LoadClient::nextStep()
+{
+    if(running.elapsed() >= duration)
+    {
+        emit done();
+        return;
+    }
+
+    if(steps.isEmpty())
+        planCycle();
+
+    current = steps.takeFirst();
+
+    QNetworkRequest request(QUrl(baseUrl + current.path));
+    if(version == 2)
+        request.setRawHeader("x-request-id", token);
+
+    requestTimer.start();
+    QNetworkReply * reply;
+    if(current.body.isEmpty())
+        reply = manager->get(request);
+    else
+    {
+        request.setHeader(QNetworkRequest::ContentTypeHeader, "text/plain");
+        reply = manager->post(request, current.body);
+    }
+
+    connect(reply, &QNetworkReply::finished, this, &LoadClient::requestFinished);
+}
+
+void LoadClient::requestFinished()
+{
+    QNetworkReply * reply = qobject_cast<QNetworkReply *>(sender());
+    QByteArray body = reply->readAll();
+    qint64 latency = requestTimer.nsecsElapsed() / 1000;
+
+    LoadTestRouteStats & routeStats = stats[current.route];
+    routeStats.latencies.append(latency);
+    routeStats.bytes += body.size();
+
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if(reply->error() != QNetworkReply::NoError || status >= 400)
+        routeStats.errors++;
+
+    reply->deleteLater();
+    nextStep();
+}
@@ -0,0 +1,103 @@
+#ifndef LOAD_CLIENT_H
+#define LOAD_CLIENT_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QNetworkRequest>
+
+#include <random>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/** Folders and comics of the library, as listed by /v2/library/:libraryId/folder/:folderId/content */
+struct LoadTestCatalogue
+{
+    struct Comic
+    {
+        qulonglong id;
+        QString hash;
+        int numPages;
+    };
+
+    struct Folder
+    {
+        qulonglong id;
+        QList<Comic> comics;
+    };
+
+    qulonglong libraryId;
+    QList<Folder> folders;
+};
+
+/** Latencies (microseconds) and errors of a route */
+struct LoadTestRouteStats
+{
+    LoadTestRouteStats() : errors(0), bytes(0) {}
+
+    QVector<qint64> latencies;
+    quint64 errors;
+    quint64 bytes;
+};
+
+/**
+  Simulates a client until the duration is over, each cycle browses a folder, loads the covers,
+  opens a comic, reads some of its pages and syncs the progress. Each request is only sent when
+  the previous one has finished, like the apps do.
+  <p>
+  Version 1 clients use the session cookie of the old protocol, version 2 clients the x-request-id header.
+*/
+class LoadClient : public QObject
+{
+    Q_OBJECT
+public:
+    LoadClient(const LoadTestCatalogue & catalogue, const QString & baseUrl, int version, int pagesPerComic, qint64 duration, quint32 seed, QObject * parent = 0);
+
+    /** Only valid after done() */
+    const QMap<QByteArray,LoadTestRouteStats> & getStats() const;
+
+public slots:
+    void start();
+
+signals:
+    void done();
+
+private slots:
+    void requestFinished();
+
+private:
+    struct Step
+    {
+        Step() {}
+        Step(const QByteArray & route, const QString & path, const QByteArray & body = QByteArray()) : route(route), path(path), body(body) {}
+
+        QByteArray route;
+        QString path;
+        QByteArray body; //POST if not empty
+    };
+
+    void planCycle();
+    void nextStep();
+
+    LoadTestCatalogue catalogue;
+    QString baseUrl;
+    int version;
+    int pagesPerComic;
+    qint64 duration;
+    QByteArray token;
+    std::mt19937 random;
+
+    QNetworkAccessManager * manager;
+    QList<Step> steps;
+    Step current;
+    QElapsedTimer running;
+    QElapsedTimer requestTimer;
+    bool loggedIn;
+
+    QMap<QByteArray,LoadTestRouteStats> stats;
+};
+
+#endif // LOAD_CLIENT_H
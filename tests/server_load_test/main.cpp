@@ -0,0 +1,308 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include <QEventLoop>
+#include <QThread>
+#include <QSettings>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+
+#include "library_creator.h"
+#include "yacreader_libraries.h"
+#include "yacreader_global.h"
+#include "startup.h"
+
+#include "synthetic_library.h"
+#include "load_client.h"
+
+#include <iostream>
+#include <algorithm>
+
+#if defined Q_OS_UNIX && !defined Q_OS_LINUX
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+#define LIBRARY_NAME "load-test"
+
+//This program measures the capacity of the server: it starts the server in-process on localhost and
+//simulates concurrent v1 and v2 clients (browse folders, fetch covers, open a comic, page through it, sync).
+//
+//By default a synthetic library of cbz files is created in a temporary folder, --library uses an existing
+//folder of comics instead (the library is created inside it if needed).
+//The settings are stored in their own .ini (YACReaderLibraryLoadTest), the libraries of the user are not touched.
+//v1 clients need the server templates, run the test from a folder where they can be found (see Startup).
+//
+//It reports the throughput, the p50/p95/p99 latency per route and the peak RSS of the process, clients included.
+//
+
+//peak resident set size in KB, -1 if unknown
+static qint64 peakRSS()
+{
+#if defined Q_OS_LINUX
+    QFile status("/proc/self/status");
+    if(status.open(QIODevice::ReadOnly))
+    {
+        foreach(QByteArray line, status.readAll().split('\n'))
+            if(line.startsWith("VmHWM:"))
+                return line.mid(6).trimmed().split(' ').first().toLongLong();
+    }
+    return -1;
+#elif defined Q_OS_UNIX
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#ifdef Q_OS_MAC
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+static QJsonArray getJSON(QNetworkAccessManager & manager, const QString & url)
+{
+    QEventLoop loop;
+    QNetworkReply * reply = manager.get(QNetworkRequest(QUrl(url)));
+    QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    QJsonArray items = QJsonDocument::fromJson(reply->readAll()).array();
+    reply->deleteLater();
+    return items;
+}
+
+//walks the library using the v2 API, only folders with comics are kept
+static LoadTestCatalogue loadCatalogue(const QString & baseUrl, qulonglong libraryId)
+{
+    LoadTestCatalogue catalogue;
+    catalogue.libraryId = libraryId;
+
+    QNetworkAccessManager manager;
+    QList<qulonglong> pending;
+    pending.append(1);
+
+    while(!pending.isEmpty())
+    {
+        LoadTestCatalogue::Folder folder;
+        folder.id = pending.takeFirst();
+
+        QJsonArray items = getJSON(manager, QString("%1/v2/library/%2/folder/%3/content").arg(baseUrl).arg(libraryId).arg(folder.id));
+        foreach(QJsonValue value, items)
+        {
+            QJsonObject item = value.toObject();
+            if(item["type"].toString() == "folder")
+                pending.append(item["id"].toString().toULongLong());
+            else if(item["type"].toString() == "comic")
+            {
+                LoadTestCatalogue::Comic comic;
+                comic.id = item["id"].toString().toULongLong();
+                comic.hash = item["hash"].toString();
+                comic.numPages = item["num_pages"].toInt();
+                folder.comics.append(comic);
+            }
+        }
+
+        if(!folder.comics.isEmpty())
+            catalogue.folders.append(folder);
+    }
+
+    return catalogue;
+}
+
+static double percentile(const QVector<qint64> & sorted, double p)
+{
+    if(sorted.isEmpty())
+        return 0;
+    int index = qBound(0, int(p * sorted.size() + 0.5) - 1, sorted.size() - 1);
+    return sorted.at(index) / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setOrganizationName("YACReader");
+    app.setApplicationName("YACReaderLibraryLoadTest");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays client traffic against an in-process YACReaderLibrary server");
+    parser.addHelpOption();
+    QCommandLineOption clientsOption("clients", "Number of v2 clients (default 12)", "N", "12");
+    QCommandLineOption v1ClientsOption("v1-clients", "Number of v1 clients (default 4)", "N", "4");
+    QCommandLineOption durationOption("duration", "Duration of the test in seconds (default 30)", "seconds", "30");
+    QCommandLineOption threadsOption("threads", "Threads used by the clients (default 2)", "N", "2");
+    QCommandLineOption pagesPerComicOption("pages-per-comic", "Pages read each time a comic is opened (default 10)", "N", "10");
+    QCommandLineOption comicsOption("comics", "Comics in the synthetic library (default 200)", "N", "200");
+    QCommandLineOption foldersOption("folders", "Folders in the synthetic library (default 10)", "N", "10");
+    QCommandLineOption pagesOption("pages", "Pages of each synthetic comic (default 24)", "N", "24");
+    QCommandLineOption libraryOption("library", "Use an existing folder of comics instead of a synthetic library", "path");
+    QCommandLineOption portOption("port", "Port of the server, 0 for any (default 0)", "port", "0");
+    parser.addOptions({clientsOption, v1ClientsOption, durationOption, threadsOption, pagesPerComicOption,
+                       comicsOption, foldersOption, pagesOption, libraryOption, portOption});
+    parser.process(app);
+
+    QTemporaryDir temporaryDir;
+    QString libraryPath = parser.value(libraryOption);
+    if(libraryPath.isEmpty())
+    {
+        if(!temporaryDir.isValid())
+        {
+            cout << "Unable to create a temporary folder" << endl;
+            return 1;
+        }
+        libraryPath = temporaryDir.path();
+
+        cout << "Creating synthetic comics in " << libraryPath.toStdString() << endl;
+        SyntheticLibrary synthetic(parser.value(foldersOption).toInt(), parser.value(comicsOption).toInt(), parser.value(pagesOption).toInt());
+        if(!synthetic.create(libraryPath))
+            return 1;
+    }
+    libraryPath = QDir::cleanPath(QDir(libraryPath).absolutePath());
+
+    QElapsedTimer timer;
+    if(!QDir(libraryPath + "/.yacreaderlibrary").exists())
+    {
+        cout << "Creating library" << endl;
+        timer.start();
+
+        QEventLoop eventLoop;
+        LibraryCreator * libraryCreator = new LibraryCreator();
+        libraryCreator->createLibrary(libraryPath, libraryPath + "/.yacreaderlibrary");
+        QObject::connect(libraryCreator, &LibraryCreator::finished, &eventLoop, &QEventLoop::quit);
+        libraryCreator->start();
+        eventLoop.exec();
+        libraryCreator->wait();
+        delete libraryCreator;
+
+        cout << "Library created in " << timer.elapsed() / 1000.0 << "s" << endl;
+    }
+
+    YACReaderLibraries libraries;
+    libraries.load();
+    if(libraries.contains(LIBRARY_NAME))
+        libraries.remove(LIBRARY_NAME);
+    libraries.addLibrary(LIBRARY_NAME, libraryPath);
+    libraries.save();
+    qulonglong libraryId = libraries.getId(LIBRARY_NAME);
+
+    {
+        QSettings settings(YACReader::getSettingsPath() + "/" + QCoreApplication::applicationName() + ".ini", QSettings::IniFormat);
+        settings.setValue("listener/port", parser.value(portOption).toInt());
+    }
+
+    Startup server;
+    server.start();
+    QString baseUrl = "http://127.0.0.1:" + server.getPort();
+    cout << "Server listening on " << baseUrl.toStdString() << endl;
+
+    LoadTestCatalogue catalogue = loadCatalogue(baseUrl, libraryId);
+    if(catalogue.folders.isEmpty())
+    {
+        cout << "The library has no comics" << endl;
+        server.stop();
+        return 1;
+    }
+
+    int v2Clients = parser.value(clientsOption).toInt();
+    int v1Clients = parser.value(v1ClientsOption).toInt();
+    int numThreads = qMax(1, parser.value(threadsOption).toInt());
+    qint64 duration = parser.value(durationOption).toLongLong() * 1000;
+    int pagesPerComic = parser.value(pagesPerComicOption).toInt();
+
+    QList<QThread *> threads;
+    for(int i = 0; i < numThreads; i++)
+    {
+        threads.append(new QThread);
+        threads.last()->start();
+    }
+
+    QEventLoop loop;
+    int finished = 0;
+    QList<LoadClient *> clients;
+    for(int i = 0; i < v2Clients + v1Clients; i++)
+    {
+        LoadClient * client = new LoadClient(catalogue, baseUrl, i < v2Clients ? 2 : 1, pagesPerComic, duration, i + 1);
+        client->moveToThread(threads.at(i % numThreads));
+        QObject::connect(client, &LoadClient::done, &loop, [&]() {
+            if(++finished == clients.size())
+                loop.quit();
+        });
+        clients.append(client);
+    }
+
+    cout << "Running " << v2Clients << " v2 clients and " << v1Clients << " v1 clients for " << duration / 1000 << "s" << endl << endl;
+
+    timer.start();
+    foreach(LoadClient * client, clients)
+        QMetaObject::invokeMethod(client, "start", Qt::QueuedConnection);
+    if(!clients.isEmpty())
+        loop.exec();
+    double elapsed = timer.elapsed() / 1000.0;
+
+    foreach(QThread * thread, threads)
+    {
+        thread->quit();
+        thread->wait();
+    }
+
+    QMap<QByteArray,LoadTestRouteStats> stats;
+    foreach(LoadClient * client, clients)
+    {
+        const QMap<QByteArray,LoadTestRouteStats> & clientStats = client->getStats();
+        for(QMap<QByteArray,LoadTestRouteStats>::const_iterator itr = clientStats.constBegin(); itr != clientStats.constEnd(); itr++)
+        {
+            LoadTestRouteStats & routeStats = stats[itr.key()];
+            routeStats.latencies += itr->latencies;
+            routeStats.errors += itr->errors;
+            routeStats.bytes += itr->bytes;
+        }
+    }
+
+    quint64 totalRequests = 0;
+    quint64 totalErrors = 0;
+    quint64 totalBytes = 0;
+
+    cout << QString("%1 %2 %3 %4 %5 %6 %7").arg("route", -56).arg("requests", 9).arg("errors", 7).arg("req/s", 9)
+            .arg("p50 ms", 9).arg("p95 ms", 9).arg("p99 ms", 9).toStdString() << endl;
+    for(QMap<QByteArray,LoadTestRouteStats>::iterator itr = stats.begin(); itr != stats.end(); itr++)
+    {
+        std::sort(itr->latencies.begin(), itr->latencies.end());
+        cout << QString("%1 %2 %3 %4 %5 %6 %7").arg(QString(itr.key()), -56).arg(itr->latencies.size(), 9).arg(itr->errors, 7)
+                .arg(itr->latencies.size() / elapsed, 9, 'f', 1)
+                .arg(percentile(itr->latencies, 0.50), 9, 'f', 2)
+                .arg(percentile(itr->latencies, 0.95), 9, 'f', 2)
+                .arg(percentile(itr->latencies, 0.99), 9, 'f', 2).toStdString() << endl;
+
+        totalRequests += itr->latencies.size();
+        totalErrors += itr->errors;
+        totalBytes += itr->bytes;
+    }
+
+    cout << endl;
+    cout << "Total requests : " << totalRequests << " (" << totalErrors << " errors)" << endl;
+    cout << "Throughput : " << totalRequests / elapsed << " req/s, " << totalBytes / elapsed / 1048576 << " MB/s" << endl;
+    qint64 rss = peakRSS();
+    if(rss >= 0)
+        cout << "Peak RSS : " << rss / 1024 << " MB" << endl;
+    else
+        cout << "Peak RSS : unknown" << endl;
+    cout << endl;
+
+    qDeleteAll(clients);
+    qDeleteAll(threads);
+
+    server.stop();
+
+    libraries.remove(LIBRARY_NAME);
+    libraries.save();
+
+    return totalErrors == 0 ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+TEMPLATE = app
+TARGET = server_load_test
+CONFIG += console
+
+DEPENDPATH += ../../YACReaderLibrary
+INCLUDEPATH += ../../YACReaderLibrary \
+                ../../common \
+                ../../YACReaderLibrary/server \
+                ../../YACReaderLibrary/db
+
+DEFINES += SERVER_RELEASE NOMINMAX YACREADER_LIBRARY QT_NO_DEBUG_OUTPUT
+# the synthetic libraries only contain cbz files
+DEFINES += NO_PDF
+
+include(../../config.pri)
+
+win32 {
+  LIBS += -loleaut32 -lole32 -lshell32 -luser32
+  QMAKE_CXXFLAGS_RELEASE += /MP /Ob2 /Oi /Ot /GT
+  QMAKE_LFLAGS_RELEASE += /LTCG
+  CONFIG -= embed_manifest_exe
+}
+
+macx {
+  LIBS += -framework Foundation -framework ApplicationServices -framework AppKit
+  CONFIG += objective_c
+}
+
+unix {
+  CONFIG += c++11
+}
+
+unix:!macx {
+  isEmpty(PREFIX) {
+    PREFIX = /usr
+  }
+  DEFINES += "LIBDIR=\\\"$$PREFIX/lib\\\""  "DATADIR=\\\"$$PREFIX/share\\\"" "BINDIR=\\\"$$PREFIX/bin\\\""
+}
+
+CONFIG -= flat
+QT += core sql network
+
+HEADERS += ../../YACReaderLibrary/library_creator.h \
+           ../../YACReaderLibrary/package_manager.h \
+           ../../YACReaderLibrary/bundle_creator.h \
+           ../../YACReaderLibrary/db_helper.h \
+           ../../YACReaderLibrary/db/data_base_management.h \
+           ../../YACReaderLibrary/db/reading_list.h \
+           ../../common/comic_db.h \
+           ../../common/folder.h \
+           ../../common/library_item.h \
+           ../../common/comic.h \
+           ../../common/bookmarks.h \
+           ../../common/qnaturalsorting.h \
+           ../../common/yacreader_global.h \
+           ../../YACReaderLibrary/comics_remover.h \
+           ../../common/http_worker.h \
+           ../../YACReaderLibrary/yacreader_libraries.h \
+           ../../YACReaderLibrary/comic_files_manager.h \
+           synthetic_library.h \
+           load_client.h
+
+SOURCES += ../../YACReaderLibrary/library_creator.cpp \
+           ../../YACReaderLibrary/package_manager.cpp \
+           ../../YACReaderLibrary/bundle_creator.cpp \
+           ../../YACReaderLibrary/db_helper.cpp \
+           ../../YACReaderLibrary/db/data_base_management.cpp \
+           ../../YACReaderLibrary/db/reading_list.cpp \
+           ../../common/comic_db.cpp \
+           ../../common/folder.cpp \
+           ../../common/library_item.cpp \
+           ../../common/comic.cpp \
+           ../../common/bookmarks.cpp \
+           ../../common/qnaturalsorting.cpp \
+           ../../YACReaderLibrary/comics_remover.cpp \
+           ../../common/http_worker.cpp \
+           ../../common/yacreader_global.cpp \
+           ../../YACReaderLibrary/yacreader_libraries.cpp \
+           ../../YACReaderLibrary/comic_files_manager.cpp \
+           synthetic_library.cpp \
+           load_client.cpp \
+           main.cpp
+
+include(../../YACReaderLibrary/server/server.pri)
+CONFIG(7zip) {
+include(../../compressed_archive/wrapper.pri)
+} else:CONFIG(unarr) {
+include(../../compressed_archive/unarr/unarr-wrapper.pri)
+} else {
+  error(No compression backend specified. Did you mess with the build system?)
+}
+include(../../QsLog/QsLog.pri)
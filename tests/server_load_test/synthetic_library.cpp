@@ -0,0 +1,131 @@
+#include "synthetic_library.h"
+
+#include <QDir>
+#include <QFile>
+#include <QImage>
+#include <QBuffer>
+#include <QDataStream>
+
+#include <iostream>
+
+//number of different JPEGs used for the pages, they are shared by all the comics
+#define DISTINCT_PAGES 8
+
+static quint32 crc32(const QByteArray & data)
+{
+    static quint32 table[256];
+    static bool initialized = false;
+    if(!initialized)
+    {
+        for(quint32 i = 0; i < 256; i++)
+        {
+            quint32 c = i;
+            for(int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+        initialized = true;
+    }
+
+    quint32 crc = 0xFFFFFFFF;
+    for(int i = 0; i < data.size(); i++)
+        crc = table[(crc ^ (quint8)data.at(i)) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFF;
+}
+
+SyntheticLibrary::SyntheticLibrary(int folders, int comics, int pages)
+    :folders(qMax(1,folders)), comics(comics), pages(qMax(1,pages))
+{
+
+}
+
+bool SyntheticLibrary::create(const QString &path)
+{
+    for(int i = 0; i < DISTINCT_PAGES; i++)
+        pageImages.append(createPage(i, 1300, 2000));
+
+    QDir root(path);
+    for(int i = 0; i < comics; i++)
+    {
+        QString folder = QString("Series %1").arg(i % folders + 1, 3, 10, QChar('0'));
+        if(!root.mkpath(folder))
+            return false;
+
+        QString fileName = root.filePath(folder + QString("/Issue %1.cbz").arg(i / folders + 1, 3, 10, QChar('0')));
+        if(!writeComic(fileName, i))
+        {
+            std::cout << "Unable to write " << fileName.toStdString() << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SyntheticLibrary::writeComic(const QString &fileName, int index)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QList<QPair<QByteArray,QByteArray> > entries;
+    entries.append(qMakePair(QByteArray("info.txt"), QString("synthetic comic %1\n").arg(index).toUtf8()));
+    for(int i = 0; i < pages; i++)
+        entries.append(qMakePair(QString("%1.jpg").arg(i + 1, 3, 10, QChar('0')).toUtf8(), pageImages.at((index + i) % pageImages.size())));
+
+    QByteArray centralDirectory;
+    QDataStream central(&centralDirectory, QIODevice::WriteOnly);
+    central.setByteOrder(QDataStream::LittleEndian);
+
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    for(const QPair<QByteArray,QByteArray> & entry : entries)
+    {
+        quint32 offset = file.pos();
+        quint32 crc = crc32(entry.second);
+        quint32 size = entry.second.size();
+        quint16 nameLength = entry.first.size();
+
+        //local file header, stored entries without data descriptor
+        out << quint32(0x04034b50) << quint16(10) << quint16(0) << quint16(0) << quint16(0) << quint16(0x21)
+            << crc << size << size << nameLength << quint16(0);
+        out.writeRawData(entry.first.constData(), entry.first.size());
+        out.writeRawData(entry.second.constData(), entry.second.size());
+
+        central << quint32(0x02014b50) << quint16(10) << quint16(10) << quint16(0) << quint16(0) << quint16(0) << quint16(0x21)
+                << crc << size << size << nameLength << quint16(0) << quint16(0) << quint16(0) << quint16(0) << quint32(0) << offset;
+        central.writeRawData(entry.first.constData(), entry.first.size());
+    }
+
+    quint32 centralOffset = file.pos();
+    out.writeRawData(centralDirectory.constData(), centralDirectory.size());
+    out << quint32(0x06054b50) << quint16(0) << quint16(0) << quint16(entries.size()) << quint16(entries.size())
+        << quint32(centralDirectory.size()) << centralOffset << quint16(0);
+
+    return out.status() == QDataStream::Ok;
+}
+
+QByteArray SyntheticLibrary::createPage(int index, int width, int height)
+{
+    //some noise keeps the JPEGs close to the size of a scanned page
+    QImage image(width, height, QImage::Format_RGB32);
+    quint32 seed = 2166136261u + index;
+    for(int y = 0; y < height; y++)
+    {
+        QRgb * line = (QRgb *)image.scanLine(y);
+        for(int x = 0; x < width; x++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            int noise = (seed >> 24) & 0x3F;
+            int panel = ((x / 320) + (y / 400) + index) % 4;
+            line[x] = qRgb(60 * panel + noise, (y * 255 / height + noise) & 0xFF, (x * 255 / width + 40 * index) & 0xFF);
+        }
+    }
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "JPG", 85);
+    return data;
+}
@@ -0,0 +1,33 @@
+#ifndef SYNTHETIC_LIBRARY_H
+#define SYNTHETIC_LIBRARY_H
+
+#include <QString>
+#include <QList>
+#include <QByteArray>
+
+/**
+  Writes a folder tree of cbz files that can be used to create a library.
+  <p>
+  The comics are stored (not compressed) zip files with a few distinct JPEG pages,
+  every comic starts with a small text entry so each one gets its own hash.
+*/
+
+class SyntheticLibrary
+{
+public:
+    SyntheticLibrary(int folders, int comics, int pages);
+
+    /** Creates the comics in path, returns false if a file couldn't be written */
+    bool create(const QString & path);
+
+private:
+    bool writeComic(const QString & fileName, int index);
+    QByteArray createPage(int index, int width, int height);
+
+    int folders;
+    int comics;
+    int pages;
+    QList<QByteArray> pageImages;
+};
+
+#endif // SYNTHETIC_LIBRARY_H